@@ -47,239 +47,1027 @@ int32_t main (int32_t argc, char **argv)
 
 void las_zero::usage ()
 {
-  fprintf (stderr, "\nUsage: las_zero <LAS_FILE | LAZ_FILE>\n");
+  fprintf (stderr, "\nUsage: las_zero [-t THREADS] [--threshold VALUE] [--grid FILE] [--shard I/N [--shard-record FILE]]\n");
+  fprintf (stderr, "                [--source-id LIST] [--time-range MIN,MAX] [--extra RULE] [--manifest FILE] [--list FILE]\n");
+  fprintf (stderr, "                [--read-limit MBPS] [--write-limit MBPS] [--read-iops N] [--write-iops N]\n");
+  fprintf (stderr, "                [--throttle-file FILE] [--profile] [--sort [--sort-memory MB] [--sort-index]] [--qa]\n");
+  fprintf (stderr, "                [--output FILE | DIRECTORY] [--prefetch N] [--mem-limit MB] [--no-numa] [--verify]\n");
+  fprintf (stderr, "                [--archive]\n");
+  fprintf (stderr, "                <LAS_FILE | LAZ_FILE> [LAS_FILE | LAZ_FILE ...]\n");
+  fprintf (stderr, "       las_zero [-t THREADS] [--threshold VALUE] [--grid FILE] [--mem-limit MB] --daemon SOCKET [--workers N]\n");
+  fprintf (stderr, "                [--queue N]\n");
+  fprintf (stderr, "       las_zero --estimate [--sample N] [--threshold VALUE] [--grid FILE] [--source-id LIST]\n");
+  fprintf (stderr, "                [--time-range MIN,MAX] [--extra RULE] <LAS_FILE> [LAS_FILE ...]\n");
+  fprintf (stderr, "       las_zero --build-index <LAS_FILE> [LAS_FILE ...]\n");
+  fprintf (stderr, "       las_zero --submit SOCKET <LAS_FILE | LAZ_FILE> [LAS_FILE | LAZ_FILE ...]\n\n");
+  fprintf (stderr, "Where:\n\n");
+  fprintf (stderr, "\t-t, --threads     =    Number of threads used per file (default is one per core,\n");
+  fprintf (stderr, "\t                        one per job in daemon mode)\n");
+  fprintf (stderr, "\t--shard           =    Only do shard I of N (0 <= I < N) of the job.  Multiple files are split by\n");
+  fprintf (stderr, "\t                        file, a single LAS file is split into page aligned record ranges.\n");
+  fprintf (stderr, "\t--shard-record    =    Shard completion record file (default is las_zero.shard_I_of_N, or\n");
+  fprintf (stderr, "\t                        LAS_FILE.shard_I_of_N for a single file)\n");
+  fprintf (stderr, "\t--threshold       =    Points with Z above this are withheld (default 0.0)\n");
+  fprintf (stderr, "\t--grid            =    Threshold grid (ESRI .flt/.hdr).  Points are compared to the grid value\n");
+  fprintf (stderr, "\t                        (bilinearly interpolated at the point) plus the threshold.  Points off\n");
+  fprintf (stderr, "\t                        the grid are never withheld.\n");
+  fprintf (stderr, "\t--extra           =    Also withhold points whose extra bytes dimension matches RULE, for\n");
+  fprintf (stderr, "\t                        example TPU>0.5 (NAME>VALUE or NAME<VALUE, scaled values, points\n");
+  fprintf (stderr, "\t                        with the no_data value never match).  Quote it for the shell.  Can be\n");
+  fprintf (stderr, "\t                        given up to %d times.\n", SLAS_ZERO_MAX_EXTRA);
+  fprintf (stderr, "\t--source-id       =    Only process points from these point source IDs (flightlines), for\n");
+  fprintf (stderr, "\t                        example 3,7,10-14\n");
+  fprintf (stderr, "\t--time-range      =    Only process points with GPS time in MIN,MAX\n");
+  fprintf (stderr, "\t--build-index     =    Build the flightline/time index (FILE.slx) for each LAS file and exit.\n");
+  fprintf (stderr, "\t                        With an index, --source-id and --time-range only read the parts of\n");
+  fprintf (stderr, "\t                        the file that can have selected points.\n");
+  fprintf (stderr, "\t--estimate        =    Don't change anything, just estimate (from a stratified sample of\n");
+  fprintf (stderr, "\t                        records) the fraction of points that would be withheld and the\n");
+  fprintf (stderr, "\t                        amount of I/O a real run would do.  LAS files only.\n");
+  fprintf (stderr, "\t--sample          =    Number of records sampled by --estimate (default %d)\n", SLAS_ZERO_SAMPLE_SIZE);
+  fprintf (stderr, "\t--read-limit      =    Limit reads to this many MB/s (for the whole process)\n");
+  fprintf (stderr, "\t--write-limit     =    Limit writes to this many MB/s\n");
+  fprintf (stderr, "\t--read-iops       =    Limit reads to this many operations per second\n");
+  fprintf (stderr, "\t--write-iops      =    Limit writes to this many operations per second\n");
+  fprintf (stderr, "\t--throttle-file   =    Control file for the limits (lines like \"read_mbps 50\", also write_mbps,\n");
+  fprintf (stderr, "\t                        read_iops, and write_iops).  It's checked every second and on SIGHUP.\n");
+  fprintf (stderr, "\t--profile         =    Report cycles, instructions, LLC misses, and context switches per\n");
+  fprintf (stderr, "\t                        million points for each phase (decode, predicate, write back)\n");
+  fprintf (stderr, "\t                        using the hardware counters (Linux perf_event_open)\n");
+  fprintf (stderr, "\t--sort            =    Rewrite LAZ files with the points in Morton (Z) order of X/Y.  LAS\n");
+  fprintf (stderr, "\t                        files are updated in place and are never reordered.  COPC files\n");
+  fprintf (stderr, "\t                        can't be sorted (they'd lose their octree), they fail instead.\n");
+  fprintf (stderr, "\t--sort-memory     =    Memory used by --sort in MB (default %d).  Bigger files are sorted in\n", SLAS_SORT_MEMORY);
+  fprintf (stderr, "\t                        runs that are merged.\n");
+  fprintf (stderr, "\t--sort-index      =    Also write the X/Y bounds of each %d point chunk of the sorted file\n", SLAS_SORT_INDEX_CHUNK);
+  fprintf (stderr, "\t                        to LAZ_FILE.sbx\n");
+  fprintf (stderr, "\t--output          =    Leave the input file alone and write the result to FILE (one input\n");
+  fprintf (stderr, "\t                        file) or to DIRECTORY (any number).  The input is cloned (reflink,\n");
+  fprintf (stderr, "\t                        copy_file_range, or a plain copy) and only the changed records of the\n");
+  fprintf (stderr, "\t                        clone are written.  Not allowed with --shard on a single file.\n");
+  fprintf (stderr, "\t--prefetch        =    With more than one file, start reading the headers and first %d MB\n", SLAS_PREFETCH_BYTES / 1048576);
+  fprintf (stderr, "\t                        of points of the next N files while working on the current one\n");
+  fprintf (stderr, "\t                        (default %d, 0 turns it off)\n", SLAS_PREFETCH_DEPTH);
+  fprintf (stderr, "\t--mem-limit       =    Keep the block buffers, grid tile caches, sort buffers, indexes, COPC\n");
+  fprintf (stderr, "\t                        hierarchies, LAZ chunk tables, and verification checksums of the\n");
+  fprintf (stderr, "\t                        whole process (all threads, and all jobs in daemon mode) under MB\n");
+  fprintf (stderr, "\t                        megabytes.  Block sizes, grid caches, and then threads are cut back\n");
+  fprintf (stderr, "\t                        to fit, a file that still won't fit fails with a memory error.\n");
+  fprintf (stderr, "\t--no-numa         =    Don't spread the worker threads over the NUMA nodes.  Normally, on\n");
+  fprintf (stderr, "\t                        a machine with more than one node, each node's workers are kept on\n");
+  fprintf (stderr, "\t                        its CPUs and work on their own part of the file in local memory.\n");
+  fprintf (stderr, "\t--qa              =    Write QA statistics (bounds, Z histogram, classification and return\n");
+  fprintf (stderr, "\t                        counts, withheld count) gathered during the pass to FILE.qa.json.\n");
+  fprintf (stderr, "\t                        Every record is read (indexes and COPC pruning aren't used).\n");
+  fprintf (stderr, "\t--verify          =    After the pass, flush the file, read back every record the pass read\n");
+  fprintf (stderr, "\t                        (from storage, not the page cache), and check that nothing but the\n");
+  fprintf (stderr, "\t                        withheld bit changed using CRC32C checksums per %d records.  The\n", SLAS_VERIFY_CHUNK);
+  fprintf (stderr, "\t                        checksums go to FILE.crc32c and any mismatch is reported by record\n");
+  fprintf (stderr, "\t                        range.  LAZ files with point formats 6 through 10 are read back\n");
+  fprintf (stderr, "\t                        from the new LAZ file, other LAZ files from the uncompressed copy.\n");
+  fprintf (stderr, "\t--archive         =    Leave LAS files alone and write the result (every record) to a LAZ\n");
+  fprintf (stderr, "\t                        file in the same pass.  FILE.las goes to FILE.laz (in DIRECTORY with\n");
+  fprintf (stderr, "\t                        --output DIRECTORY, or to --output FILE for one input file).  The\n");
+  fprintf (stderr, "\t                        records are read, checked, and compressed (one LAZ chunk per block)\n");
+  fprintf (stderr, "\t                        by the worker threads, the chunks are written in order.  LAZ files\n");
+  fprintf (stderr, "\t                        are handled as usual.  Not allowed with --verify or\n");
+  fprintf (stderr, "\t                        with --shard on a single file.\n");
+  fprintf (stderr, "\t--manifest        =    Keep track of finished files in FILE and skip them next time if they\n");
+  fprintf (stderr, "\t                        haven't changed (and the parameters are the same).  With --output or\n");
+  fprintf (stderr, "\t                        --archive the input file has to be unchanged as well.\n");
+  fprintf (stderr, "\t--list            =    Read more file names (one per line) from FILE\n");
+  fprintf (stderr, "\t--daemon          =    Run resident, taking jobs from the Unix domain socket SOCKET\n");
+  fprintf (stderr, "\t--workers         =    Number of daemon worker threads (default is one per core)\n");
+  fprintf (stderr, "\t--queue           =    Number of daemon jobs allowed to wait for a worker (default %d)\n", LAS_ZERO_DAEMON_QUEUE);
+  fprintf (stderr, "\t--submit          =    Send the files to the daemon listening on SOCKET and wait for\n");
+  fprintf (stderr, "\t                        the results\n\n");
   fflush (stderr);
 }
 
 
-las_zero::las_zero (int32_t argc, char **argv)
+//  Progress callback for slas_zero_file.
+
+static void progress (uint64_t done, uint64_t total, void *user_data)
 {
-  FILE                    *las_fp;
-  LASheader               lasheader;
-  uint8_t                 endian = 0, laz = NVFalse;
-  char                    las_file[1024], laz_file[1024];
-  SLAS_POINT_DATA         slas;
-  QString                 fileLAS, fileLAZ, lzName;
-  int32_t                 recnum = 0, percent = 0, old_percent = -1;
+  int32_t *old_percent = (int32_t *) user_data;
 
+  int32_t percent = NINT (((float) done / (float) total) * 100.0);
+  if (*old_percent != percent)
+    {
+      printf ("%3d%% processed    \r", percent);
+      fflush (stdout);
+      *old_percent = percent;
+    }
+}
 
-  printf ("\n\n %s \n\n", VERSION);
+
+//  There's only ever one throttle per process so it lives here where the SIGHUP handler can get at it.
+
+static SLAS_THROTTLE throttle;
+
+static void throttle_signal (int32_t)
+{
+  slas_throttle_reload (&throttle);
+}
 
 
-  //  Make sure we got the mandatory file name argument.
+//  Parse a point source ID list (like 3,7,10-14) into a 65536 bit map.
 
-  if (argc < 2)
+static int32_t parse_source_ids (const char *list, uint8_t *map)
+{
+  char *copy = strdup (list), *save = NULL;
+
+  for (char *item = strtok_r (copy, ",", &save) ; item ; item = strtok_r (NULL, ",", &save))
     {
-      usage ();
-      exit (-1);
+      int32_t first, last;
+      char junk;
+
+      if (sscanf (item, "%d-%d%c", &first, &last, &junk) != 2)
+        {
+          if (sscanf (item, "%d%c", &first, &junk) != 1)
+            {
+              free (copy);
+              return (-1);
+            }
+
+          last = first;
+        }
+
+      if (first < 0 || last > 65535 || first > last)
+        {
+          free (copy);
+          return (-1);
+        }
+
+      for (int32_t id = first ; id <= last ; id++) map[id >> 3] |= (1 << (id & 7));
     }
 
+  free (copy);
 
-  printf ("\nLAS file : %s\n\n", argv[1]);
+  return (0);
+}
 
 
-  //  If we've got a LAZ file, check for the laszip program.
+//  Parse an extra bytes rule (like TPU>0.5) and add it to the list.
 
-  if (QString (argv[1]).endsWith (".laz") || QString (argv[1]).endsWith (".LAZ"))
-    {
-      strcpy (laz_file, argv[1]);
-      strcpy (las_file, argv[1]);
+static int32_t parse_extra_rule (const char *rule, SLAS_EXTRA_RULES *extra)
+{
+  const char *op = strpbrk (rule, "<>");
+  double value;
+  char junk;
+
+
+  if (extra->count >= SLAS_ZERO_MAX_EXTRA || op == NULL || op == rule || op - rule > 32) return (-1);
 
+  if (sscanf (op + 1, "%lf%c", &value, &junk) != 1) return (-1);
 
-      laz = NVTrue;
+  strncpy (extra->name[extra->count], rule, op - rule);
+  extra->name[extra->count][op - rule] = 0;
+  extra->greater[extra->count] = (*op == '>');
+  extra->value[extra->count] = value;
+  extra->count++;
+
+  return (0);
+}
 
 
-      char lz_name[1024];
+//  Work out what a file's run is about.  In output mode everything (the manifest, the QA file, the zeroing itself) is about
+//  the output file, the input is only read when it's cloned.  The same goes for the LAZ file in archive mode.  The QA and
+//  verification sidecars go next to it (one per shard if the file is split).  Returns NVTrue if the file is archived.
 
+static uint8_t file_targets (const char *file, const char *output, uint8_t output_dir, uint8_t archive, uint8_t split, int32_t shard,
+                             int32_t shards, char *target, char *qa_file, char *verify_file)
+{
+  uint8_t to_archive = (archive && !QString (file).endsWith (".laz", Qt::CaseInsensitive));
+
+  if (output[0] && output_dir)
+    {
+      const char *base = strrchr (file, '/');
 #ifdef NVWIN3X
-      strcpy (lz_name, "laszip.exe");
-#else
-      strcpy (lz_name, "laszip");
+      if (strrchr (file, '\\') > base) base = strrchr (file, '\\');
 #endif
-      if (find_startup_name (lz_name) == NULL)
+      sprintf (target, "%s/%s", output, base ? base + 1 : file);
+    }
+  else
+    {
+      strcpy (target, output[0] ? output : file);
+    }
+
+  if (to_archive && !(output[0] && !output_dir))
+    {
+      char *dot = strrchr (target, '.');
+
+      if (dot && !strchr (dot, '/')) *dot = 0;
+      strcat (target, ".laz");
+    }
+
+  if (split)
+    {
+      sprintf (qa_file, "%s.shard_%d_of_%d.qa.json", target, shard, shards);
+      sprintf (verify_file, "%s.shard_%d_of_%d.crc32c", target, shard, shards);
+    }
+  else
+    {
+      sprintf (qa_file, "%s.qa.json", target);
+      sprintf (verify_file, "%s.crc32c", target);
+    }
+
+  return (to_archive);
+}
+
+
+las_zero::las_zero (int32_t argc, char **argv)
+{
+  SLAS_ZERO_OPTIONS       options;
+  SLAS_ZERO_STATS         stats;
+  int32_t                 status, old_percent = -1, threads = -1, workers = 0, queue_size = LAS_ZERO_DAEMON_QUEUE, option_index = 0;
+  int32_t                 shard = 0, shards = 0;
+  char                    daemon_socket[1024], submit_socket[1024], shard_record[1024], manifest_file[1024], list_file[1024];
+  char                    grid_file[1024];
+  float                   threshold = 0.0;
+  uint8_t                 build_index = NVFalse, time_range = NVFalse, *source_ids = NULL, estimate = NVFalse;
+  uint32_t                sample_size = SLAS_ZERO_SAMPLE_SIZE;
+  uint8_t                 throttled = NVFalse, profile = NVFalse;
+  SLAS_SORT_OPTIONS       sort_options;
+  uint8_t                 sort = NVFalse, qa = NVFalse;
+  SLAS_QA                 qa_stats;
+  char                    output[1024];
+  uint8_t                 output_dir = NVFalse;
+  int32_t                 prefetch_depth = SLAS_PREFETCH_DEPTH;
+  SLAS_PREFETCH           prefetch;
+  uint32_t                mem_limit = 0;
+  SLAS_MEMORY             memory;
+  uint8_t                 numa_off = NVFalse;
+  SLAS_NUMA               numa;
+  SLAS_EXTRA_RULES        extra;
+  uint8_t                 verify = NVFalse;
+  uint8_t                 archive = NVFalse;
+  SLAS_VERIFY             verify_sums;
+  SLAS_PERF_COUNTS        perf;
+  double                  limits[4] = {0.0, 0.0, 0.0, 0.0};
+  char                    throttle_file[1024];
+  double                  time_min = 0.0, time_max = 0.0;
+  SLAS_INDEX              index;
+  SLAS_GRID               grid;
+  extern char             *optarg;
+  extern int              optind;
+
+
+  printf ("\n\n %s \n\n", VERSION);
+
+
+  memset (&sort_options, 0, sizeof (SLAS_SORT_OPTIONS));
+  memset (&extra, 0, sizeof (SLAS_EXTRA_RULES));
+  sort_options.memory = SLAS_SORT_MEMORY;
+
+
+  daemon_socket[0] = submit_socket[0] = shard_record[0] = manifest_file[0] = list_file[0] = grid_file[0] = throttle_file[0] = output[0] = 0;
+
+  while (NVTrue)
+    {
+      static struct option long_options[] = {{"threads", required_argument, 0, 't'},
+                                             {"daemon", required_argument, 0, 0},
+                                             {"workers", required_argument, 0, 0},
+                                             {"queue", required_argument, 0, 0},
+                                             {"submit", required_argument, 0, 0},
+                                             {"shard", required_argument, 0, 0},
+                                             {"shard-record", required_argument, 0, 0},
+                                             {"manifest", required_argument, 0, 0},
+                                             {"list", required_argument, 0, 0},
+                                             {"threshold", required_argument, 0, 0},
+                                             {"grid", required_argument, 0, 0},
+                                             {"build-index", no_argument, 0, 0},
+                                             {"source-id", required_argument, 0, 0},
+                                             {"time-range", required_argument, 0, 0},
+                                             {"estimate", no_argument, 0, 0},
+                                             {"sample", required_argument, 0, 0},
+                                             {"read-limit", required_argument, 0, 0},
+                                             {"write-limit", required_argument, 0, 0},
+                                             {"read-iops", required_argument, 0, 0},
+                                             {"write-iops", required_argument, 0, 0},
+                                             {"throttle-file", required_argument, 0, 0},
+                                             {"profile", no_argument, 0, 0},
+                                             {"sort", no_argument, 0, 0},
+                                             {"sort-memory", required_argument, 0, 0},
+                                             {"sort-index", no_argument, 0, 0},
+                                             {"qa", no_argument, 0, 0},
+                                             {"output", required_argument, 0, 0},
+                                             {"prefetch", required_argument, 0, 0},
+                                             {"mem-limit", required_argument, 0, 0},
+                                             {"no-numa", no_argument, 0, 0},
+                                             {"extra", required_argument, 0, 0},
+                                             {"verify", no_argument, 0, 0},
+                                             {"archive", no_argument, 0, 0},
+                                             {0, no_argument, 0, 0}};
+
+      char c = (char) getopt_long (argc, argv, "t:", long_options, &option_index);
+      if (c == -1) break;
+
+      switch (c)
         {
-          fprintf (stderr, "\n\n*** ERROR ***\nLAZ file %s\nwill not be unloaded because %s is not in the PATH\n", laz_file, lz_name);
-          fflush (stderr);
+        case 0:
+
+          switch (option_index)
+            {
+            case 1:
+              strcpy (daemon_socket, optarg);
+              break;
+
+            case 2:
+              sscanf (optarg, "%d", &workers);
+              break;
+
+            case 3:
+              sscanf (optarg, "%d", &queue_size);
+              break;
+
+            case 4:
+              strcpy (submit_socket, optarg);
+              break;
+
+            case 5:
+              if (slas_shard_parse (optarg, &shard, &shards))
+                {
+                  fprintf (stderr, "\nBad shard specification %s (should be I/N with 0 <= I < N)\n\n", optarg);
+                  fflush (stderr);
+                  exit (-1);
+                }
+              break;
+
+            case 6:
+              strcpy (shard_record, optarg);
+              break;
+
+            case 7:
+              strcpy (manifest_file, optarg);
+              break;
+
+            case 8:
+              strcpy (list_file, optarg);
+              break;
+
+            case 9:
+              sscanf (optarg, "%f", &threshold);
+              break;
+
+            case 10:
+              strcpy (grid_file, optarg);
+              break;
+
+            case 11:
+              build_index = NVTrue;
+              break;
+
+            case 12:
+              if (source_ids == NULL) source_ids = (uint8_t *) calloc (65536 / 8, 1);
+
+              if (source_ids == NULL || parse_source_ids (optarg, source_ids))
+                {
+                  fprintf (stderr, "\nBad point source ID list %s\n\n", optarg);
+                  fflush (stderr);
+                  exit (-1);
+                }
+              break;
+
+            case 13:
+              if (sscanf (optarg, "%lf,%lf", &time_min, &time_max) != 2 || time_min > time_max)
+                {
+                  fprintf (stderr, "\nBad GPS time range %s (should be MIN,MAX)\n\n", optarg);
+                  fflush (stderr);
+                  exit (-1);
+                }
+              time_range = NVTrue;
+              break;
+
+            case 14:
+              estimate = NVTrue;
+              break;
+
+            case 15:
+              sscanf (optarg, "%u", &sample_size);
+              break;
+
+            case 16:
+              sscanf (optarg, "%lf", &limits[0]);
+              throttled = NVTrue;
+              break;
+
+            case 17:
+              sscanf (optarg, "%lf", &limits[1]);
+              throttled = NVTrue;
+              break;
+
+            case 18:
+              sscanf (optarg, "%lf", &limits[2]);
+              throttled = NVTrue;
+              break;
+
+            case 19:
+              sscanf (optarg, "%lf", &limits[3]);
+              throttled = NVTrue;
+              break;
+
+            case 20:
+              strcpy (throttle_file, optarg);
+              throttled = NVTrue;
+              break;
+
+            case 21:
+              profile = NVTrue;
+              break;
+
+            case 22:
+              sort = NVTrue;
+              break;
+
+            case 23:
+              sscanf (optarg, "%u", &sort_options.memory);
+              break;
+
+            case 24:
+              sort_options.index_chunk = SLAS_SORT_INDEX_CHUNK;
+              break;
+
+            case 25:
+              qa = NVTrue;
+              break;
+
+            case 26:
+              strcpy (output, optarg);
+              break;
+
+            case 27:
+              sscanf (optarg, "%d", &prefetch_depth);
+              break;
+
+            case 28:
+              sscanf (optarg, "%u", &mem_limit);
+              break;
+
+            case 29:
+              numa_off = NVTrue;
+              break;
+
+            case 30:
+              if (parse_extra_rule (optarg, &extra))
+                {
+                  fprintf (stderr, "\nBad extra bytes rule %s (should be NAME>VALUE or NAME<VALUE, at most %d of them)\n\n", optarg,
+                           SLAS_ZERO_MAX_EXTRA);
+                  fflush (stderr);
+                  exit (-1);
+                }
+              break;
+
+            case 31:
+              verify = NVTrue;
+              break;
+
+            case 32:
+              archive = NVTrue;
+              break;
+            }
+          break;
+
+        case 't':
+          sscanf (optarg, "%d", &threads);
+          break;
+
+        default:
+          usage ();
           exit (-1);
+          break;
         }
+    }
 
 
-      lzName = QString (lz_name);
+  slas_zero_default_options (&options);
+
+  options.threshold = threshold;
+  options.selection.source_ids = source_ids;
+  options.selection.time_range = time_range;
+  options.selection.time_min = time_min;
+  options.selection.time_max = time_max;
+
+  if (extra.count) options.extra = &extra;
+
+
+  //  Sorting only happens when a LAZ file is rewritten.
+
+  if (sort)
+    {
+      sort_options.threads = (threads > 0) ? threads : 0;
+
+      options.sort = &sort_options;
     }
-  else
+
+
+  //  Like the throttle, the memory limit is shared by every thread (and in daemon mode, every job) in the process.
+
+  if (mem_limit)
     {
-      strcpy (las_file, argv[1]);
+      slas_memory_init (&memory, (uint64_t) mem_limit * 1048576);
+
+      options.memory = &memory;
     }
 
 
-  //  Open the LAS file with LASlib and read the header.
+  //  Spread the worker threads over the NUMA nodes (if there's more than one).
+
+  if (!numa_off && slas_numa_init (&numa) > 1) options.numa = &numa;
+
 
-  LASreadOpener lasreadopener;
-  LASreader *lasreader;
+  //  I/O throttling applies to every thread (and in daemon mode, every job) in the process.  SIGHUP makes it reread
+  //  the control file right away.
 
-  lasreadopener.set_file_name (las_file);
-  lasreader = lasreadopener.open ();
-  if (!lasreader)
+  if (throttled)
     {
-      fprintf (stderr, "\n\n*** ERROR ***\nUnable to open LAS file %s\n", las_file);
-      fflush (stderr);
-      exit (-1);
+      slas_throttle_init (&throttle, limits[0], limits[1], limits[2], limits[3], throttle_file);
+
+      options.throttle = &throttle;
+
+#ifndef NVWIN3X
+      signal (SIGHUP, throttle_signal);
+#endif
     }
 
 
-  lasheader = lasreader->header;
+  //  With a threshold grid the threshold is an offset from the (interpolated) grid value.
+
+  if (grid_file[0])
+    {
+      if (slas_grid_open (&grid, grid_file)) exit (-1);
+
+      options.grid = &grid;
+    }
 
 
-  if (lasheader.version_major != 1)
+  //  Daemon mode.  Each job gets one thread unless told otherwise, the parallelism comes from the worker pool.
+
+  if (daemon_socket[0])
     {
-      lasreader->close ();
-      fprintf (stderr, "\nLAS major version %d incorrect, file %s : %s %s %d\n\n", lasheader.version_major, las_file, __FILE__, __FUNCTION__, __LINE__);
-      fflush (stderr);
-      exit (-1);
+      options.threads = (threads > 0) ? threads : 1;
+
+      exit (las_zero_daemon (daemon_socket, workers, queue_size, &options));
     }
 
 
-  if (lasheader.version_minor > 4)
+  //  Gather up the file names from the command line and the --list file (one name per line).
+
+  int32_t count = argc - optind, errors = 0, skipped = 0;
+  char **files = &argv[optind];
+
+  if (list_file[0])
     {
-      lasreader->close ();
-      fprintf (stderr, "\nLAS minor version %d incorrect, file %s : %s %s %d\n\n", lasheader.version_minor, las_file, __FILE__, __FUNCTION__, __LINE__);
-      fflush (stderr);
+      FILE *fp;
+      char name[1024];
+
+      if ((fp = fopen (list_file, "r")) == NULL)
+        {
+          perror (list_file);
+          exit (-1);
+        }
+
+      files = (char **) malloc ((count + 1) * sizeof (char *));
+      if (files == NULL)
+        {
+          perror ("Allocating file list");
+          exit (-1);
+        }
+
+      memcpy (files, &argv[optind], count * sizeof (char *));
+
+      while (fgets (name, sizeof (name), fp))
+        {
+          if (strchr (name, '\n')) *strchr (name, '\n') = 0;
+          if (strchr (name, '\r')) *strchr (name, '\r') = 0;
+
+          if (!name[0]) continue;
+
+          files = (char **) realloc (files, (count + 1) * sizeof (char *));
+          if (files == NULL)
+            {
+              perror ("Allocating file list");
+              exit (-1);
+            }
+
+          files[count++] = strdup (name);
+        }
+
+      fclose (fp);
+    }
+
+
+  //  Make sure we got at least one file name.
+
+  if (!count)
+    {
+      usage ();
       exit (-1);
     }
 
 
-  //  Now close it since all we really wanted was the header.
+  //  Client mode.
+
+  if (submit_socket[0]) exit (las_zero_submit (submit_socket, count, files));
 
-  lasreader->close ();
 
+  //  Index building mode.
 
-  //  Check for endian-ness.
+  if (build_index)
+    {
+      for (int32_t i = 0 ; i < count ; i++)
+        {
+          printf ("Indexing %s\n", files[i]);
+          fflush (stdout);
+
+          if (slas_index_build_file (files[i], 0)) errors++;
+        }
+
+      exit (errors ? -1 : 0);
+    }
 
-  endian = big_endian ();
 
+  uint8_t split = NVFalse;
 
-  //  If it's a LAZ file we have to uncompress it, update the LAS file, then recompress it.  What A PITA!
 
-  if (laz)
+  //  Sharding.  With more than one file we pick our share of the files, with a single file we take our share of its
+  //  records.
+
+  if (shards)
     {
-      QProcess unzipper;
-      QStringList uparams;
+      if (count > 1)
+        {
+          count = slas_shard_files (count, files, shard, shards);
+        }
+      else
+        {
+          split = NVTrue;
+        }
 
-      fileLAS = fileLAZ = QString (laz_file);
+      if (!shard_record[0])
+        {
+          if (split)
+            {
+              sprintf (shard_record, "%s.shard_%d_of_%d", files[0], shard, shards);
+            }
+          else
+            {
+              sprintf (shard_record, "las_zero.shard_%d_of_%d", shard, shards);
+            }
+        }
 
-      uparams << fileLAZ;
+      printf ("Shard %d of %d : %d file(s)\n\n", shard, shards, count);
+    }
 
-      unzipper.start (lzName, uparams);
 
-      unzipper.waitForFinished (-1);
+  //  Output mode.  More than one file means the output has to be a directory.  Shards of a single file would all be
+  //  cloning (and truncating) the same output file.
 
-      fileLAS.replace (".laz", ".las");
+  if (output[0])
+    {
+      struct stat st;
 
-      strcpy (las_file, fileLAS.toLatin1 ());
+      output_dir = (!stat (output, &st) && S_ISDIR (st.st_mode));
+
+      if (split || (count > 1 && !output_dir))
+        {
+          fprintf (stderr, "\n--output must be a directory for more than one file and can't be used with --shard on a single file\n\n");
+          fflush (stderr);
+          exit (-1);
+        }
     }
 
 
-  //  Open the file for update.
+  //  The archive gets every record of the file in one go, and there's nothing changed in place to verify.
 
-  if ((las_fp = fopen64 (las_file, "rb+")) == NULL)
+  if (archive && (split || verify))
     {
-      fprintf (stderr, "\nError opening LAS file %s : %s\n\n", las_file, strerror (errno));
+      fprintf (stderr, "\n--archive can't be used with --verify or with --shard on a single file\n\n");
       fflush (stderr);
       exit (-1);
     }
 
 
-  for (uint64_t i = 0 ; i < lasheader.number_of_point_records ; i++)
+  SLAS_SHARD_ENTRY *entries = (SLAS_SHARD_ENTRY *) calloc (qMax (count, 1), sizeof (SLAS_SHARD_ENTRY));
+
+  if (entries == NULL)
+    {
+      perror ("Allocating shard entries");
+      exit (-1);
+    }
+
+
+  //  The manifest lets us skip files that haven't changed since the last successful run.  It isn't used when we're only
+  //  doing part of a single file.
+
+  SLAS_MANIFEST manifest;
+  char params[256];
+
+  if (manifest_file[0] && !split)
+    {
+      if (slas_manifest_open (&manifest, manifest_file)) exit (-1);
+    }
+  else
+    {
+      manifest_file[0] = 0;
+    }
+
+
+  if (threads > 0) options.threads = threads;
+
+  slas_manifest_params (&options, params, sizeof (params));
+
+  options.progress = progress;
+  options.user_data = &old_percent;
+
+
+  //  Check the whole batch against the manifest before we start so that the prefetcher doesn't warm up files we're going
+  //  to skip.  The manifest entry is for the target.  If that's made from the input (--output or --archive) the input
+  //  has to be the same one, unchanged, as well.
+
+  uint8_t *unchanged = NULL;
+
+  if (manifest_file[0] && !estimate)
     {
-      if (slas_read_point_data (las_fp, i, &lasheader, endian, &slas))
+      if ((unchanged = (uint8_t *) calloc (count, sizeof (uint8_t))) == NULL)
         {
-          fprintf (stderr, "\nError reading record %" PRIu64 " from %s : %s\n\n", i, las_file, strerror (errno));
-          fflush (stderr);
+          perror ("Allocating manifest flags");
           exit (-1);
         }
 
-      if (slas.z > 0.0)
+      for (int32_t i = 0 ; i < count ; i++)
         {
-          slas.withheld = 1;
+          char target[2100], qa_file[1100], verify_file[1100];
+
+          file_targets (files[i], output, output_dir, archive, split, shard, shards, target, qa_file, verify_file);
+
+          unchanged[i] = (slas_manifest_up_to_date (&manifest, target, strcmp (target, files[i]) ? files[i] : NULL, params) &&
+                          (!qa || QFile::exists (QString (qa_file))) && (!verify || QFile::exists (QString (verify_file))));
+        }
+    }
 
-          if (slas_update_point_data (las_fp, i, &lasheader, endian, &slas))
+
+  //  Batch runs get the next few files warmed up while we work on the current one.  Estimates only read a small sample
+  //  of each file so there's nothing worth warming up for them.
+
+  slas_prefetch_start (&prefetch, files, count, estimate ? 0 : prefetch_depth, SLAS_PREFETCH_BYTES, unchanged);
+
+
+  for (int32_t i = 0 ; i < count ; i++)
+    {
+      char *file = files[i];
+
+      slas_prefetch_advance (&prefetch, i);
+
+      strncpy (entries[i].path, file, sizeof (entries[i].path) - 1);
+
+
+      //  Estimate mode.  One line per file, meant to be read by a scheduler.
+
+      if (estimate)
+        {
+          SLAS_ZERO_ESTIMATE est;
+
+          if ((status = slas_zero_estimate_file (file, &options, sample_size, &est)))
             {
-              fprintf (stderr, "\nError %s updating record %d in file %s : %s %s %d\n\n", strerror (errno), recnum, las_file, __FILE__, __FUNCTION__,
-                       __LINE__);
-              fflush (stderr);
-              fclose (las_fp);
-              exit (-1);
+              printf ("ESTIMATE %s error=%d %s\n", file, status, slas_zero_strerror (status));
+              entries[i].status = status;
+              errors++;
             }
+          else
+            {
+              printf ("ESTIMATE %s records=%" PRIu64 " sample=%u fraction=%.6f low=%.6f high=%.6f read_bytes=%" PRIu64
+                      " write_bytes_low=%" PRIu64 " write_bytes_high=%" PRIu64 " seconds=%.3f\n", file, est.records, est.sample, est.fraction,
+                      est.fraction_low, est.fraction_high, est.read_bytes, est.write_bytes_low, est.write_bytes_high, est.seconds);
+            }
+
+          fflush (stdout);
+          continue;
         }
 
-      percent = NINT (((float) i / (float) lasheader.number_of_point_records) * 100.0);
-      if (old_percent != percent)
+
+      printf ("\nLAS file : %s\n\n", file);
+
+
+      char target[2100], qa_file[1100], verify_file[1100];
+      uint8_t to_archive = file_targets (file, output, output_dir, archive, split, shard, shards, target, qa_file, verify_file);
+      const char *source = strcmp (target, file) ? file : NULL;
+
+      old_percent = -1;
+
+
+      //  Checked against the manifest before we started.
+
+      if (unchanged && unchanged[i])
         {
-          printf ("%3d%% processed    \r", percent);
+          printf ("Unchanged since the last run, skipping\n\n");
           fflush (stdout);
-          old_percent = percent;
+          skipped++;
+          continue;
         }
-    }
 
-  fclose (las_fp);
 
+      //  Our range of records if we're splitting a single file between shards.
 
-  printf ("100%% processed    \n\n");
-  fflush (stdout);
+      options.first_record = options.num_records = 0;
 
+      if (split)
+        {
+          if ((status = slas_shard_file_range (file, shard, shards, &options.first_record, &options.num_records)))
+            {
+              fprintf (stderr, "\n\n*** ERROR ***\n%s : %s\n\n", slas_zero_strerror (status), file);
+              fflush (stderr);
+              entries[i].status = status;
+              errors++;
+              continue;
+            }
 
-  //  Recompress if it was LAZ
+          entries[i].first_record = options.first_record;
 
-  if (laz)
-    {
-      //  We have to rename the old LAZ file to WHATEVER.bck, compress the new LAS file to the old LAZ file name, delete the LAS file,
-      //  then delete the BCK file.  At that point we are back to the original LAZ file name.
 
-      QString backFile (fileLAZ);
-      backFile.replace (".laz", ".bck");
 
-      QFile bckFile (fileLAZ);
+          //  Small files (or LAZ files for anyone but shard 0) may leave us with nothing to do.
+
+          if (!options.num_records) continue;
+
+          printf ("Records %" PRIu64 " through %" PRIu64 "\n\n", options.first_record, options.first_record + options.num_records - 1);
+        }
+
 
-      if (!bckFile.rename (backFile))
+      //  If we're only doing some flightlines/times, use the index (if there is one) to skip the parts of the file that
+      //  can't have anything we want.
+
+      options.index = NULL;
+
+      if ((source_ids || time_range) && !QString (file).endsWith (".laz", Qt::CaseInsensitive))
         {
-          fprintf (stderr, "\n\n*** ERROR ***\nUnable to rename LAZ file %s\n", laz_file);
-          fflush (stderr);
-          exit (-1);
+          char index_file[1100];
+
+          slas_index_name (file, index_file);
+
+          if ((status = slas_index_read (index_file, options.memory, &index)) == -2)
+            {
+              fprintf (stderr, "\n\n*** ERROR ***\n%s : %s\n\n", slas_zero_strerror (SLAS_ZERO_MEMORY_ERROR), index_file);
+              fflush (stderr);
+              entries[i].status = SLAS_ZERO_MEMORY_ERROR;
+              errors++;
+              continue;
+            }
+
+          if (status)
+            {
+              printf ("No index for %s, every record will be checked (use --build-index)\n\n", file);
+            }
+          else
+            {
+              options.index = &index;
+            }
         }
 
 
-      QProcess zipper;
-      QStringList zparams;
+      if (output[0] && !to_archive)
+        {
+          int32_t method;
 
-      zparams << fileLAS;
+          if (slas_clone_file (file, target, &method))
+            {
+              if (options.index) slas_index_free (&index);
+              entries[i].status = SLAS_ZERO_OPEN_ERROR;
+              errors++;
+              continue;
+            }
 
-      zipper.start (lzName, zparams);
+          printf ("Copied to %s (%s)\n\n", target, slas_clone_method_name (method));
+          fflush (stdout);
+        }
 
-      zipper.waitForFinished (-1);
 
+      if (profile)
+        {
+          slas_perf_init_counts (&perf);
+          options.perf = &perf;
+        }
 
-      QFile lasFile (fileLAS);
+      if (qa) options.qa = &qa_stats;
 
-      if (!lasFile.remove ())
+      if (verify)
         {
-          char name[1024];
-          strcpy (name, fileLAS.toLatin1 ());
+          memset (&verify_sums, 0, sizeof (SLAS_VERIFY));
+          options.verify = &verify_sums;
+        }
 
-          fprintf (stderr, "\n\n*** ERROR ***\nUnable to remove LAS file %s\n", name);
-          fflush (stderr);
-          exit (-1);
+
+      if (to_archive)
+        {
+          options.archive = target;
+          status = slas_zero_file (file, &options, &stats);
+          options.archive = NULL;
         }
+      else
+        {
+          status = slas_zero_file (target, &options, &stats);
+        }
+
+      if (options.index) slas_index_free (&index);
+
+
+      //  Report exactly which records failed verification and keep the checksums whether it passed or not.  There's
+      //  nothing to report if the file was left alone (a COPC file with no node above the threshold) or the pass itself
+      //  failed.
 
-      if (!bckFile.remove ())
+      if (verify && verify_sums.num_chunks && (!status || status == SLAS_ZERO_VERIFY_ERROR))
         {
-          char name[1024];
-          strcpy (name, backFile.toLatin1 ());
+          for (uint32_t c = 0 ; c < verify_sums.num_chunks ; c++)
+            {
+              if (!verify_sums.records[c] || verify_sums.before[c] == verify_sums.after[c]) continue;
+
+              uint64_t first = (uint64_t) c * verify_sums.chunk_size;
+
+              fprintf (stderr, "\nRecords %" PRIu64 " through %" PRIu64 " of %s changed in more than the withheld bit\n", first,
+                       qMin (first + verify_sums.chunk_size, verify_sums.number_of_points) - 1, target);
+            }
 
-          fprintf (stderr, "\n\n*** ERROR ***\nUnable to remove BCK file %s\n", name);
+          if (slas_verify_write (&verify_sums, verify_file, target)) errors++;
+        }
+
+      if (verify) slas_verify_free (&verify_sums);
+
+      if (status)
+        {
+          fprintf (stderr, "\n\n*** ERROR ***\n%s : %s\n\n", slas_zero_strerror (status), target);
           fflush (stderr);
-          exit (-1);
+          entries[i].status = status;
+          errors++;
+
+          if (manifest_file[0]) slas_manifest_remove (&manifest, target);
+
+          continue;
+        }
+
+      entries[i].num_records = stats.records;
+      entries[i].stats = stats;
+
+
+      printf ("100%% processed    \n\n");
+      printf ("%" PRIu64 " records, %" PRIu64 " withheld (%" PRIu64 " already withheld), %.2f seconds\n\n", stats.records, stats.withheld,
+              stats.already_withheld, stats.seconds);
+      if (profile) slas_perf_report (stdout, &perf);
+      if (options.throttle && throttle.waits) printf ("Throttled %" PRIu64 " times, %.2f seconds total\n\n", throttle.waits, throttle.waited);
+      for (int32_t n = 0 ; n < stats.nodes ; n++)
+        printf ("NUMA node %d : %" PRIu64 " records, %.2f seconds, %.2f million records per second\n", stats.node[n], stats.node_records[n],
+                stats.node_seconds[n], stats.node_seconds[n] > 0.0 ? (double) stats.node_records[n] / stats.node_seconds[n] / 1000000.0 : 0.0);
+      if (stats.nodes) printf ("\n");
+      if (stats.skipped) printf ("%" PRIu64 " records skipped using the index (or COPC hierarchy)\n\n", stats.skipped);
+      if (to_archive)
+        printf ("Archived to %s (%.1f MB, %.1f%% of the LAS records)\n\n", target, (double) stats.bytes_written / 1048576.0,
+                stats.bytes_read ? 100.0 * (double) stats.bytes_written / (double) stats.bytes_read : 0.0);
+      if (verify && verify_sums.checked)
+        printf ("Verified %" PRIu64 " records in %.2f seconds (%.1f MB/s, %s CRC32C)\n\n", verify_sums.checked, verify_sums.seconds,
+                verify_sums.seconds > 0.0 ? (double) stats.bytes_read / verify_sums.seconds / 1048576.0 : 0.0,
+                verify_sums.hardware ? "SSE4.2" : "table");
+      fflush (stdout);
+
+      if (qa && slas_qa_write (&qa_stats, qa_file, target)) errors++;
+
+
+      //  Save the manifest every so often so that we don't lose everything if we get killed partway through a big batch.
+
+      if (manifest_file[0])
+        {
+          if (slas_manifest_update (&manifest, target, source, params, &stats))
+            {
+              fprintf (stderr, "\nUnable to add %s to the manifest\n\n", target);
+              fflush (stderr);
+            }
+
+          if (manifest.modified >= 100) slas_manifest_save (&manifest);
         }
     }
+
+
+  slas_prefetch_stop (&prefetch);
+
+  if (unchanged) free (unchanged);
+
+
+  if (manifest_file[0])
+    {
+      if (manifest.modified && slas_manifest_save (&manifest)) errors++;
+      slas_manifest_close (&manifest);
+
+      if (skipped) printf ("%d of %d file(s) were unchanged and skipped\n\n", skipped, count);
+    }
+
+
+  if (mem_limit) printf ("Peak memory reserved %.1f MB of %u MB\n\n", (double) memory.peak / 1048576.0, mem_limit);
+
+
+  if (shards && slas_shard_write_record (shard_record, shard, shards, options.threshold, count, entries)) errors++;
+
+  free (entries);
+
+
+  if (errors) exit (-1);
 }
 
 
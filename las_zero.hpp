@@ -31,6 +31,7 @@
 #include <string.h>
 #include <math.h>
 #include <getopt.h>
+#include <sys/stat.h>
 
 
 // Local Includes.
@@ -40,6 +41,12 @@
 
 #include <lasreader.hpp>
 #include <slas.hpp>
+#include "slas_zero.hpp"
+#include "slas_manifest.hpp"
+#include "slas_shard.hpp"
+#include "slas_clone.hpp"
+#include "slas_prefetch.hpp"
+#include "las_zero_daemon.hpp"
 
 #include "version.hpp"
 
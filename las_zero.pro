@@ -17,5 +17,5 @@ DEPENDPATH += .
 INCLUDEPATH += .
 
 # Input
-HEADERS += las_zero.hpp slas.hpp version.hpp
-SOURCES += las_zero.cpp slas.cpp
+HEADERS += las_zero.hpp las_zero_daemon.hpp slas.hpp slas_clone.hpp slas_copc.hpp slas_grid.hpp slas_index.hpp slas_laz.hpp slas_manifest.hpp slas_memory.hpp slas_numa.hpp slas_perf.hpp slas_prefetch.hpp slas_qa.hpp slas_shard.hpp slas_sort.hpp slas_throttle.hpp slas_verify.hpp slas_zero.hpp version.hpp
+SOURCES += las_zero.cpp las_zero_daemon.cpp slas.cpp slas_clone.cpp slas_copc.cpp slas_grid.cpp slas_index.cpp slas_laz.cpp slas_manifest.cpp slas_memory.cpp slas_numa.cpp slas_perf.cpp slas_prefetch.cpp slas_qa.cpp slas_shard.cpp slas_sort.cpp slas_throttle.cpp slas_verify.cpp slas_zero.cpp
@@ -0,0 +1,699 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+
+#include "las_zero_daemon.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#ifndef NVWIN3X
+#include <limits.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+
+#ifdef NVWIN3X
+
+
+int32_t las_zero_daemon (const char *socket_path, int32_t workers, int32_t queue_size, SLAS_ZERO_OPTIONS *options)
+{
+  fprintf (stderr, "\nDaemon mode is not available on Windows\n\n");
+  fflush (stderr);
+  return (-1);
+}
+
+
+int32_t las_zero_submit (const char *socket_path, int32_t count, char **files)
+{
+  fprintf (stderr, "\nDaemon mode is not available on Windows\n\n");
+  fflush (stderr);
+  return (-1);
+}
+
+
+#else
+
+
+//  Maximum number of simultaneous client connections and the longest request line we'll accept.
+
+#define MAX_CLIENTS     256
+#define MAX_LINE        2048
+
+
+typedef struct
+{
+  int32_t                     client;                          //!<  Index into the client table
+  uint64_t                    serial;                          //!<  Serial number of the connection (so a recycled slot doesn't get the reply)
+  char                        path[1024];
+  int32_t                     status;
+  SLAS_ZERO_STATS             stats;
+} DAEMON_JOB;
+
+
+typedef struct
+{
+  int32_t                     fd;                              //!<  -1 if the slot is free
+  uint64_t                    serial;
+  char                        line[MAX_LINE];                  //!<  Partial request line
+  int32_t                     line_len;
+} DAEMON_CLIENT;
+
+
+//  Everything the workers share with the main (socket) thread.  The pending queue is a fixed size ring, finished jobs go
+//  on the done ring and a byte down the wake pipe tells the main thread to go look at it.  Every job is pending, running,
+//  or done so the done ring can't overflow as long as we never have more than size jobs in all three (see queue_full).
+
+typedef struct
+{
+  DAEMON_JOB                  *pending;
+  DAEMON_JOB                  *done;
+  int32_t                     size;
+  int32_t                     limit;                           //!<  Maximum number of pending jobs (the back-pressure point)
+  int32_t                     pending_head;
+  int32_t                     pending_count;
+  int32_t                     done_head;
+  int32_t                     done_count;
+  int32_t                     running;                         //!<  Jobs taken off pending but not yet on done
+  uint8_t                     shutdown;
+  int32_t                     wake[2];
+  SLAS_ZERO_OPTIONS           options;
+  QMutex                      mutex;
+  QWaitCondition              work;
+} DAEMON_QUEUE;
+
+
+static volatile sig_atomic_t stop_daemon = 0;
+
+
+//  Back-pressure point.  Workers move jobs from pending to done on their own so a full pending queue isn't the only
+//  limit, finished jobs that the main thread hasn't replied to yet count too.  Call this with the queue mutex locked.
+
+static uint8_t queue_full (DAEMON_QUEUE *queue)
+{
+  return (queue->pending_count >= queue->limit || queue->pending_count + queue->running + queue->done_count >= queue->size);
+}
+
+static void daemon_signal (int32_t)
+{
+  stop_daemon = 1;
+}
+
+
+class daemon_worker : public QThread
+{
+public:
+
+  DAEMON_QUEUE *queue;
+
+protected:
+
+  void run ()
+  {
+    DAEMON_JOB  job;
+
+
+    while (1)
+      {
+        queue->mutex.lock ();
+
+        while (!queue->pending_count && !queue->shutdown) queue->work.wait (&queue->mutex);
+
+        if (queue->shutdown)
+          {
+            queue->mutex.unlock ();
+            return;
+          }
+
+        job = queue->pending[queue->pending_head];
+        queue->pending_head = (queue->pending_head + 1) % queue->size;
+        queue->pending_count--;
+        queue->running++;
+
+        queue->mutex.unlock ();
+
+
+        //  Each job gets its own copy of the options (there's nothing in there that the pass writes to but we don't
+        //  want to rely on that).
+
+        SLAS_ZERO_OPTIONS options = queue->options;
+
+        job.status = slas_zero_file (job.path, &options, &job.stats);
+
+
+        queue->mutex.lock ();
+
+        queue->done[(queue->done_head + queue->done_count) % queue->size] = job;
+        queue->done_count++;
+        queue->running--;
+
+        queue->mutex.unlock ();
+
+        if (write (queue->wake[1], "x", 1) < 0) {};
+      }
+  }
+};
+
+
+//  Send one reply line.  The socket has a send timeout so a client that stops reading can't hang the daemon, it just
+//  gets dropped.
+
+static int32_t send_line (int32_t fd, const char *line)
+{
+  size_t len = strlen (line);
+
+  while (len)
+    {
+      ssize_t put = send (fd, line, len, MSG_NOSIGNAL);
+
+      if (put < 0 && errno == EINTR) continue;
+      if (put <= 0) return (-1);
+
+      line += put;
+      len -= put;
+    }
+
+  return (0);
+}
+
+
+static void drop_client (DAEMON_CLIENT *client)
+{
+  if (client->fd >= 0) close (client->fd);
+  client->fd = -1;
+  client->line_len = 0;
+}
+
+
+
+//  Queue every complete request line in the client's buffer.  We stop as soon as the queue is full, anything left over
+//  stays in the client buffer and gets picked up at the top of the main loop once a slot has been freed.
+
+static void queue_requests (DAEMON_QUEUE *queue, DAEMON_CLIENT *clients, int32_t slot)
+{
+  DAEMON_CLIENT *client = &clients[slot];
+  char *start = client->line, *end;
+
+
+  while ((end = (char *) memchr (start, '\n', client->line_len - (start - client->line))) != NULL)
+    {
+      *end = 0;
+      if (end > start && end[-1] == '\r') end[-1] = 0;
+
+      if (!strncmp (start, "ZERO ", 5) && strlen (&start[5]) < sizeof (((DAEMON_JOB *) 0)->path))
+        {
+          queue->mutex.lock ();
+
+          if (queue_full (queue))
+            {
+              queue->mutex.unlock ();
+              *end = '\n';
+              break;
+            }
+
+          DAEMON_JOB *job = &queue->pending[(queue->pending_head + queue->pending_count) % queue->size];
+
+          memset (job, 0, sizeof (DAEMON_JOB));
+          job->client = slot;
+          job->serial = client->serial;
+          strcpy (job->path, &start[5]);
+
+          queue->pending_count++;
+          queue->work.wakeOne ();
+
+          queue->mutex.unlock ();
+        }
+      else
+        {
+          char reply[MAX_LINE + 64];
+          snprintf (reply, sizeof (reply), "ERROR - -1 Bad request: %s\n", start);
+
+          if (send_line (client->fd, reply))
+            {
+              drop_client (client);
+              return;
+            }
+        }
+
+      start = end + 1;
+    }
+
+
+  //  Keep whatever's left over (a partial line or lines we didn't have room to queue).
+
+  client->line_len -= (start - client->line);
+  memmove (client->line, start, client->line_len);
+
+
+  //  A full buffer without a single complete line in it is garbage.
+
+  if (client->line_len >= MAX_LINE && memchr (client->line, '\n', client->line_len) == NULL)
+    {
+      send_line (client->fd, "ERROR - -1 Request line too long\n");
+      drop_client (client);
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    las_zero_daemon
+
+ - Purpose:     Run las_zero as a resident daemon serving jobs from a Unix domain socket.
+                See las_zero_daemon.hpp for the protocol.  This only returns on an error or
+                when we get SIGINT/SIGTERM.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - socket_path    =    Path of the Unix domain socket to listen on
+                - workers        =    Number of worker threads (0 = one per core)
+                - queue_size     =    Maximum number of jobs waiting for a worker
+                - options        =    SLAS_ZERO_OPTIONS used for every job
+
+ - Returns:     int32_t          =    0 on normal shutdown, -1 on error
+
+*********************************************************************************************/
+
+int32_t las_zero_daemon (const char *socket_path, int32_t workers, int32_t queue_size, SLAS_ZERO_OPTIONS *options)
+{
+  DAEMON_QUEUE        queue;
+  DAEMON_CLIENT       clients[MAX_CLIENTS];
+  struct pollfd       fds[MAX_CLIENTS + 2];
+  int32_t             poll_client[MAX_CLIENTS + 2];
+  struct sockaddr_un  addr;
+  int32_t             listen_fd;
+  uint64_t            serial = 0;
+
+
+  if (workers <= 0) workers = QThread::idealThreadCount ();
+  if (workers <= 0) workers = 1;
+  if (queue_size <= 0) queue_size = LAS_ZERO_DAEMON_QUEUE;
+
+
+  if (strlen (socket_path) >= sizeof (addr.sun_path))
+    {
+      fprintf (stderr, "\nSocket path %s is too long\n\n", socket_path);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  //  Set up the queues.  The done ring also has to hold anything that the workers are still running so it gets the
+  //  same size as the pending ring plus the number of workers.
+
+  queue.size = queue_size + workers;
+  queue.pending = (DAEMON_JOB *) calloc (queue.size, sizeof (DAEMON_JOB));
+  queue.done = (DAEMON_JOB *) calloc (queue.size, sizeof (DAEMON_JOB));
+  queue.pending_head = queue.pending_count = 0;
+  queue.done_head = queue.done_count = 0;
+  queue.running = 0;
+  queue.limit = queue_size;
+  queue.shutdown = NVFalse;
+  queue.options = *options;
+
+  if (queue.pending == NULL || queue.done == NULL || pipe (queue.wake))
+    {
+      fprintf (stderr, "\nUnable to set up the job queue : %s\n\n", strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  //  Open the socket.  If there's a stale socket file lying around from a previous run, get rid of it.
+
+  if ((listen_fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0)
+    {
+      fprintf (stderr, "\nUnable to create socket : %s\n\n", strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, socket_path);
+
+  unlink (socket_path);
+
+  if (bind (listen_fd, (struct sockaddr *) &addr, sizeof (addr)) || listen (listen_fd, 64))
+    {
+      fprintf (stderr, "\nUnable to listen on %s : %s\n\n", socket_path, strerror (errno));
+      fflush (stderr);
+      close (listen_fd);
+      return (-1);
+    }
+
+
+  for (int32_t i = 0 ; i < MAX_CLIENTS ; i++)
+    {
+      clients[i].fd = -1;
+      clients[i].line_len = 0;
+    }
+
+
+  signal (SIGPIPE, SIG_IGN);
+  signal (SIGINT, daemon_signal);
+  signal (SIGTERM, daemon_signal);
+
+
+  //  Start the (persistent) worker pool.
+
+  daemon_worker *pool = new daemon_worker[workers];
+
+  for (int32_t i = 0 ; i < workers ; i++)
+    {
+      pool[i].queue = &queue;
+      pool[i].start ();
+    }
+
+
+  printf ("las_zero daemon listening on %s with %d workers, queue size %d\n", socket_path, workers, queue_size);
+  fflush (stdout);
+
+
+  while (!stop_daemon)
+    {
+      int32_t nfds = 0;
+
+
+      //  Pick up any requests that were left in the client buffers the last time the queue filled up.
+
+      for (int32_t i = 0 ; i < MAX_CLIENTS ; i++)
+        {
+          if (clients[i].fd >= 0 && memchr (clients[i].line, '\n', clients[i].line_len)) queue_requests (&queue, clients, i);
+        }
+
+
+      //  Back-pressure.  If the queue is still full we don't read any more requests (or accept connections) until a
+      //  worker takes something off of it (or we've sent the replies for the jobs that are done).
+
+      queue.mutex.lock ();
+      uint8_t full = queue_full (&queue);
+      queue.mutex.unlock ();
+
+
+      fds[nfds].fd = queue.wake[0];
+      fds[nfds].events = POLLIN;
+      poll_client[nfds++] = -1;
+
+      if (!full)
+        {
+          fds[nfds].fd = listen_fd;
+          fds[nfds].events = POLLIN;
+          poll_client[nfds++] = -1;
+
+          for (int32_t i = 0 ; i < MAX_CLIENTS ; i++)
+            {
+              if (clients[i].fd >= 0)
+                {
+                  fds[nfds].fd = clients[i].fd;
+                  fds[nfds].events = POLLIN;
+                  poll_client[nfds++] = i;
+                }
+            }
+        }
+
+
+      if (poll (fds, nfds, -1) < 0)
+        {
+          if (errno == EINTR) continue;
+
+          fprintf (stderr, "\nError on poll : %s\n\n", strerror (errno));
+          fflush (stderr);
+          break;
+        }
+
+
+      for (int32_t p = 0 ; p < nfds ; p++)
+        {
+          if (!fds[p].revents) continue;
+
+
+          //  Finished jobs.
+
+          if (fds[p].fd == queue.wake[0])
+            {
+              char junk[256];
+
+              if (read (queue.wake[0], junk, sizeof (junk)) < 0) {};
+
+              queue.mutex.lock ();
+
+              while (queue.done_count)
+                {
+                  DAEMON_JOB job = queue.done[queue.done_head];
+                  queue.done_head = (queue.done_head + 1) % queue.size;
+                  queue.done_count--;
+
+                  queue.mutex.unlock ();
+
+
+                  char reply[MAX_LINE + 256];
+
+                  if (job.status)
+                    {
+                      snprintf (reply, sizeof (reply), "ERROR %s %d %s\n", job.path, job.status, slas_zero_strerror (job.status));
+                    }
+                  else
+                    {
+                      snprintf (reply, sizeof (reply), "OK %s records=%" PRIu64 " withheld=%" PRIu64 " already=%" PRIu64 " seconds=%.3f\n", job.path,
+                                job.stats.records, job.stats.withheld, job.stats.already_withheld, job.stats.seconds);
+                    }
+
+                  fputs (reply, stdout);
+                  fflush (stdout);
+
+
+                  //  The client may have gone away (and its slot may have been reused) while the job was running.
+
+                  DAEMON_CLIENT *client = &clients[job.client];
+
+                  if (client->fd >= 0 && client->serial == job.serial && send_line (client->fd, reply)) drop_client (client);
+
+                  queue.mutex.lock ();
+                }
+
+              queue.mutex.unlock ();
+
+              continue;
+            }
+
+
+          //  New connection.
+
+          if (fds[p].fd == listen_fd)
+            {
+              int32_t fd = accept (listen_fd, NULL, NULL);
+
+              if (fd < 0) continue;
+
+              int32_t slot;
+              for (slot = 0 ; slot < MAX_CLIENTS && clients[slot].fd >= 0 ; slot++);
+
+              if (slot == MAX_CLIENTS)
+                {
+                  send_line (fd, "ERROR - -1 Too many connections\n");
+                  close (fd);
+                  continue;
+                }
+
+              struct timeval tv = {5, 0};
+              setsockopt (fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof (tv));
+
+              clients[slot].fd = fd;
+              clients[slot].serial = ++serial;
+              clients[slot].line_len = 0;
+
+              continue;
+            }
+
+
+          //  Request data from a client.
+
+          DAEMON_CLIENT *client = &clients[poll_client[p]];
+
+          if (client->fd != fds[p].fd) continue;
+
+          ssize_t got = recv (client->fd, &client->line[client->line_len], MAX_LINE - client->line_len, 0);
+
+          if (got <= 0)
+            {
+              drop_client (client);
+              continue;
+            }
+
+          client->line_len += got;
+
+          queue_requests (&queue, clients, poll_client[p]);
+        }
+    }
+
+
+  //  Shut down.  Jobs that are already running are allowed to finish (we don't want a half updated file).
+
+  queue.mutex.lock ();
+  queue.shutdown = NVTrue;
+  queue.work.wakeAll ();
+  queue.mutex.unlock ();
+
+  for (int32_t i = 0 ; i < workers ; i++) pool[i].wait ();
+
+  delete[] pool;
+
+  for (int32_t i = 0 ; i < MAX_CLIENTS ; i++) drop_client (&clients[i]);
+
+  close (listen_fd);
+  unlink (socket_path);
+  close (queue.wake[0]);
+  close (queue.wake[1]);
+  free (queue.pending);
+  free (queue.done);
+
+
+  printf ("las_zero daemon on %s shut down\n", socket_path);
+  fflush (stdout);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    las_zero_submit
+
+ - Purpose:     Small client for las_zero_daemon.  Sends a ZERO request for each file and
+                prints the replies as they come back.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - socket_path    =    Path of the daemon's Unix domain socket
+                - count          =    Number of files
+                - files          =    The file names (relative names are made absolute since
+                                      the daemon probably isn't running in our directory)
+
+ - Returns:     int32_t          =    0 if every job succeeded, -1 otherwise
+
+*********************************************************************************************/
+
+int32_t las_zero_submit (const char *socket_path, int32_t count, char **files)
+{
+  struct sockaddr_un  addr;
+  int32_t             fd, replies = 0, failed = 0, len = 0;
+  char                line[MAX_LINE + 256];
+
+
+  if (strlen (socket_path) >= sizeof (addr.sun_path)) return (-1);
+
+  if ((fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0) return (-1);
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, socket_path);
+
+  if (connect (fd, (struct sockaddr *) &addr, sizeof (addr)))
+    {
+      fprintf (stderr, "\nUnable to connect to %s : %s\n\n", socket_path, strerror (errno));
+      fflush (stderr);
+      close (fd);
+      return (-1);
+    }
+
+
+  //  Send everything up front.  If the daemon's queue is full it just won't read the rest until it has room.
+
+  for (int32_t i = 0 ; i < count ; i++)
+    {
+      char path[PATH_MAX], request[PATH_MAX + 8];
+
+      if (realpath (files[i], path) == NULL) strcpy (path, files[i]);
+
+      snprintf (request, sizeof (request), "ZERO %s\n", path);
+
+      if (send_line (fd, request))
+        {
+          fprintf (stderr, "\nError sending request to %s : %s\n\n", socket_path, strerror (errno));
+          fflush (stderr);
+          close (fd);
+          return (-1);
+        }
+    }
+
+
+  //  One reply line per request (in whatever order the jobs finish).
+
+  while (replies < count)
+    {
+      ssize_t got = recv (fd, &line[len], sizeof (line) - 1 - len, 0);
+
+      if (got <= 0) break;
+
+      len += got;
+      line[len] = 0;
+
+      char *start = line, *end;
+
+      while ((end = strchr (start, '\n')) != NULL)
+        {
+          *end = 0;
+
+          printf ("%s\n", start);
+          if (strncmp (start, "OK ", 3)) failed++;
+          replies++;
+
+          start = end + 1;
+        }
+
+      len -= (start - line);
+      memmove (line, start, len);
+    }
+
+  fflush (stdout);
+  close (fd);
+
+
+  if (replies < count)
+    {
+      fprintf (stderr, "\nOnly got %d of %d replies from %s\n\n", replies, count, socket_path);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  return (failed ? -1 : 0);
+}
+
+
+#endif
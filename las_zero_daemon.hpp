@@ -0,0 +1,55 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+#ifndef _LAS_ZERO_DAEMON_H_
+#define _LAS_ZERO_DAEMON_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "slas_zero.hpp"
+
+
+/*  Resident daemon mode.  The daemon listens on a Unix domain socket for lines of the form
+
+        ZERO /full/path/to/file.las
+
+    queues them (the queue is bounded, when it's full we stop reading from the clients until a worker frees a slot),
+    runs them on a pool of worker threads that live as long as the daemon does, and answers each job with one line,
+
+        OK /full/path/to/file.las records=N withheld=N already=N seconds=S
+        ERROR /full/path/to/file.las CODE message
+
+    in the order the jobs finish.  las_zero --submit is a small client for it.  */
+
+
+//!  Default number of jobs that can be waiting for a worker.
+
+#define LAS_ZERO_DAEMON_QUEUE           64
+
+
+int32_t las_zero_daemon (const char *socket_path, int32_t workers, int32_t queue_size, SLAS_ZERO_OPTIONS *options);
+int32_t las_zero_submit (const char *socket_path, int32_t count, char **files);
+
+
+#endif
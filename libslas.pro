@@ -0,0 +1,22 @@
+contains(QT_CONFIG, opengl): QT += opengl
+QT += 
+INCLUDEPATH += /c/PFM_ABEv7.0.0_Win64/include
+LIBS += -L /c/PFM_ABEv7.0.0_Win64/lib -lnvutility -llas -lwsock32 -lm
+DEFINES += WIN32 NVWIN3X UINT32_C INT32_C
+CONFIG += console
+CONFIG += exceptions
+QMAKE_CXXFLAGS += -fno-strict-aliasing
+QMAKE_LFLAGS += 
+######################################################################
+# libslas - slas reader/updater and the las_zero pass as a static library
+######################################################################
+
+TEMPLATE = lib
+TARGET = slas
+CONFIG += staticlib
+DEPENDPATH += .
+INCLUDEPATH += .
+
+# Input
+HEADERS += slas.hpp slas_clone.hpp slas_copc.hpp slas_grid.hpp slas_index.hpp slas_laz.hpp slas_manifest.hpp slas_memory.hpp slas_numa.hpp slas_perf.hpp slas_prefetch.hpp slas_qa.hpp slas_shard.hpp slas_sort.hpp slas_throttle.hpp slas_verify.hpp slas_zero.hpp
+SOURCES += slas.cpp slas_clone.cpp slas_copc.cpp slas_grid.cpp slas_index.cpp slas_laz.cpp slas_manifest.cpp slas_memory.cpp slas_numa.cpp slas_perf.cpp slas_prefetch.cpp slas_qa.cpp slas_shard.cpp slas_sort.cpp slas_throttle.cpp slas_verify.cpp slas_zero.cpp
@@ -42,91 +42,47 @@
 
 #include <QtCore>
 
+#ifndef NVWIN3X
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 /********************************************************************************************/
 /*!
 
- - Function:    slas_read_point_data
+ - Function:    slas_decode_point_data
 
- - Purpose:     Retrieve a LAS point data record.
+ - Purpose:     Unpack the fixed (format defined) part of a raw LAS point data record.  This is
+                the guts of slas_read_point_data pulled out so that blocks of records read with
+                slas_ctx_read_records can be decoded in memory.
 
  - Author:      Jan C. Depner (area.based.editor@gmail.com)
 
  - Date:        03/20/15
 
  - Arguments:
-                - fp             =    The file pointer
-                - recnum         =    The record number of the LAS point data record to be
-                                      retrieved (records start at 0)
-                - lasheader      =    The LASheader retrieved from the LAS file
-                - swap           =    Flag that indicates that the system is big endian and
-                                      therefor we need to byte swap the records
+                - ctx            =    The SLAS_CONTEXT for the file
+                - data           =    The raw record (at least ctx->fixed_length bytes)
                 - record         =    The returned Simple LAS point data record
 
- - Returns:     int32_t          =    Negative number on error, 0 on success
+ - Returns:     void
 
 *********************************************************************************************/
 
-int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record)
+void slas_decode_point_data (SLAS_CONTEXT *ctx, const uint8_t *data, SLAS_POINT_DATA *record)
 {
   int32_t  x, y, z;
-  int64_t  addr, pos;
-  uint8_t  data[128], rets, cls;
-
-
-  //  Check for record out of bounds.
-
-  if (lasheader->version_minor < 4)
-    {
-      if (recnum >= (uint64_t) lasheader->number_of_point_records)
-        {
-#ifdef _WIN32
-          fprintf (stderr, "Record number %I64d out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#else
-          fprintf (stderr, "Record number %ld out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#endif
-          fflush (stderr);
-          return (-1);
-        }
-    }
-  else
-    {
-      if (recnum >= lasheader->extended_number_of_point_records)
-        {
-#ifdef _WIN32
-          fprintf (stderr, "Record number %I64d out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#else
-          fprintf (stderr, "Record number %ld out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#endif
-          fflush (stderr);
-          return (-1);
-        }
-    }
-
-
-  addr = (int64_t) lasheader->offset_to_point_data + (int64_t) lasheader->point_data_record_length * (int64_t) recnum;
-
-
-  if (fseeko64 (fp, addr, SEEK_SET) < 0)
-    {
-      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
-      fflush (stderr);
-      return (-2);
-    }
+  int64_t  pos;
+  uint8_t  rets, cls;
 
 
   memset (record, 0, sizeof (SLAS_POINT_DATA));
-  memset (data, 0, 128);
-
-
-  //  Read the data buffer.
-
-  if (!fread (data, lasheader->point_data_record_length, 1, fp))
-    {
-      fprintf (stderr, "Error reading LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
-      fflush (stderr);
-      return (-3);
-    }
 
 
   //  Get the data out of the buffer.
@@ -142,7 +98,7 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
 
   //  Check for point format ID above 5.
 
-  if (lasheader->point_data_format > 5)
+  if (ctx->point_data_format > 5)
     {
       memcpy (&record->classification, &data[pos], 1); pos += 1;
       memcpy (&record->user_data, &data[pos], 1); pos += 1;
@@ -157,7 +113,7 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
   memcpy (&record->point_source_id, &data[pos], 2); pos += 2;
 
 
-  switch (lasheader->point_data_format)
+  switch (ctx->point_data_format)
     {
     case 1:
     case 6:
@@ -231,7 +187,7 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
 
   //  If we have to swap the fields of the record, do so.
 
-  if (swap)
+  if (ctx->swap)
     {
       swap_int (&x);
       swap_int (&y);
@@ -239,7 +195,7 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
       swap_short ((int16_t *) &record->intensity);
       swap_short ((int16_t *) &record->point_source_id);
 
-      switch (lasheader->point_data_format)
+      switch (ctx->point_data_format)
         {
         case 1:
         case 6:
@@ -311,14 +267,14 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
 
   //  Now put the rest of the data into the structure.
 
-  record->x = ((double) x * lasheader->x_scale_factor) + lasheader->x_offset;
-  record->y = ((double) y * lasheader->y_scale_factor) + lasheader->y_offset;
-  record->z = (float) (((double) z * lasheader->z_scale_factor) + lasheader->z_offset);
+  record->x = ((double) x * ctx->x_scale_factor) + ctx->x_offset;
+  record->y = ((double) y * ctx->y_scale_factor) + ctx->y_offset;
+  record->z = (float) (((double) z * ctx->z_scale_factor) + ctx->z_offset);
 
 
   //  Check for point format ID above 5.
 
-  if (lasheader->point_data_format > 5)
+  if (ctx->point_data_format > 5)
     {
       record->return_number = rets & 0x0f;
       record->number_of_returns = (rets & 0xf0) >> 4;
@@ -327,13 +283,13 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
       record->edge_of_flightline = (cls & 0x80) >> 7;
 
 
-      //  Just to make life easier we're breaking out the 4 bits of the classification flags.
+      //  Just to make life easier we're breaking out the 4 bits of the classification flags (same bits that
+      //  slas_update_point_data sets).
 
-      uint8_t new_cls = cls & 0x0f;
-      record->overlap = (new_cls & 0x10) >> 4;
-      record->synthetic = (new_cls & 0x20) >> 5;
-      record->keypoint = (new_cls & 0x40) >> 6;
-      record->withheld = (new_cls & 0x80) >> 7;
+      record->synthetic = cls & 0x01;
+      record->keypoint = (cls & 0x02) >> 1;
+      record->withheld = (cls & 0x04) >> 2;
+      record->overlap = (cls & 0x08) >> 3;
     }
   else
     {
@@ -353,7 +309,6 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
     }
 
 
-  return (0);
 }
 
 
@@ -361,9 +316,9 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
 /********************************************************************************************/
 /*!
 
- - Function:    slas_read_waveform_data
+ - Function:    slas_read_point_data
 
- - Purpose:     Retrieve a LAS waveform record.
+ - Purpose:     Retrieve a LAS point data record.
 
  - Author:      Jan C. Depner (area.based.editor@gmail.com)
 
@@ -371,62 +326,62 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
 
  - Arguments:
                 - fp             =    The file pointer
+                - recnum         =    The record number of the LAS point data record to be
+                                      retrieved (records start at 0)
                 - lasheader      =    The LASheader retrieved from the LAS file
-                - record         =    The Simple LAS point data record for which waveform data
-                                      is to be retrieved
-                - wf_packet_desc =    The array of 255 possible waveform packet descriptor
-                                      records
-                - wave           =    wf_packet_desc[record->wavepacket_descriptor_index].number_of_samples
-                                      sized array of uint32_t variables (this is where we stuff the
-                                      waveform data)
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - record         =    The returned Simple LAS point data record
 
  - Returns:     int32_t          =    Negative number on error, 0 on success
 
+ - Caveats:     This moves the file pointer.  If you need to read from more than one thread use
+                slas_init_context and slas_ctx_read_point_data.
+
 *********************************************************************************************/
 
-int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave)
+int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record)
 {
-  int64_t  addr, pos;
-  uint8_t  *wave_data;
+  SLAS_CONTEXT  ctx;
+  int64_t       addr;
+  uint8_t       data[SLAS_MAX_FIXED_RECORD_LENGTH];
 
 
-  addr = lasheader->start_of_waveform_data_packet_record + record->byte_offset_to_waveform_data;
+  if (slas_init_context (&ctx, -1, lasheader, swap)) return (-1);
 
 
-  if (fseeko64 (fp, addr, SEEK_SET) < 0)
+  //  Check for record out of bounds.
+
+  if (recnum >= ctx.number_of_points)
     {
-      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno), __FUNCTION__, __LINE__);
+      fprintf (stderr, "Record number %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
       fflush (stderr);
       return (-1);
     }
 
 
-  wave_data = (uint8_t *) malloc (record->waveform_packet_size);
-
+  addr = ctx.offset_to_point_data + (int64_t) ctx.record_length * (int64_t) recnum;
 
-  //  Read the wave_data buffer.
 
-  if (!fread (wave_data, record->waveform_packet_size, 1, fp))
+  if (fseeko64 (fp, addr, SEEK_SET) < 0)
     {
-      fprintf (stderr, "Error reading LAS waveform data :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
       fflush (stderr);
-      free (wave_data);
       return (-2);
     }
 
 
-  int32_t ndx = record->wavepacket_descriptor_index;
-  int32_t count = wf_packet_desc[ndx].number_of_samples;
-  int32_t size = wf_packet_desc[ndx].bits_per_sample;
+  //  Read the data buffer.  We only read the fixed part of the record (anything past that is extra bytes).
 
-  pos = 0;
-  for (int32_t i = 0 ; i < count ; i++)
+  if (!fread (data, ctx.fixed_length, 1, fp))
     {
-      wave[i] = bit_unpack (wave_data, pos, size); pos += size;
+      fprintf (stderr, "Error reading LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
     }
 
 
-  free (wave_data);
+  slas_decode_point_data (&ctx, data, record);
 
 
   return (0);
@@ -437,10 +392,9 @@ int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA
 /********************************************************************************************/
 /*!
 
- - Function:    slas_update_point_data
+ - Function:    slas_read_waveform_data
 
- - Purpose:     Updates the user modifiable fields of a LAS point data record without affecting
-                the "non-modifiable" fields.
+ - Purpose:     Retrieve a LAS waveform record.
 
  - Author:      Jan C. Depner (area.based.editor@gmail.com)
 
@@ -448,324 +402,2409 @@ int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA
 
  - Arguments:
                 - fp             =    The file pointer
-                - recnum         =    The record number of the LAS point data record to be written
-		                      (records start at 0)
                 - lasheader      =    The LASheader retrieved from the LAS file
-                - swap           =    Flag that indicates that the system is big endian and
-                                      therefor we need to byte swap the records
-                - record         =    The SLAS_POINT_DATA structure to be updated
+                - record         =    The Simple LAS point data record for which waveform data
+                                      is to be retrieved
+                - wf_packet_desc =    The array of 255 possible waveform packet descriptor
+                                      records
+                - wave           =    wf_packet_desc[record->wavepacket_descriptor_index].number_of_samples
+                                      sized array of uint32_t variables (this is where we stuff the
+                                      waveform data)
 
  - Returns:     int32_t          =    Negative number on error, 0 on success
 
+ - Caveats:     This allocates and frees a packet buffer on every call.  If you are walking a lot
+                of waveforms use slas_read_waveform_data_buf with a buffer that you keep around.
+
 *********************************************************************************************/
 
-int32_t slas_update_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record)
+int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave)
 {
-  int32_t   pos;
-  uint8_t   data[128], cls;
-  int64_t   addr;
+  SLAS_WAVEFORM_BUFFER buffer;
+  int32_t              status;
 
 
-  //  Check for record out of bounds.
+  slas_init_waveform_buffer (&buffer);
 
-  if (lasheader->version_minor < 4)
-    {
-      if (recnum >= (uint64_t) lasheader->number_of_point_records)
-        {
-#ifdef _WIN32
-          fprintf (stderr, "Record number %I64d out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#else
-          fprintf (stderr, "Record number %ld out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#endif
-          fflush (stderr);
-          return (-1);
-        }
-    }
-  else
-    {
-      if (recnum >= lasheader->extended_number_of_point_records)
-        {
-#ifdef _WIN32
-          fprintf (stderr, "Record number %I64d out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#else
-          fprintf (stderr, "Record number %ld out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#endif
-          fflush (stderr);
-          return (-1);
-        }
-    }
+  status = slas_read_waveform_data_buf (fp, lasheader, record, wf_packet_desc, wave, &buffer);
 
+  slas_free_waveform_buffer (&buffer);
 
-  //  Move to the beginning of the requested record in the file.
 
-  addr = (int64_t) lasheader->offset_to_point_data + (int64_t) lasheader->point_data_record_length * (int64_t) recnum;
+  return (status);
+}
 
 
-  if (fseeko64 (fp, addr, SEEK_SET) < 0)
-    {
-      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
-      fflush (stderr);
-      return (-2);
-    }
 
+/********************************************************************************************/
+/*!
 
-  memset (data, 0, 128);
+ - Function:    slas_init_waveform_buffer
 
+ - Purpose:     Initialize a caller owned waveform packet buffer.
 
-  //  Read the data buffer.
+ - Author:      PFM Software
 
-  if (!fread (data, lasheader->point_data_record_length, 1, fp))
-    {
-      fprintf (stderr, "Error reading LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
-      fflush (stderr);
-      return (-3);
-    }
+ - Date:        10/18/26
 
+ - Arguments:
+                - buffer         =    The SLAS_WAVEFORM_BUFFER to be initialized
 
-  //  Extract only the "modifiable" fields.
+ - Returns:     void
 
-  pos = 0;
+*********************************************************************************************/
 
-  pos += 4;   //  X
-  pos += 4;   //  Y
-  pos += 4;   //  Z
-  pos += 2;   //  Intensity
-  pos += 1;   //  Formats 0 through 5 = Return Number, Number of Returns, Scan Direction Flag, Edge of Flightline
-              //  Formats 6 through 10 = Return Number, Number of Returns
+void slas_init_waveform_buffer (SLAS_WAVEFORM_BUFFER *buffer)
+{
+  buffer->data = NULL;
+  buffer->size = 0;
+}
 
 
-  //  We need to modify this byte in different ways for formats above and below 5.  For 6 through 10 we have to preserve
-  //  the Scanner Channel, Scan Direction Flag, and the Edge of Flightline.  For 0 through 5 we will be replacing the
-  //  classification part of the classification flags as well as the bit fields.
 
-  memcpy (&cls, &data[pos], 1);
+/********************************************************************************************/
+/*!
 
+ - Function:    slas_free_waveform_buffer
 
-  //  Check for point format ID above 5.
+ - Purpose:     Release the memory held by a caller owned waveform packet buffer.
 
-  if (lasheader->point_data_format > 5)
-    {
-      //  Set the "synthetic" bit.
+ - Author:      PFM Software
 
-      if (record->synthetic)
-        {
-          cls |= 0x01;
-        }
-      else
-        {
-          cls &= 0xfe;
-        }
+ - Date:        10/18/26
 
+ - Arguments:
+                - buffer         =    The SLAS_WAVEFORM_BUFFER to be freed
 
-      //  Set the "keypoint" bit.
+ - Returns:     void
 
-      if (record->keypoint)
-        {
-          cls |= 0x02;
-        }
-      else
-        {
-          cls &= 0xfd;
-        }
+*********************************************************************************************/
 
+void slas_free_waveform_buffer (SLAS_WAVEFORM_BUFFER *buffer)
+{
+  if (buffer->data) free (buffer->data);
 
-      //  Set the "withheld" bit.
+  buffer->data = NULL;
+  buffer->size = 0;
+}
 
-      if (record->withheld)
-        {
-          cls |= 0x04;
-        }
-      else
-        {
-          cls &= 0xfb;
-        }
 
 
-      //  Set the "overlap" bit.
+/********************************************************************************************/
+/*!
 
-      if (record->overlap)
-        {
-          cls |= 0x08;
-        }
-      else
-        {
-          cls &= 0xf7;
-        }
-    }
-  else
-    {
-      //  Set the classification value first and then add in the bit fields.
+ - Function:    slas_read_waveform_data_buf
 
-      if (record->classification > 31)
-        {
-          fprintf (stderr, "Classification value %d out of bounds :\nFunction: %s, Line: %d\n", record->classification,  __FUNCTION__, __LINE__);
-          fflush (stderr);
-          return (-4);
-        }
-      cls = record->classification;
+ - Purpose:     Retrieve a LAS waveform record using a caller owned packet buffer.  The buffer
+                is only reallocated when a packet is larger than anything we've seen so far.
 
+ - Author:      PFM Software
 
-      //  Set the "synthetic" bit.
+ - Date:        10/18/26
 
-      if (record->synthetic)
-        {
-          cls |= 0x20;
-        }
-      else
-        {
-          cls &= 0xdf;
-        }
+ - Arguments:
+                - fp             =    The file pointer
+                - lasheader      =    The LASheader retrieved from the LAS file
+                - record         =    The Simple LAS point data record for which waveform data
+                                      is to be retrieved
+                - wf_packet_desc =    The array of 255 possible waveform packet descriptor
+                                      records
+                - wave           =    wf_packet_desc[record->wavepacket_descriptor_index].number_of_samples
+                                      sized array of uint32_t variables
+                - buffer         =    SLAS_WAVEFORM_BUFFER initialized with slas_init_waveform_buffer
 
+ - Returns:     int32_t          =    Negative number on error, 0 on success
 
-      //  Set the "key point" bit.
+*********************************************************************************************/
 
-      if (record->keypoint)
-        {
-          cls |= 0x40;
-        }
-      else
-        {
-          cls &= 0xbf;
-        }
+int32_t slas_read_waveform_data_buf (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc,
+                                     uint32_t *wave, SLAS_WAVEFORM_BUFFER *buffer)
+{
+  int64_t  addr;
 
 
-      //  Set the "withheld" bit.
+  addr = lasheader->start_of_waveform_data_packet_record + record->byte_offset_to_waveform_data;
 
-      if (record->withheld)
-        {
-          cls |= 0x80;
-        }
-      else
-        {
+
+  if (fseeko64 (fp, addr, SEEK_SET) < 0)
+    {
+      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno), __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  //  Only grow the buffer, never shrink it.
+
+  if (record->waveform_packet_size > buffer->size)
+    {
+      uint8_t *new_data = (uint8_t *) realloc (buffer->data, record->waveform_packet_size);
+
+      if (new_data == NULL)
+        {
+          fprintf (stderr, "Error allocating waveform buffer :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-3);
+        }
+
+      buffer->data = new_data;
+      buffer->size = record->waveform_packet_size;
+    }
+
+
+  //  Read the wave_data buffer.
+
+  if (!fread (buffer->data, record->waveform_packet_size, 1, fp))
+    {
+      fprintf (stderr, "Error reading LAS waveform data :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+
+  return (slas_unpack_waveform (buffer->data, record->waveform_packet_size, &wf_packet_desc[record->wavepacket_descriptor_index], wave));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_open_waveform_map
+
+ - Purpose:     Map the waveform data packets read-only.  If bit 2 of the global encoding is
+                set the packets live in an external .wdp file with the same base name as the
+                LAS file, otherwise they're in the waveform data packet record of the LAS file.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - las_path       =    The LAS file name
+                - lasheader      =    The LASheader retrieved from the LAS file
+                - wf_map         =    The SLAS_WAVEFORM_MAP to be filled in
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+ - Caveats:     byte_offset_to_waveform_data is relative to the start of the waveform data
+                packet record for internal packets and to the start of the .wdp file for
+                external packets (the .wdp file starts with a copy of the EVLR header).
+
+*********************************************************************************************/
+
+int32_t slas_open_waveform_map (const char *las_path, LASheader *lasheader, SLAS_WAVEFORM_MAP *wf_map)
+{
+  char      path[1024];
+  uint64_t  start, aligned, file_size, page;
+
+
+  memset (wf_map, 0, sizeof (SLAS_WAVEFORM_MAP));
+
+
+  switch (lasheader->point_data_format)
+    {
+    case 4:
+    case 5:
+    case 9:
+    case 10:
+      break;
+
+    default:
+      fprintf (stderr, "Point data format %d has no waveform data :\nFunction: %s, Line: %d\n", lasheader->point_data_format, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  if (strlen (las_path) >= sizeof (path) - 4)
+    {
+      fprintf (stderr, "File name %s too long :\nFunction: %s, Line: %d\n", las_path, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+  strcpy (path, las_path);
+
+
+  //  External waveform data packets.
+
+  if (lasheader->global_encoding & 0x0004)
+    {
+      char *ext = strrchr (path, '.');
+      char *sep = strrchr (path, '/');
+#ifdef NVWIN3X
+      if (strrchr (path, '\\') > sep) sep = strrchr (path, '\\');
+#endif
+
+      if (ext == NULL || (sep != NULL && ext < sep)) ext = &path[strlen (path)];
+
+
+      //  Try lower case first, then upper case.
+
+      strcpy (ext, ".wdp");
+      if (access (path, R_OK))
+        {
+          strcpy (ext, ".WDP");
+          if (access (path, R_OK)) strcpy (ext, ".wdp");
+        }
+
+      start = 0;
+      wf_map->external = NVTrue;
+    }
+  else
+    {
+      start = lasheader->start_of_waveform_data_packet_record;
+    }
+
+
+#ifdef NVWIN3X
+
+  SYSTEM_INFO    sys_info;
+  LARGE_INTEGER  size;
+
+  GetSystemInfo (&sys_info);
+  page = sys_info.dwAllocationGranularity;
+
+  wf_map->file = CreateFileA (path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (wf_map->file == INVALID_HANDLE_VALUE)
+    {
+      fprintf (stderr, "Error opening waveform file %s :\nFunction: %s, Line: %d\n", path, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+  GetFileSizeEx (wf_map->file, &size);
+  file_size = size.QuadPart;
+
+#else
+
+  struct stat64  st;
+  int32_t        fd;
+
+  page = sysconf (_SC_PAGESIZE);
+
+  if ((fd = open (path, O_RDONLY)) < 0)
+    {
+      fprintf (stderr, "Error opening waveform file %s :\n%s\nFunction: %s, Line: %d\n", path, strerror (errno), __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+  fstat64 (fd, &st);
+  file_size = st.st_size;
+
+#endif
+
+
+  if (start >= file_size)
+    {
+      fprintf (stderr, "Waveform data packet start %" PRIu64 " past end of %s :\nFunction: %s, Line: %d\n", start, path, __FUNCTION__, __LINE__);
+      fflush (stderr);
+#ifdef NVWIN3X
+      CloseHandle (wf_map->file);
+#else
+      close (fd);
+#endif
+      return (-3);
+    }
+
+
+  //  The mapping offset has to be page aligned so we back up to the nearest page boundary.
+
+  aligned = start - start % page;
+  wf_map->map_size = file_size - aligned;
+
+
+#ifdef NVWIN3X
+
+  wf_map->mapping = CreateFileMappingA (wf_map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (wf_map->mapping != NULL)
+    wf_map->map = (uint8_t *) MapViewOfFile (wf_map->mapping, FILE_MAP_READ, (DWORD) (aligned >> 32), (DWORD) (aligned & 0xffffffff),
+                                             (SIZE_T) wf_map->map_size);
+
+  if (wf_map->map == NULL)
+    {
+      fprintf (stderr, "Error mapping waveform file %s :\nFunction: %s, Line: %d\n", path, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      if (wf_map->mapping != NULL) CloseHandle (wf_map->mapping);
+      CloseHandle (wf_map->file);
+      return (-4);
+    }
+
+#else
+
+  void *map = mmap64 (NULL, wf_map->map_size, PROT_READ, MAP_SHARED, fd, aligned);
+
+
+  //  The mapping holds its own reference to the file so we don't need the descriptor anymore.
+
+  close (fd);
+
+  if (map == MAP_FAILED)
+    {
+      fprintf (stderr, "Error mapping waveform file %s :\n%s\nFunction: %s, Line: %d\n", path, strerror (errno), __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-4);
+    }
+
+  wf_map->map = (uint8_t *) map;
+
+#endif
+
+
+  wf_map->packets = wf_map->map + (start - aligned);
+  wf_map->packets_size = file_size - start;
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_close_waveform_map
+
+ - Purpose:     Unmap the waveform data packets.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - wf_map         =    The SLAS_WAVEFORM_MAP opened with slas_open_waveform_map
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_close_waveform_map (SLAS_WAVEFORM_MAP *wf_map)
+{
+  if (wf_map->map == NULL) return;
+
+#ifdef NVWIN3X
+  UnmapViewOfFile (wf_map->map);
+  CloseHandle (wf_map->mapping);
+  CloseHandle (wf_map->file);
+#else
+  munmap (wf_map->map, wf_map->map_size);
+#endif
+
+  memset (wf_map, 0, sizeof (SLAS_WAVEFORM_MAP));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_waveform_packet
+
+ - Purpose:     Zero copy access to the raw waveform packet for a point.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - wf_map         =    The SLAS_WAVEFORM_MAP opened with slas_open_waveform_map
+                - record         =    The Simple LAS point data record for which the waveform
+                                      packet is wanted
+
+ - Returns:     const uint8_t *  =    Pointer to record->waveform_packet_size bytes of packet
+                                      data or NULL if the packet is outside of the mapping
+
+*********************************************************************************************/
+
+const uint8_t *slas_waveform_packet (SLAS_WAVEFORM_MAP *wf_map, SLAS_POINT_DATA *record)
+{
+  if (record->byte_offset_to_waveform_data > wf_map->packets_size ||
+      (uint64_t) record->waveform_packet_size > wf_map->packets_size - record->byte_offset_to_waveform_data)
+    {
+      fprintf (stderr, "Waveform packet at %" PRIu64 " (%u bytes) out of range :\nFunction: %s, Line: %d\n", record->byte_offset_to_waveform_data,
+               record->waveform_packet_size, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (NULL);
+    }
+
+  return (wf_map->packets + record->byte_offset_to_waveform_data);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_read_waveform_data_map
+
+ - Purpose:     Retrieve a LAS waveform record from a waveform map.  This is safe to call from
+                multiple threads on the same SLAS_WAVEFORM_MAP.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - wf_map         =    The SLAS_WAVEFORM_MAP opened with slas_open_waveform_map
+                - record         =    The Simple LAS point data record for which waveform data
+                                      is to be retrieved
+                - wf_packet_desc =    The array of 255 possible waveform packet descriptor
+                                      records
+                - wave           =    wf_packet_desc[record->wavepacket_descriptor_index].number_of_samples
+                                      sized array of uint32_t variables
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_read_waveform_data_map (SLAS_WAVEFORM_MAP *wf_map, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave)
+{
+  const uint8_t *packet = slas_waveform_packet (wf_map, record);
+
+  if (packet == NULL) return (-1);
+
+  return (slas_unpack_waveform (packet, record->waveform_packet_size, &wf_packet_desc[record->wavepacket_descriptor_index], wave));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_init_waveform_cache
+
+ - Purpose:     Initialize an LRU cache of unpacked waveforms.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - cache          =    The SLAS_WAVEFORM_CACHE to be initialized
+                - capacity       =    Maximum number of waveforms to keep.  A handful is plenty
+                                      for a sequential walk since the returns from one pulse
+                                      are normally adjacent.
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_init_waveform_cache (SLAS_WAVEFORM_CACHE *cache, int32_t capacity)
+{
+  int32_t  buckets;
+
+
+  memset (cache, 0, sizeof (SLAS_WAVEFORM_CACHE));
+
+  if (capacity < 1) capacity = 1;
+
+
+  //  Power of two number of hash buckets, at least twice the capacity.
+
+  for (buckets = 2 ; buckets < capacity * 2 ; buckets <<= 1);
+
+
+  cache->entries = (SLAS_WAVEFORM_CACHE_ENTRY *) calloc (capacity, sizeof (SLAS_WAVEFORM_CACHE_ENTRY));
+  cache->buckets = (int32_t *) malloc (buckets * sizeof (int32_t));
+
+  if (cache->entries == NULL || cache->buckets == NULL)
+    {
+      fprintf (stderr, "Error allocating waveform cache :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      slas_free_waveform_cache (cache);
+      return (-1);
+    }
+
+  for (int32_t i = 0 ; i < buckets ; i++) cache->buckets[i] = -1;
+
+  cache->bucket_mask = buckets - 1;
+  cache->capacity = capacity;
+  cache->head = cache->tail = -1;
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_free_waveform_cache
+
+ - Purpose:     Release the memory held by a waveform cache.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - cache          =    The SLAS_WAVEFORM_CACHE to be freed
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_free_waveform_cache (SLAS_WAVEFORM_CACHE *cache)
+{
+  if (cache->entries)
+    {
+      for (int32_t i = 0 ; i < cache->capacity ; i++)
+        {
+          if (cache->entries[i].wave) free (cache->entries[i].wave);
+        }
+
+      free (cache->entries);
+    }
+
+  if (cache->buckets) free (cache->buckets);
+
+  memset (cache, 0, sizeof (SLAS_WAVEFORM_CACHE));
+}
+
+
+
+static int32_t cache_bucket (SLAS_WAVEFORM_CACHE *cache, uint64_t offset, int32_t index)
+{
+  uint64_t key = (offset * 0x9e3779b97f4a7c15ULL) ^ (uint64_t) index;
+
+  return ((int32_t) ((key ^ (key >> 29)) & (uint64_t) cache->bucket_mask));
+}
+
+
+static void cache_unlink (SLAS_WAVEFORM_CACHE *cache, int32_t slot)
+{
+  SLAS_WAVEFORM_CACHE_ENTRY *entry = &cache->entries[slot];
+
+  if (entry->prev >= 0)
+    {
+      cache->entries[entry->prev].next = entry->next;
+    }
+  else
+    {
+      cache->head = entry->next;
+    }
+
+  if (entry->next >= 0)
+    {
+      cache->entries[entry->next].prev = entry->prev;
+    }
+  else
+    {
+      cache->tail = entry->prev;
+    }
+}
+
+
+static void cache_push_front (SLAS_WAVEFORM_CACHE *cache, int32_t slot)
+{
+  cache->entries[slot].prev = -1;
+  cache->entries[slot].next = cache->head;
+
+  if (cache->head >= 0) cache->entries[cache->head].prev = slot;
+  cache->head = slot;
+
+  if (cache->tail < 0) cache->tail = slot;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_read_waveform_data_cached
+
+ - Purpose:     Retrieve the unpacked waveform for a point, going to the waveform map only if
+                the packet (descriptor index and byte offset) isn't already in the cache.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - cache          =    The SLAS_WAVEFORM_CACHE
+                - wf_map         =    The SLAS_WAVEFORM_MAP opened with slas_open_waveform_map
+                - record         =    The Simple LAS point data record for which waveform data
+                                      is to be retrieved
+                - wf_packet_desc =    The array of 255 possible waveform packet descriptor
+                                      records
+
+ - Returns:     const uint32_t * =    wf_packet_desc[record->wavepacket_descriptor_index].number_of_samples
+                                      unpacked samples or NULL on error.  This belongs to the
+                                      cache and is only good until the next call.
+
+*********************************************************************************************/
+
+const uint32_t *slas_read_waveform_data_cached (SLAS_WAVEFORM_CACHE *cache, SLAS_WAVEFORM_MAP *wf_map, SLAS_POINT_DATA *record,
+                                                SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc)
+{
+  SLAS_WAVEFORM_CACHE_ENTRY  *entry;
+  int32_t                    slot, bucket, *link;
+
+
+  int32_t index = record->wavepacket_descriptor_index;
+  uint64_t offset = record->byte_offset_to_waveform_data;
+  uint32_t count = wf_packet_desc[index].number_of_samples;
+
+  bucket = cache_bucket (cache, offset, index);
+
+
+  //  Look it up.
+
+  for (slot = cache->buckets[bucket] ; slot >= 0 ; slot = cache->entries[slot].chain)
+    {
+      entry = &cache->entries[slot];
+
+      if (entry->offset == offset && entry->index == index && entry->count == count)
+        {
+          cache->hits++;
+
+          if (cache->head != slot)
+            {
+              cache_unlink (cache, slot);
+              cache_push_front (cache, slot);
+            }
+
+          return (entry->wave);
+        }
+    }
+
+  cache->misses++;
+
+
+  //  Not there.  Use a free slot if we have one, otherwise recycle the least recently used one.
+
+  if (cache->used < cache->capacity)
+    {
+      slot = cache->used++;
+    }
+  else
+    {
+      slot = cache->tail;
+      entry = &cache->entries[slot];
+
+      cache_unlink (cache, slot);
+
+
+      //  Take it out of its hash chain (slots left over from a failed read were never hashed).
+
+      if (entry->index >= 0)
+        {
+          for (link = &cache->buckets[cache_bucket (cache, entry->offset, entry->index)] ; *link != slot ; link = &cache->entries[*link].chain);
+          *link = entry->chain;
+        }
+    }
+
+  entry = &cache->entries[slot];
+
+  if (count > entry->wave_size)
+    {
+      uint32_t *new_wave = (uint32_t *) realloc (entry->wave, count * sizeof (uint32_t));
+
+      if (new_wave == NULL)
+        {
+          fprintf (stderr, "Error allocating waveform cache entry :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+          fflush (stderr);
+          entry->count = 0;
+          entry->offset = 0;
+          entry->index = -1;
+          entry->chain = -1;
+          cache_push_front (cache, slot);
+          return (NULL);
+        }
+
+      entry->wave = new_wave;
+      entry->wave_size = count;
+    }
+
+
+  //  Don't cache failures.  We leave the slot unhashed (index -1 can never match) at the front of the list.
+
+  if (slas_read_waveform_data_map (wf_map, record, wf_packet_desc, entry->wave))
+    {
+      entry->count = 0;
+      entry->offset = 0;
+      entry->index = -1;
+      entry->chain = -1;
+      cache_push_front (cache, slot);
+      return (NULL);
+    }
+
+  entry->offset = offset;
+  entry->index = index;
+  entry->count = count;
+  entry->chain = cache->buckets[bucket];
+  cache->buckets[bucket] = slot;
+
+  cache_push_front (cache, slot);
+
+
+  return (entry->wave);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_waveform_cache_hit_rate
+
+ - Purpose:     Fraction of slas_read_waveform_data_cached calls that were satisfied from the
+                cache.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - cache          =    The SLAS_WAVEFORM_CACHE
+
+ - Returns:     double           =    Hit rate (0.0 to 1.0)
+
+*********************************************************************************************/
+
+double slas_waveform_cache_hit_rate (SLAS_WAVEFORM_CACHE *cache)
+{
+  uint64_t total = cache->hits + cache->misses;
+
+  if (!total) return (0.0);
+
+  return ((double) cache->hits / (double) total);
+}
+
+
+
+//  Byte aligned unpack kernels.  bit_unpack reads the most significant bit first so a 16 or 32 bit sample comes out
+//  of it as if it were stored big endian.  These produce exactly the same values, they just do it a whole sample (or,
+//  with SSE2, 16 bytes) at a time.
+
+static void unpack_8 (const uint8_t *src, uint32_t *wave, int32_t count)
+{
+  int32_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128 ();
+
+  for ( ; i + 16 <= count ; i += 16)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) &src[i]);
+      __m128i lo = _mm_unpacklo_epi8 (v, zero);
+      __m128i hi = _mm_unpackhi_epi8 (v, zero);
+
+      _mm_storeu_si128 ((__m128i *) &wave[i], _mm_unpacklo_epi16 (lo, zero));
+      _mm_storeu_si128 ((__m128i *) &wave[i + 4], _mm_unpackhi_epi16 (lo, zero));
+      _mm_storeu_si128 ((__m128i *) &wave[i + 8], _mm_unpacklo_epi16 (hi, zero));
+      _mm_storeu_si128 ((__m128i *) &wave[i + 12], _mm_unpackhi_epi16 (hi, zero));
+    }
+#endif
+
+  for ( ; i < count ; i++) wave[i] = src[i];
+}
+
+
+static void unpack_16 (const uint8_t *src, uint32_t *wave, int32_t count)
+{
+  int32_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128 ();
+
+  for ( ; i + 8 <= count ; i += 8)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) &src[i * 2]);
+
+
+      //  Swap the bytes in each 16 bit lane then zero extend to 32 bits.
+
+      v = _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+
+      _mm_storeu_si128 ((__m128i *) &wave[i], _mm_unpacklo_epi16 (v, zero));
+      _mm_storeu_si128 ((__m128i *) &wave[i + 4], _mm_unpackhi_epi16 (v, zero));
+    }
+#endif
+
+  for ( ; i < count ; i++) wave[i] = ((uint32_t) src[i * 2] << 8) | (uint32_t) src[i * 2 + 1];
+}
+
+
+static void unpack_32 (const uint8_t *src, uint32_t *wave, int32_t count)
+{
+  int32_t i = 0;
+
+#ifdef __SSE2__
+  for ( ; i + 4 <= count ; i += 4)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) &src[i * 4]);
+
+
+      //  Swap the 16 bit halves of each 32 bit lane, then the bytes in each 16 bit lane.
+
+      v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+      v = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+      v = _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+
+      _mm_storeu_si128 ((__m128i *) &wave[i], v);
+    }
+#endif
+
+  for ( ; i < count ; i++)
+    wave[i] = ((uint32_t) src[i * 4] << 24) | ((uint32_t) src[i * 4 + 1] << 16) | ((uint32_t) src[i * 4 + 2] << 8) | (uint32_t) src[i * 4 + 3];
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_unpack_waveform
+
+ - Purpose:     Unpack the samples of a raw waveform packet.  8, 16, and 32 bit samples (which
+                is pretty much everything you'll ever see) go through byte aligned kernels.
+                Anything else is unpacked with bit_unpack.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - packet         =    The raw waveform packet
+                - packet_size    =    Size of packet in bytes
+                - wf_packet_desc =    The waveform packet descriptor for this packet (NOT the
+                                      array of 255 descriptors)
+                - wave           =    wf_packet_desc->number_of_samples sized array of uint32_t
+                                      variables
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_unpack_waveform (const uint8_t *packet, uint32_t packet_size, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave)
+{
+  int64_t  pos;
+
+
+  int32_t count = wf_packet_desc->number_of_samples;
+  int32_t size = wf_packet_desc->bits_per_sample;
+
+
+  //  Don't let a bad descriptor walk us off the end of the packet.
+
+  if ((uint64_t) count * (uint64_t) size > (uint64_t) packet_size * 8)
+    {
+      fprintf (stderr, "Waveform packet size %u too small for %d %d bit samples :\nFunction: %s, Line: %d\n", packet_size, count, size,
+               __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-4);
+    }
+
+
+  switch (size)
+    {
+    case 8:
+      unpack_8 (packet, wave, count);
+      break;
+
+    case 16:
+      unpack_16 (packet, wave, count);
+      break;
+
+    case 32:
+      unpack_32 (packet, wave, count);
+      break;
+
+    default:
+      pos = 0;
+      for (int32_t i = 0 ; i < count ; i++)
+        {
+          wave[i] = bit_unpack ((uint8_t *) packet, pos, size); pos += size;
+        }
+      break;
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_encode_point_data
+
+ - Purpose:     Replace the user modifiable fields of a raw LAS point data record without
+                affecting the "non-modifiable" fields.  This is the guts of
+                slas_update_point_data pulled out so that it can work on records in memory.
+
+ - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+ - Date:        03/20/15
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - data           =    The raw record (at least ctx->fixed_length bytes)
+                - record         =    The SLAS_POINT_DATA structure with the new values
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_encode_point_data (SLAS_CONTEXT *ctx, uint8_t *data, SLAS_POINT_DATA *record)
+{
+  int32_t   pos;
+  uint8_t   cls;
+  uint16_t  red, green, blue, nir;
+
+
+  //  Swap copies, not the caller's record.
+
+  red = record->red;
+  green = record->green;
+  blue = record->blue;
+  nir = record->NIR;
+
+  if (ctx->swap)
+    {
+      swap_short ((int16_t *) &red);
+      swap_short ((int16_t *) &green);
+      swap_short ((int16_t *) &blue);
+      swap_short ((int16_t *) &nir);
+    }
+
+
+  //  Extract only the "modifiable" fields.
+
+  pos = 0;
+
+  pos += 4;   //  X
+  pos += 4;   //  Y
+  pos += 4;   //  Z
+  pos += 2;   //  Intensity
+  pos += 1;   //  Formats 0 through 5 = Return Number, Number of Returns, Scan Direction Flag, Edge of Flightline
+              //  Formats 6 through 10 = Return Number, Number of Returns
+
+
+  //  We need to modify this byte in different ways for formats above and below 5.  For 6 through 10 we have to preserve
+  //  the Scanner Channel, Scan Direction Flag, and the Edge of Flightline.  For 0 through 5 we will be replacing the
+  //  classification part of the classification flags as well as the bit fields.
+
+  memcpy (&cls, &data[pos], 1);
+
+
+  //  Check for point format ID above 5.
+
+  if (ctx->point_data_format > 5)
+    {
+      //  Set the "synthetic" bit.
+
+      if (record->synthetic)
+        {
+          cls |= 0x01;
+        }
+      else
+        {
+          cls &= 0xfe;
+        }
+
+
+      //  Set the "keypoint" bit.
+
+      if (record->keypoint)
+        {
+          cls |= 0x02;
+        }
+      else
+        {
+          cls &= 0xfd;
+        }
+
+
+      //  Set the "withheld" bit.
+
+      if (record->withheld)
+        {
+          cls |= 0x04;
+        }
+      else
+        {
+          cls &= 0xfb;
+        }
+
+
+      //  Set the "overlap" bit.
+
+      if (record->overlap)
+        {
+          cls |= 0x08;
+        }
+      else
+        {
+          cls &= 0xf7;
+        }
+    }
+  else
+    {
+      //  Set the classification value first and then add in the bit fields.
+
+      if (record->classification > 31)
+        {
+          fprintf (stderr, "Classification value %d out of bounds :\nFunction: %s, Line: %d\n", record->classification,  __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-4);
+        }
+      cls = record->classification;
+
+
+      //  Set the "synthetic" bit.
+
+      if (record->synthetic)
+        {
+          cls |= 0x20;
+        }
+      else
+        {
+          cls &= 0xdf;
+        }
+
+
+      //  Set the "key point" bit.
+
+      if (record->keypoint)
+        {
+          cls |= 0x40;
+        }
+      else
+        {
+          cls &= 0xbf;
+        }
+
+
+      //  Set the "withheld" bit.
+
+      if (record->withheld)
+        {
+          cls |= 0x80;
+        }
+      else
+        {
           cls &= 0x7f;
         }
     }
 
 
-  //  Replace the byte with the bit flags (and possibly classification) then increment the byte position.
+  //  Replace the byte with the bit flags (and possibly classification) then increment the byte position.
+
+  data[pos] = cls; pos += 1;
+
+
+  //  Check for point format ID above 5.
+
+  if (ctx->point_data_format > 5)
+    {
+      data[pos] = record->classification; pos += 1;
+      data[pos] = record->user_data; pos += 1;
+      pos += 2;  //  Scan Angle
+    }
+  else
+    {
+      pos += 1;  //  Scan Angle
+      data[pos] = record->user_data; pos += 1;
+    }
+
+  pos += 2;  //  Point Source ID
+
+
+  switch (ctx->point_data_format)
+    {
+    case 1:
+    case 6:
+      pos += 8;  //  GPS Time
+      break;
+
+    case 2:
+      memcpy (&data[pos], &red, 2); pos += 2;
+      memcpy (&data[pos], &green, 2); pos += 2;
+      memcpy (&data[pos], &blue, 2); pos += 2;
+      break;
+
+    case 3:
+    case 7:
+      pos += 8;  //  GPS Time
+      memcpy (&data[pos], &red, 2); pos += 2;
+      memcpy (&data[pos], &green, 2); pos += 2;
+      memcpy (&data[pos], &blue, 2); pos += 2;
+      break;
+
+    case 4:
+    case 9:
+      pos += 8;  //  GPS Time
+      break;
+
+    case 5:
+      pos += 8;  //  GPS Time
+      memcpy (&data[pos], &red, 2); pos += 2;
+      memcpy (&data[pos], &green, 2); pos += 2;
+      memcpy (&data[pos], &blue, 2); pos += 2;
+      break;
+
+    case 8:
+      pos += 8;  //  GPS Time
+      memcpy (&data[pos], &red, 2); pos += 2;
+      memcpy (&data[pos], &green, 2); pos += 2;
+      memcpy (&data[pos], &blue, 2); pos += 2;
+      memcpy (&data[pos], &nir, 2); pos += 2;
+      break;
+
+    case 10:
+      pos += 8;  //  GPS Time
+      memcpy (&data[pos], &red, 2); pos += 2;
+      memcpy (&data[pos], &green, 2); pos += 2;
+      memcpy (&data[pos], &blue, 2); pos += 2;
+      memcpy (&data[pos], &nir, 2); pos += 2;
+      break;
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_update_point_data
+
+ - Purpose:     Updates the user modifiable fields of a LAS point data record without affecting
+                the "non-modifiable" fields.
+
+ - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+ - Date:        03/20/15
+
+ - Arguments:
+                - fp             =    The file pointer
+                - recnum         =    The record number of the LAS point data record to be written
+		                      (records start at 0)
+                - lasheader      =    The LASheader retrieved from the LAS file
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - record         =    The SLAS_POINT_DATA structure to be updated
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+ - Caveats:     This moves the file pointer.  If you need to update from more than one thread use
+                slas_init_context and slas_ctx_update_point_data.
+
+*********************************************************************************************/
+
+int32_t slas_update_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record)
+{
+  SLAS_CONTEXT  ctx;
+  uint8_t       data[SLAS_MAX_FIXED_RECORD_LENGTH];
+  int64_t       addr;
+  int32_t       status;
+
+
+  if (slas_init_context (&ctx, -1, lasheader, swap)) return (-1);
+
+
+  //  Check for record out of bounds.
+
+  if (recnum >= ctx.number_of_points)
+    {
+      fprintf (stderr, "Record number %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  //  Move to the beginning of the requested record in the file.
+
+  addr = ctx.offset_to_point_data + (int64_t) ctx.record_length * (int64_t) recnum;
+
+
+  if (fseeko64 (fp, addr, SEEK_SET) < 0)
+    {
+      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+
+  //  Read the data buffer.
+
+  if (!fread (data, ctx.fixed_length, 1, fp))
+    {
+      fprintf (stderr, "Error reading LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
+    }
+
+
+  if ((status = slas_encode_point_data (&ctx, data, record))) return (status);
+
+
+  //  Go back to the beginning of the record.
+
+  if (fseeko64 (fp, addr, SEEK_SET) < 0)
+    {
+      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-5);
+    }
+
+
+  //  Write the record.
+
+  if (!fwrite (data, ctx.fixed_length, 1, fp))
+    {
+      fprintf (stderr, "Error writing LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-6);
+    }
+
+
+  return (0);
+}
+
+
+
+//  One positional read.  Returns the number of bytes read (which may be short), 0 at end of file, or -1 on error.
+
+static int64_t pread_some (int32_t fd, void *buf, size_t size, int64_t offset)
+{
+#ifdef NVWIN3X
+  OVERLAPPED  ov;
+  DWORD       got = 0, want = size > 0x40000000 ? 0x40000000 : (DWORD) size;
+
+  memset (&ov, 0, sizeof (OVERLAPPED));
+  ov.Offset = (DWORD) (offset & 0xffffffff);
+  ov.OffsetHigh = (DWORD) (offset >> 32);
+
+  if (!ReadFile ((HANDLE) _get_osfhandle (fd), buf, want, &got, &ov)) return (GetLastError () == ERROR_HANDLE_EOF ? 0 : -1);
+
+  return ((int64_t) got);
+#else
+  ssize_t got;
+
+  do
+    {
+      got = pread64 (fd, buf, size, offset);
+    } while (got < 0 && errno == EINTR);
+
+  return ((int64_t) got);
+#endif
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_pread
+
+ - Purpose:     Positional read that doesn't move (or care about) the file offset so it can be
+                used from multiple threads on the same file descriptor.  Short reads are
+                retried until we get everything or hit an error.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - fd             =    The file descriptor
+                - buf            =    Where to put the data
+                - size           =    Number of bytes to read
+                - offset         =    Byte offset in the file
+
+ - Returns:     int32_t          =    -1 on error or end of file, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_pread (int32_t fd, void *buf, size_t size, int64_t offset)
+{
+  uint8_t *ptr = (uint8_t *) buf;
+
+
+  while (size)
+    {
+      int64_t got = pread_some (fd, ptr, size, offset);
+
+      if (got <= 0) return (-1);
+
+      ptr += got;
+      size -= got;
+      offset += got;
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_pwrite
+
+ - Purpose:     Positional write.  See slas_pread.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - fd             =    The file descriptor
+                - buf            =    The data
+                - size           =    Number of bytes to write
+                - offset         =    Byte offset in the file
+
+ - Returns:     int32_t          =    -1 on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_pwrite (int32_t fd, const void *buf, size_t size, int64_t offset)
+{
+  const uint8_t *ptr = (const uint8_t *) buf;
+
+
+  while (size)
+    {
+#ifdef NVWIN3X
+      OVERLAPPED  ov;
+      DWORD       put = 0, want = size > 0x40000000 ? 0x40000000 : (DWORD) size;
+
+      memset (&ov, 0, sizeof (OVERLAPPED));
+      ov.Offset = (DWORD) (offset & 0xffffffff);
+      ov.OffsetHigh = (DWORD) (offset >> 32);
+
+      if (!WriteFile ((HANDLE) _get_osfhandle (fd), ptr, want, &put, &ov) || !put) return (-1);
+#else
+      ssize_t put = pwrite64 (fd, ptr, size, offset);
+
+      if (put < 0 && errno == EINTR) continue;
+      if (put <= 0) return (-1);
+#endif
+
+      ptr += put;
+      size -= put;
+      offset += put;
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_init_context
+
+ - Purpose:     Work out the record layout for a LAS file once so that the slas_ctx_* functions
+                don't have to go back to the LASheader for every record.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT to be filled in
+                - fd             =    File descriptor opened with O_RDONLY or O_RDWR (and
+                                      O_BINARY on Windows), or -1 if the context will only be
+                                      used with slas_decode_point_data/slas_encode_point_data
+                - lasheader      =    The LASheader retrieved from the LAS file
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_init_context (SLAS_CONTEXT *ctx, int32_t fd, LASheader *lasheader, uint8_t swap)
+{
+  //  Length of the format defined part of the record for formats 0 through 10.
+
+  static const uint16_t fixed_length[11] = {20, 28, 26, 34, 57, 63, 30, 36, 38, 59, 67};
+
+
+  memset (ctx, 0, sizeof (SLAS_CONTEXT));
+
+
+  if (lasheader->point_data_format > 10)
+    {
+      fprintf (stderr, "Point data format %d not supported :\nFunction: %s, Line: %d\n", lasheader->point_data_format, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+  if (lasheader->point_data_record_length < fixed_length[lasheader->point_data_format])
+    {
+      fprintf (stderr, "Point data record length %d too short for format %d :\nFunction: %s, Line: %d\n", lasheader->point_data_record_length,
+               lasheader->point_data_format, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  ctx->fd = fd;
+  ctx->swap = swap;
+  ctx->version_minor = lasheader->version_minor;
+  ctx->point_data_format = lasheader->point_data_format;
+  ctx->record_length = lasheader->point_data_record_length;
+  ctx->fixed_length = fixed_length[lasheader->point_data_format];
+  ctx->offset_to_point_data = lasheader->offset_to_point_data;
+  ctx->start_of_waveform_data_packet_record = lasheader->start_of_waveform_data_packet_record;
+  ctx->x_scale_factor = lasheader->x_scale_factor;
+  ctx->y_scale_factor = lasheader->y_scale_factor;
+  ctx->z_scale_factor = lasheader->z_scale_factor;
+  ctx->x_offset = lasheader->x_offset;
+  ctx->y_offset = lasheader->y_offset;
+  ctx->z_offset = lasheader->z_offset;
+
+
+  //  LAS 1.4 has a 64 bit point count.  Some writers leave it at 0 and only fill in the legacy count.
+
+  if (lasheader->version_minor >= 4 && lasheader->extended_number_of_point_records)
+    {
+      ctx->number_of_points = lasheader->extended_number_of_point_records;
+    }
+  else
+    {
+      ctx->number_of_points = lasheader->number_of_point_records;
+    }
+
+
+  //  Field offsets.  The first 15 bytes are the same for every format.
+
+  ctx->flags_offset = 15;
+  ctx->gps_time_offset = ctx->rgb_offset = ctx->nir_offset = ctx->wave_offset = -1;
+
+  if (ctx->point_data_format > 5)
+    {
+      ctx->withheld_mask = 0x04;
+      ctx->classification_offset = 16;
+      ctx->user_data_offset = 17;
+      ctx->point_source_id_offset = 20;
+      ctx->gps_time_offset = 22;
+
+      switch (ctx->point_data_format)
+        {
+        case 7:
+          ctx->rgb_offset = 30;
+          break;
+
+        case 8:
+          ctx->rgb_offset = 30;
+          ctx->nir_offset = 36;
+          break;
+
+        case 9:
+          ctx->wave_offset = 30;
+          break;
+
+        case 10:
+          ctx->rgb_offset = 30;
+          ctx->nir_offset = 36;
+          ctx->wave_offset = 38;
+          break;
+        }
+    }
+  else
+    {
+      ctx->withheld_mask = 0x80;
+      ctx->classification_offset = 15;
+      ctx->user_data_offset = 17;
+      ctx->point_source_id_offset = 18;
+
+      switch (ctx->point_data_format)
+        {
+        case 1:
+          ctx->gps_time_offset = 20;
+          break;
+
+        case 2:
+          ctx->rgb_offset = 20;
+          break;
+
+        case 3:
+          ctx->gps_time_offset = 20;
+          ctx->rgb_offset = 28;
+          break;
+
+        case 4:
+          ctx->gps_time_offset = 20;
+          ctx->wave_offset = 28;
+          break;
+
+        case 5:
+          ctx->gps_time_offset = 20;
+          ctx->rgb_offset = 28;
+          ctx->wave_offset = 34;
+          break;
+        }
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_ctx_read_records
+
+ - Purpose:     Read a block of raw (undecoded) point data records with a single positional
+                read.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - first          =    The first record to read (records start at 0)
+                - count          =    Number of records to read
+                - buffer         =    count * ctx->record_length bytes
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_ctx_read_records (SLAS_CONTEXT *ctx, uint64_t first, uint32_t count, uint8_t *buffer)
+{
+  if (first > ctx->number_of_points || count > ctx->number_of_points - first)
+    {
+      fprintf (stderr, "Records %" PRIu64 " through %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", first, first + count - 1,
+               __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  if (slas_pread (ctx->fd, buffer, (size_t) count * ctx->record_length, ctx->offset_to_point_data + (int64_t) first * ctx->record_length))
+    {
+      fprintf (stderr, "Error reading LAS records :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_ctx_write_records
+
+ - Purpose:     Write a block of raw point data records with a single positional write.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - first          =    The first record to write (records start at 0)
+                - count          =    Number of records to write
+                - buffer         =    count * ctx->record_length bytes
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_ctx_write_records (SLAS_CONTEXT *ctx, uint64_t first, uint32_t count, const uint8_t *buffer)
+{
+  if (first > ctx->number_of_points || count > ctx->number_of_points - first)
+    {
+      fprintf (stderr, "Records %" PRIu64 " through %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", first, first + count - 1,
+               __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  if (slas_pwrite (ctx->fd, buffer, (size_t) count * ctx->record_length, ctx->offset_to_point_data + (int64_t) first * ctx->record_length))
+    {
+      fprintf (stderr, "Error writing LAS records :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-6);
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_ctx_read_point_data
+
+ - Purpose:     Retrieve a LAS point data record using positional I/O.  Same as
+                slas_read_point_data except that it's safe to call from multiple threads.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - recnum         =    The record number of the LAS point data record to be
+                                      retrieved (records start at 0)
+                - record         =    The returned Simple LAS point data record
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_ctx_read_point_data (SLAS_CONTEXT *ctx, uint64_t recnum, SLAS_POINT_DATA *record)
+{
+  uint8_t  data[SLAS_MAX_FIXED_RECORD_LENGTH];
+
+
+  if (recnum >= ctx->number_of_points)
+    {
+      fprintf (stderr, "Record number %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  if (slas_pread (ctx->fd, data, ctx->fixed_length, ctx->offset_to_point_data + (int64_t) recnum * ctx->record_length))
+    {
+      fprintf (stderr, "Error reading LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
+    }
+
+
+  slas_decode_point_data (ctx, data, record);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_ctx_update_point_data
+
+ - Purpose:     Updates the user modifiable fields of a LAS point data record using positional
+                I/O.  Same as slas_update_point_data except that it's safe to call from multiple
+                threads (as long as they aren't updating the same record).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - recnum         =    The record number of the LAS point data record to be written
+                                      (records start at 0)
+                - record         =    The SLAS_POINT_DATA structure to be updated
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_ctx_update_point_data (SLAS_CONTEXT *ctx, uint64_t recnum, SLAS_POINT_DATA *record)
+{
+  uint8_t  data[SLAS_MAX_FIXED_RECORD_LENGTH];
+  int64_t  addr;
+  int32_t  status;
+
+
+  if (recnum >= ctx->number_of_points)
+    {
+      fprintf (stderr, "Record number %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  addr = ctx->offset_to_point_data + (int64_t) recnum * ctx->record_length;
+
+  if (slas_pread (ctx->fd, data, ctx->fixed_length, addr))
+    {
+      fprintf (stderr, "Error reading LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
+    }
+
+
+  if ((status = slas_encode_point_data (ctx, data, record))) return (status);
+
+
+  if (slas_pwrite (ctx->fd, data, ctx->fixed_length, addr))
+    {
+      fprintf (stderr, "Error writing LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-6);
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_ctx_read_waveform_data
+
+ - Purpose:     Retrieve a LAS waveform record (from the internal waveform data packet record)
+                using positional I/O.  For external .wdp files use slas_open_waveform_map.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - record         =    The Simple LAS point data record for which waveform data
+                                      is to be retrieved
+                - wf_packet_desc =    The array of 255 possible waveform packet descriptor
+                                      records
+                - wave           =    wf_packet_desc[record->wavepacket_descriptor_index].number_of_samples
+                                      sized array of uint32_t variables
+                - buffer         =    SLAS_WAVEFORM_BUFFER initialized with slas_init_waveform_buffer
+                                      (one per thread)
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_ctx_read_waveform_data (SLAS_CONTEXT *ctx, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave,
+                                     SLAS_WAVEFORM_BUFFER *buffer)
+{
+  if (record->waveform_packet_size > buffer->size)
+    {
+      uint8_t *new_data = (uint8_t *) realloc (buffer->data, record->waveform_packet_size);
+
+      if (new_data == NULL)
+        {
+          fprintf (stderr, "Error allocating waveform buffer :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-3);
+        }
+
+      buffer->data = new_data;
+      buffer->size = record->waveform_packet_size;
+    }
+
+
+  if (slas_pread (ctx->fd, buffer->data, record->waveform_packet_size,
+                  ctx->start_of_waveform_data_packet_record + (int64_t) record->byte_offset_to_waveform_data))
+    {
+      fprintf (stderr, "Error reading LAS waveform data :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+
+  return (slas_unpack_waveform (buffer->data, record->waveform_packet_size, &wf_packet_desc[record->wavepacket_descriptor_index], wave));
+}
+
+
+
+//  Little endian field extraction for the header parser.  Doing it a byte at a time means we don't care what the
+//  system byte order is.
+
+static uint16_t get_u16 (const uint8_t *buf)
+{
+  return ((uint16_t) buf[0] | ((uint16_t) buf[1] << 8));
+}
+
+
+static uint32_t get_u32 (const uint8_t *buf)
+{
+  return ((uint32_t) buf[0] | ((uint32_t) buf[1] << 8) | ((uint32_t) buf[2] << 16) | ((uint32_t) buf[3] << 24));
+}
+
+
+static uint64_t get_u64 (const uint8_t *buf)
+{
+  return ((uint64_t) get_u32 (buf) | ((uint64_t) get_u32 (&buf[4]) << 32));
+}
+
+
+static double get_f64 (const uint8_t *buf)
+{
+  double   value;
+  uint64_t bits = get_u64 (buf);
+
+  memcpy (&value, &bits, 8);
+
+  return (value);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_read_header
+
+ - Purpose:     Minimal LAS public header block parser.  This reads the fixed header (up to the
+                375 bytes of a LAS 1.4 header) with a single positional read, validates the
+                signature and version, and fills in the LASheader fields that the slas
+                functions use.  It doesn't touch the VLRs (see slas_read_vlrs) and it doesn't
+                need a LASreader so it's a lot cheaper than opening the file with LASlib.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - fd             =    The file descriptor
+                - lasheader      =    The LASheader to be filled in
+                - compressed     =    If not NULL, set to NVTrue if the point data format has
+                                      the LASzip compression bits set (i.e. it's a LAZ file).
+                                      The compression bits are removed from
+                                      lasheader->point_data_format.
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_read_header (int32_t fd, LASheader *lasheader, uint8_t *compressed)
+{
+  uint8_t  buf[375];
+  int64_t  got;
+  int32_t  required;
+
+
+  memset (buf, 0, sizeof (buf));
+
+  got = pread_some (fd, buf, sizeof (buf), 0);
+
+
+  //  227 bytes is the size of a LAS 1.0 through 1.2 header.
+
+  if (got < 227 || memcmp (buf, "LASF", 4))
+    {
+      fprintf (stderr, "Not a LAS file :\nFunction: %s, Line: %d\n", __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  memcpy (lasheader->file_signature, buf, 4);
+  lasheader->file_source_ID = get_u16 (&buf[4]);
+  lasheader->global_encoding = get_u16 (&buf[6]);
+  lasheader->project_ID_GUID_data_1 = get_u32 (&buf[8]);
+  lasheader->project_ID_GUID_data_2 = get_u16 (&buf[12]);
+  lasheader->project_ID_GUID_data_3 = get_u16 (&buf[14]);
+  memcpy (lasheader->project_ID_GUID_data_4, &buf[16], 8);
+  lasheader->version_major = buf[24];
+  lasheader->version_minor = buf[25];
+  memcpy (lasheader->system_identifier, &buf[26], 32);
+  memcpy (lasheader->generating_software, &buf[58], 32);
+  lasheader->file_creation_day = get_u16 (&buf[90]);
+  lasheader->file_creation_year = get_u16 (&buf[92]);
+  lasheader->header_size = get_u16 (&buf[94]);
+  lasheader->offset_to_point_data = get_u32 (&buf[96]);
+  lasheader->number_of_variable_length_records = get_u32 (&buf[100]);
+  lasheader->point_data_format = buf[104];
+  lasheader->point_data_record_length = get_u16 (&buf[105]);
+  lasheader->number_of_point_records = get_u32 (&buf[107]);
+  for (int32_t i = 0 ; i < 5 ; i++) lasheader->number_of_points_by_return[i] = get_u32 (&buf[111 + i * 4]);
+  lasheader->x_scale_factor = get_f64 (&buf[131]);
+  lasheader->y_scale_factor = get_f64 (&buf[139]);
+  lasheader->z_scale_factor = get_f64 (&buf[147]);
+  lasheader->x_offset = get_f64 (&buf[155]);
+  lasheader->y_offset = get_f64 (&buf[163]);
+  lasheader->z_offset = get_f64 (&buf[171]);
+  lasheader->max_x = get_f64 (&buf[179]);
+  lasheader->min_x = get_f64 (&buf[187]);
+  lasheader->max_y = get_f64 (&buf[195]);
+  lasheader->min_y = get_f64 (&buf[203]);
+  lasheader->max_z = get_f64 (&buf[211]);
+  lasheader->min_z = get_f64 (&buf[219]);
+
+
+  if (lasheader->version_major != 1)
+    {
+      fprintf (stderr, "LAS major version %d incorrect :\nFunction: %s, Line: %d\n", lasheader->version_major, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+  if (lasheader->version_minor > 4)
+    {
+      fprintf (stderr, "LAS minor version %d incorrect :\nFunction: %s, Line: %d\n", lasheader->version_minor, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+
+  required = 227;
+  if (lasheader->version_minor == 3) required = 235;
+  if (lasheader->version_minor == 4) required = 375;
+
+  if (lasheader->header_size < required || got < required || lasheader->offset_to_point_data < lasheader->header_size)
+    {
+      fprintf (stderr, "LAS 1.%d header size %d (offset to point data %u) incorrect :\nFunction: %s, Line: %d\n", lasheader->version_minor,
+               lasheader->header_size, lasheader->offset_to_point_data, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
+    }
+
+
+  lasheader->start_of_waveform_data_packet_record = 0;
+  lasheader->start_of_first_extended_variable_length_record = 0;
+  lasheader->number_of_extended_variable_length_records = 0;
+  lasheader->extended_number_of_point_records = 0;
+
+  if (lasheader->version_minor >= 3) lasheader->start_of_waveform_data_packet_record = get_u64 (&buf[227]);
+
+  if (lasheader->version_minor >= 4)
+    {
+      lasheader->start_of_first_extended_variable_length_record = get_u64 (&buf[235]);
+      lasheader->number_of_extended_variable_length_records = get_u32 (&buf[243]);
+      lasheader->extended_number_of_point_records = get_u64 (&buf[247]);
+      for (int32_t i = 0 ; i < 15 ; i++) lasheader->extended_number_of_points_by_return[i] = get_u64 (&buf[255 + i * 8]);
+    }
+
+
+  //  LASzip sets bit 7 (and bit 6 for the old pointwise compressor) of the point data format.
 
-  data[pos] = cls; pos += 1;
+  if (compressed) *compressed = (lasheader->point_data_format & 0xc0) ? NVTrue : NVFalse;
+  lasheader->point_data_format &= 0x3f;
 
 
-  //  Check for point format ID above 5.
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_read_vlrs
+
+ - Purpose:     Walk the variable length records and extended variable length records of a LAS
+                file.  Only the record headers are read.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
 
-  if (lasheader->point_data_format > 5)
+ - Arguments:
+                - fd             =    The file descriptor
+                - lasheader      =    The LASheader from slas_read_header (or LASlib)
+                - vlrs           =    Returned array of SLAS_VLR (allocated here, free it with
+                                      free)
+                - count          =    Returned number of SLAS_VLR in vlrs
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_read_vlrs (int32_t fd, LASheader *lasheader, SLAS_VLR **vlrs, int32_t *count)
+{
+  uint8_t   buf[60];
+  int64_t   pos;
+  uint32_t  total;
+
+
+  *vlrs = NULL;
+  *count = 0;
+
+  total = lasheader->number_of_variable_length_records + lasheader->number_of_extended_variable_length_records;
+  if (!total) return (0);
+
+  if ((*vlrs = (SLAS_VLR *) calloc (total, sizeof (SLAS_VLR))) == NULL)
     {
-      data[pos] = record->classification; pos += 1;
-      data[pos] = record->user_data; pos += 1;
-      pos += 2;  //  Scan Angle
+      fprintf (stderr, "Error allocating VLR list :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
     }
-  else
+
+
+  //  VLRs start right after the header and have a 54 byte header.
+
+  pos = lasheader->header_size;
+
+  for (uint32_t i = 0 ; i < lasheader->number_of_variable_length_records ; i++)
     {
-      pos += 1;  //  Scan Angle
-      data[pos] = record->user_data; pos += 1;
+      if (pos + 54 > (int64_t) lasheader->offset_to_point_data || slas_pread (fd, buf, 54, pos))
+        {
+          fprintf (stderr, "Error reading VLR %u :\nFunction: %s, Line: %d\n", i, __FUNCTION__, __LINE__);
+          fflush (stderr);
+          free (*vlrs);
+          *vlrs = NULL;
+          return (-2);
+        }
+
+      SLAS_VLR *vlr = &(*vlrs)[*count];
+
+      memcpy (vlr->user_id, &buf[2], 16);
+      vlr->record_id = get_u16 (&buf[18]);
+      vlr->record_length = get_u16 (&buf[20]);
+      vlr->data_offset = pos + 54;
+      vlr->extended = NVFalse;
+
+      pos = vlr->data_offset + vlr->record_length;
+      (*count)++;
     }
 
-  pos += 2;  //  Point Source ID
 
+  //  EVLRs (LAS 1.4) have a 60 byte header with a 64 bit length.
 
-  switch (lasheader->point_data_format)
+  pos = lasheader->start_of_first_extended_variable_length_record;
+
+  for (uint32_t i = 0 ; i < lasheader->number_of_extended_variable_length_records ; i++)
+    {
+      if (slas_pread (fd, buf, 60, pos))
+        {
+          fprintf (stderr, "Error reading EVLR %u :\nFunction: %s, Line: %d\n", i, __FUNCTION__, __LINE__);
+          fflush (stderr);
+          free (*vlrs);
+          *vlrs = NULL;
+          *count = 0;
+          return (-3);
+        }
+
+      SLAS_VLR *vlr = &(*vlrs)[*count];
+
+      memcpy (vlr->user_id, &buf[2], 16);
+      vlr->record_id = get_u16 (&buf[18]);
+      vlr->record_length = get_u64 (&buf[20]);
+      vlr->data_offset = pos + 60;
+      vlr->extended = NVTrue;
+
+      pos = vlr->data_offset + vlr->record_length;
+      (*count)++;
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_find_vlr
+
+ - Purpose:     Find a VLR/EVLR by user ID and record ID.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - vlrs           =    Array of SLAS_VLR from slas_read_vlrs
+                - count          =    Number of SLAS_VLR in vlrs
+                - user_id        =    User ID (e.g. "LASF_Spec")
+                - record_id      =    Record ID or -1 to match any record ID
+
+ - Returns:     int32_t          =    Index into vlrs or -1 if not found
+
+*********************************************************************************************/
+
+int32_t slas_find_vlr (SLAS_VLR *vlrs, int32_t count, const char *user_id, int32_t record_id)
+{
+  for (int32_t i = 0 ; i < count ; i++)
+    {
+      if (!strncmp (vlrs[i].user_id, user_id, 16) && (record_id < 0 || vlrs[i].record_id == record_id)) return (i);
+    }
+
+  return (-1);
+}
+
+
+
+//  Size in bytes of extra bytes data types 1 through 10.  The deprecated types 11 through 30 are arrays of two or
+//  three of these.
+
+static const uint16_t extra_type_size[10] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+
+
+//  Raw extra bytes value (or no_data, which is stored in the descriptor as a full 8 byte value of the same kind).
+
+static double extra_raw (const uint8_t *data, uint8_t data_type, uint8_t wide)
+{
+  switch (data_type)
     {
     case 1:
-    case 6:
-      pos += 8;  //  GPS Time
-      break;
+      return (wide ? (double) get_u64 (data) : (double) data[0]);
 
     case 2:
-      if (swap)
-        {
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
-        }
-      memcpy (&data[pos], &record->red, 2); pos += 2;
-      memcpy (&data[pos], &record->green, 2); pos += 2;
-      memcpy (&data[pos], &record->blue, 2); pos += 2;
-      break;
+      return (wide ? (double) (int64_t) get_u64 (data) : (double) (int8_t) data[0]);
 
     case 3:
+      return (wide ? (double) get_u64 (data) : (double) get_u16 (data));
+
+    case 4:
+      return (wide ? (double) (int64_t) get_u64 (data) : (double) (int16_t) get_u16 (data));
+
+    case 5:
+      return (wide ? (double) get_u64 (data) : (double) get_u32 (data));
+
+    case 6:
+      return (wide ? (double) (int64_t) get_u64 (data) : (double) (int32_t) get_u32 (data));
+
     case 7:
-      pos += 8;  //  GPS Time
-      if (swap)
+      return ((double) get_u64 (data));
+
+    case 8:
+      return ((double) (int64_t) get_u64 (data));
+
+    case 9:
+      if (!wide)
         {
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
+          float    value;
+          uint32_t bits = get_u32 (data);
+
+          memcpy (&value, &bits, 4);
+
+          return ((double) value);
         }
-      memcpy (&data[pos], &record->red, 2); pos += 2;
-      memcpy (&data[pos], &record->green, 2); pos += 2;
-      memcpy (&data[pos], &record->blue, 2); pos += 2;
-      break;
 
-    case 4:
-    case 9:
-      pos += 8;  //  GPS Time
-      break;
+      return (get_f64 (data));
 
-    case 5:
-      pos += 8;  //  GPS Time
-      if (swap)
+    case 10:
+      return (get_f64 (data));
+    }
+
+  return (0.0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_ctx_read_extra_bytes
+
+ - Purpose:     Read the Extra Bytes VLR (LASF_Spec record 4) and fill in the extra bytes
+                dimensions of the context.  The descriptors are laid out one after another
+                starting at the end of the format defined part of the record.  Undocumented
+                extra bytes (data type 0) and the deprecated array types (11 through 30) are
+                stepped over but not described.  Only the first SLAS_MAX_EXTRA_DIMS dimensions
+                are kept.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file (from slas_init_context
+                                      with a real file descriptor)
+                - lasheader      =    The LASheader retrieved from the LAS file
+
+ - Returns:     int32_t          =    Number of extra bytes dimensions or -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_ctx_read_extra_bytes (SLAS_CONTEXT *ctx, LASheader *lasheader)
+{
+  SLAS_VLR  *vlrs;
+  int32_t   count, v;
+  uint32_t  pos;
+
+
+  ctx->num_extra = 0;
+
+  if (ctx->record_length == ctx->fixed_length) return (0);
+
+  if (ctx->fd < 0 || slas_read_vlrs (ctx->fd, lasheader, &vlrs, &count)) return (-1);
+
+  if ((v = slas_find_vlr (vlrs, count, "LASF_Spec", 4)) < 0)
+    {
+      free (vlrs);
+      return (0);
+    }
+
+  uint64_t descriptors = vlrs[v].record_length / 192;
+  int64_t offset = vlrs[v].data_offset;
+
+  free (vlrs);
+
+
+  pos = ctx->fixed_length;
+
+  for (uint64_t i = 0 ; i < descriptors && ctx->num_extra < SLAS_MAX_EXTRA_DIMS ; i++)
+    {
+      uint8_t  desc[192];
+      uint16_t size;
+
+
+      if (slas_pread (ctx->fd, desc, 192, offset + (int64_t) i * 192))
         {
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
+          fprintf (stderr, "Error reading extra bytes descriptor %" PRIu64 " :\n%s\nFunction: %s, Line: %d\n", i, strerror (errno),
+                   __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-1);
         }
-      memcpy (&data[pos], &record->red, 2); pos += 2;
-      memcpy (&data[pos], &record->green, 2); pos += 2;
-      memcpy (&data[pos], &record->blue, 2); pos += 2;
-      break;
 
-    case 8:
-      pos += 8;  //  GPS Time
-      if (swap)
+
+      //  For undocumented extra bytes the options field is the number of bytes.  If we don't know the type we can't
+      //  tell where anything after it is so we stop there.
+
+      uint8_t data_type = desc[2], options = desc[3];
+
+      if (!data_type)
         {
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
-          swap_short ((int16_t *) &record->NIR);
+          size = options;
+        }
+      else if (data_type <= 30)
+        {
+          size = extra_type_size[(data_type - 1) % 10] * ((data_type - 1) / 10 + 1);
+        }
+      else
+        {
+          break;
         }
-      memcpy (&data[pos], &record->red, 2); pos += 2;
-      memcpy (&data[pos], &record->green, 2); pos += 2;
-      memcpy (&data[pos], &record->blue, 2); pos += 2;
-      memcpy (&data[pos], &record->NIR, 2); pos += 2;
-      break;
 
-    case 10:
-      pos += 8;  //  GPS Time
-      if (swap)
+      if (pos + size > ctx->record_length) break;
+
+
+      if (data_type >= 1 && data_type <= 10)
         {
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
-          swap_short ((int16_t *) &record->NIR);
+          SLAS_EXTRA_DIM *dim = &ctx->extra[ctx->num_extra++];
+
+          memcpy (dim->name, &desc[4], 32);
+          dim->name[32] = 0;
+
+          dim->data_type = data_type;
+          dim->offset = (uint16_t) pos;
+          dim->size = size;
+          dim->has_no_data = (options & 0x01) ? NVTrue : NVFalse;
+          dim->no_data = extra_raw (&desc[40], data_type, NVTrue);
+          dim->scale = (options & 0x08) ? get_f64 (&desc[112]) : 1.0;
+          dim->value_offset = (options & 0x10) ? get_f64 (&desc[136]) : 0.0;
         }
-      memcpy (&data[pos], &record->red, 2); pos += 2;
-      memcpy (&data[pos], &record->green, 2); pos += 2;
-      memcpy (&data[pos], &record->blue, 2); pos += 2;
-      memcpy (&data[pos], &record->NIR, 2); pos += 2;
-      break;
+
+      pos += size;
     }
 
 
-  //  Go back to the beginning of the record.
+  return (ctx->num_extra);
+}
 
-  if (fseeko64 (fp, addr, SEEK_SET) < 0)
-    {
-      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
-      fflush (stderr);
-      return (-5);
-    }
 
 
-  //  Write the record.
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_find_extra_dim
+
+ - Purpose:     Find an extra bytes dimension by name (case doesn't matter).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT (after slas_ctx_read_extra_bytes)
+                - name           =    Dimension name
+
+ - Returns:     int32_t          =    Index into ctx->extra or -1 if not found
 
-  if (!fwrite (data, lasheader->point_data_record_length, 1, fp))
+*********************************************************************************************/
+
+int32_t slas_find_extra_dim (SLAS_CONTEXT *ctx, const char *name)
+{
+  for (int32_t i = 0 ; i < ctx->num_extra ; i++)
     {
-      fprintf (stderr, "Error writing LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
-      fflush (stderr);
-      return (-6);
+      if (!QString (ctx->extra[i].name).compare (QString (name), Qt::CaseInsensitive)) return (i);
     }
 
+  return (-1);
+}
 
-  return (0);
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_extra_value
+
+ - Purpose:     Get the (scaled and offset) value of an extra bytes dimension from a raw point
+                data record.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT (after slas_ctx_read_extra_bytes)
+                - dim            =    Index into ctx->extra
+                - data           =    The raw record
+                - value          =    Returned value
+
+ - Returns:     uint8_t          =    NVFalse if the point has the no_data value (value isn't
+                                      set), otherwise NVTrue
+
+*********************************************************************************************/
+
+uint8_t slas_extra_value (SLAS_CONTEXT *ctx, int32_t dim, const uint8_t *data, double *value)
+{
+  SLAS_EXTRA_DIM *extra = &ctx->extra[dim];
+  double raw = extra_raw (&data[extra->offset], extra->data_type, NVFalse);
+
+
+  //  A NaN no_data value never compares equal so check for that as well.
+
+  if (extra->has_no_data && (raw == extra->no_data || (raw != raw && extra->no_data != extra->no_data))) return (NVFalse);
+
+  *value = raw * extra->scale + extra->value_offset;
+
+  return (NVTrue);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_decode_extra_values
+
+ - Purpose:     Pull one extra bytes dimension out of a block of raw records (from
+                slas_ctx_read_records) into an array.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT (after slas_ctx_read_extra_bytes)
+                - dim            =    Index into ctx->extra
+                - buffer         =    count * ctx->record_length bytes of raw records
+                - count          =    Number of records in buffer
+                - values         =    Returned values (0.0 where the point has no value)
+                - valid          =    Returned NVTrue/NVFalse for each value (may be NULL)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_decode_extra_values (SLAS_CONTEXT *ctx, int32_t dim, const uint8_t *buffer, uint32_t count, double *values, uint8_t *valid)
+{
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      uint8_t ok = slas_extra_value (ctx, dim, &buffer[(size_t) i * ctx->record_length], &values[i]);
+
+      if (!ok) values[i] = 0.0;
+      if (valid) valid[i] = ok;
+    }
 }
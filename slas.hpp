@@ -47,6 +47,26 @@
 #include <unistd.h>
 #include <errno.h>
 #include <sys/types.h>
+#include <fcntl.h>
+
+#ifdef NVWIN3X
+#include <windows.h>
+#include <io.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+
+//!  Longest format defined (i.e. without extra bytes) point data record (format 10).
+
+#define SLAS_MAX_FIXED_RECORD_LENGTH    67
+
+
+//!  Most extra bytes dimensions slas_ctx_read_extra_bytes will keep track of.
+
+#define SLAS_MAX_EXTRA_DIMS             32
 
 
 typedef struct
@@ -95,9 +115,167 @@ typedef struct
 } SLAS_WAVEFORM_PACKET_DESCRIPTOR;
 
 
+/*!  Caller owned buffer for raw waveform packets.  Initialize it with slas_init_waveform_buffer, pass it to as many
+     slas_read_waveform_data_buf calls as you like (it only grows), and release it with slas_free_waveform_buffer.  */
+
+typedef struct
+{
+  uint8_t                     *data;                           //!<  Raw packet bytes
+  uint32_t                    size;                            //!<  Allocated size of data in bytes
+} SLAS_WAVEFORM_BUFFER;
+
+
+/*!  Read-only mapping of the waveform data packets (either the internal waveform data packet record or the external
+     .wdp file).  Once it's open any number of threads can pull waveforms out of it at the same time since there is
+     no file pointer to share.  */
+
+typedef struct
+{
+  uint8_t                     *map;                            //!<  Start of the mapped region (page aligned)
+  uint64_t                    map_size;                        //!<  Size of the mapped region in bytes
+  const uint8_t               *packets;                        //!<  Address that byte_offset_to_waveform_data is relative to
+  uint64_t                    packets_size;                    //!<  Number of bytes available starting at packets
+  uint8_t                     external;                        //!<  NVTrue if the packets came from a .wdp file
+#ifdef NVWIN3X
+  HANDLE                      file;
+  HANDLE                      mapping;
+#endif
+} SLAS_WAVEFORM_MAP;
+
+
+/*!  One slot of the SLAS_WAVEFORM_CACHE.  */
+
+typedef struct
+{
+  uint64_t                    offset;                          //!<  byte_offset_to_waveform_data of the cached packet
+  int32_t                     index;                           //!<  wavepacket_descriptor_index of the cached packet
+  uint32_t                    count;                           //!<  Number of unpacked samples in wave
+  uint32_t                    wave_size;                       //!<  Allocated size of wave (in samples)
+  uint32_t                    *wave;                           //!<  Unpacked samples
+  int32_t                     prev;                            //!<  LRU list, toward most recently used
+  int32_t                     next;                            //!<  LRU list, toward least recently used
+  int32_t                     chain;                           //!<  Next slot in the same hash bucket
+} SLAS_WAVEFORM_CACHE_ENTRY;
+
+
+/*!  Bounded LRU cache of unpacked waveforms.  All of the returns from a pulse point at the same packet so, for a
+     sequential walk, this saves one read and unpack per extra return.  It is not thread safe, use one per thread.  */
+
+typedef struct
+{
+  SLAS_WAVEFORM_CACHE_ENTRY   *entries;
+  int32_t                     *buckets;
+  int32_t                     bucket_mask;
+  int32_t                     capacity;                        //!<  Maximum number of cached waveforms
+  int32_t                     used;                            //!<  Number of slots in use
+  int32_t                     head;                            //!<  Most recently used slot
+  int32_t                     tail;                            //!<  Least recently used slot
+  uint64_t                    hits;
+  uint64_t                    misses;
+} SLAS_WAVEFORM_CACHE;
+
+
+/*!  Variable length record (or extended variable length record) location.  These are filled in by slas_read_vlrs
+     which only reads the record headers.  The payload can be read with slas_pread at data_offset.  */
+
+typedef struct
+{
+  char                        user_id[17];
+  uint16_t                    record_id;
+  uint64_t                    record_length;                   //!<  Payload length (record length after header)
+  int64_t                     data_offset;                     //!<  File offset of the payload
+  uint8_t                     extended;                        //!<  NVTrue if this is an EVLR
+} SLAS_VLR;
+
+
+/*!  Extra bytes dimension.  These are filled in from the Extra Bytes VLR (LASF_Spec record 4) by
+     slas_ctx_read_extra_bytes.  The value is stored at offset in each record as data_type and slas_extra_value returns
+     it as (raw * scale) + value_offset.  */
+
+typedef struct
+{
+  char                        name[33];
+  uint8_t                     data_type;                       //!<  LAS extra bytes data type (1 through 10)
+  uint16_t                    offset;                          //!<  Offset of the value in the point data record
+  uint16_t                    size;                            //!<  Size of the value in bytes
+  uint8_t                     has_no_data;                     //!<  NVTrue if no_data is set
+  double                      no_data;                         //!<  Raw value meaning "no value for this point"
+  double                      scale;                           //!<  1.0 if the descriptor doesn't set one
+  double                      value_offset;                    //!<  0.0 if the descriptor doesn't set one
+} SLAS_EXTRA_DIM;
+
+
+/*!  Per file layout context.  Everything that the record functions would otherwise re-derive from the LASheader on
+     every call is worked out once by slas_init_context.  The slas_ctx_* functions only do positional I/O on fd so any
+     number of threads can share one context (and one file descriptor).  */
+
+typedef struct
+{
+  int32_t                     fd;                              //!<  File descriptor (-1 if only used for decoding)
+  uint8_t                     swap;                            //!<  Byte swap flag (big endian system)
+  uint8_t                     version_minor;
+  uint8_t                     point_data_format;
+  uint16_t                    record_length;                   //!<  point_data_record_length (including extra bytes)
+  uint16_t                    fixed_length;                    //!<  Length of the format defined part of the record
+  int64_t                     offset_to_point_data;
+  uint64_t                    number_of_points;                //!<  Point count (extended count for LAS 1.4)
+  int64_t                     start_of_waveform_data_packet_record;
+  double                      x_scale_factor;
+  double                      y_scale_factor;
+  double                      z_scale_factor;
+  double                      x_offset;
+  double                      y_offset;
+  double                      z_offset;
+  int16_t                     flags_offset;                    //!<  Offset of the byte holding the withheld bit
+  uint8_t                     withheld_mask;                   //!<  Mask of the withheld bit in that byte
+  int16_t                     classification_offset;
+  int16_t                     user_data_offset;
+  int16_t                     point_source_id_offset;
+  int16_t                     gps_time_offset;                 //!<  -1 if the format has no GPS time
+  int16_t                     rgb_offset;                      //!<  -1 if the format has no RGB
+  int16_t                     nir_offset;                      //!<  -1 if the format has no NIR
+  int16_t                     wave_offset;                     //!<  -1 if the format has no wave packet fields
+  int32_t                     num_extra;                       //!<  Extra bytes dimensions (0 until slas_ctx_read_extra_bytes)
+  SLAS_EXTRA_DIM              extra[SLAS_MAX_EXTRA_DIMS];
+} SLAS_CONTEXT;
+
+
 int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record);
 int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave);
 int32_t slas_update_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record);
 
+void slas_init_waveform_buffer (SLAS_WAVEFORM_BUFFER *buffer);
+void slas_free_waveform_buffer (SLAS_WAVEFORM_BUFFER *buffer);
+int32_t slas_read_waveform_data_buf (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc,
+                                     uint32_t *wave, SLAS_WAVEFORM_BUFFER *buffer);
+int32_t slas_open_waveform_map (const char *las_path, LASheader *lasheader, SLAS_WAVEFORM_MAP *wf_map);
+void slas_close_waveform_map (SLAS_WAVEFORM_MAP *wf_map);
+const uint8_t *slas_waveform_packet (SLAS_WAVEFORM_MAP *wf_map, SLAS_POINT_DATA *record);
+int32_t slas_read_waveform_data_map (SLAS_WAVEFORM_MAP *wf_map, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave);
+int32_t slas_init_waveform_cache (SLAS_WAVEFORM_CACHE *cache, int32_t capacity);
+void slas_free_waveform_cache (SLAS_WAVEFORM_CACHE *cache);
+const uint32_t *slas_read_waveform_data_cached (SLAS_WAVEFORM_CACHE *cache, SLAS_WAVEFORM_MAP *wf_map, SLAS_POINT_DATA *record,
+                                                SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc);
+double slas_waveform_cache_hit_rate (SLAS_WAVEFORM_CACHE *cache);
+int32_t slas_unpack_waveform (const uint8_t *packet, uint32_t packet_size, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave);
+
+int32_t slas_pread (int32_t fd, void *buf, size_t size, int64_t offset);
+int32_t slas_pwrite (int32_t fd, const void *buf, size_t size, int64_t offset);
+int32_t slas_read_header (int32_t fd, LASheader *lasheader, uint8_t *compressed);
+int32_t slas_read_vlrs (int32_t fd, LASheader *lasheader, SLAS_VLR **vlrs, int32_t *count);
+int32_t slas_find_vlr (SLAS_VLR *vlrs, int32_t count, const char *user_id, int32_t record_id);
+int32_t slas_init_context (SLAS_CONTEXT *ctx, int32_t fd, LASheader *lasheader, uint8_t swap);
+void slas_decode_point_data (SLAS_CONTEXT *ctx, const uint8_t *data, SLAS_POINT_DATA *record);
+int32_t slas_encode_point_data (SLAS_CONTEXT *ctx, uint8_t *data, SLAS_POINT_DATA *record);
+int32_t slas_ctx_read_records (SLAS_CONTEXT *ctx, uint64_t first, uint32_t count, uint8_t *buffer);
+int32_t slas_ctx_write_records (SLAS_CONTEXT *ctx, uint64_t first, uint32_t count, const uint8_t *buffer);
+int32_t slas_ctx_read_point_data (SLAS_CONTEXT *ctx, uint64_t recnum, SLAS_POINT_DATA *record);
+int32_t slas_ctx_update_point_data (SLAS_CONTEXT *ctx, uint64_t recnum, SLAS_POINT_DATA *record);
+int32_t slas_ctx_read_waveform_data (SLAS_CONTEXT *ctx, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave,
+                                     SLAS_WAVEFORM_BUFFER *buffer);
+int32_t slas_ctx_read_extra_bytes (SLAS_CONTEXT *ctx, LASheader *lasheader);
+int32_t slas_find_extra_dim (SLAS_CONTEXT *ctx, const char *name);
+uint8_t slas_extra_value (SLAS_CONTEXT *ctx, int32_t dim, const uint8_t *data, double *value);
+void slas_decode_extra_values (SLAS_CONTEXT *ctx, int32_t dim, const uint8_t *buffer, uint32_t count, double *values, uint8_t *valid);
 
 #endif
@@ -0,0 +1,279 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_clone.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#ifndef NVWIN3X
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
+
+
+#ifndef NVWIN3X
+
+//  Copy with copy_file_range.  Returns 0 if it worked, 1 if the kernel or filesystem can't do it (and nothing has been
+//  copied yet), or -1 on error.
+
+static int32_t copy_range (int32_t in, int32_t out, int64_t size)
+{
+#if defined (__linux__) && defined (SYS_copy_file_range)
+  int64_t done = 0;
+
+  while (done < size)
+    {
+      int64_t count = syscall (SYS_copy_file_range, in, NULL, out, NULL, (size_t) qMin (size - done, (int64_t) 1073741824), 0);
+
+      if (count < 0)
+        {
+          if (!done && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) return (1);
+          return (-1);
+        }
+
+      if (!count) return (-1);
+
+      done += count;
+    }
+
+  return (0);
+#else
+  return (1);
+#endif
+}
+
+
+static int32_t copy_plain (int32_t in, int32_t out)
+{
+  uint8_t *buffer;
+
+  if ((buffer = (uint8_t *) malloc (SLAS_CLONE_BUFFER)) == NULL) return (-1);
+
+  if (lseek (in, 0, SEEK_SET) < 0 || lseek (out, 0, SEEK_SET) < 0 || ftruncate (out, 0))
+    {
+      free (buffer);
+      return (-1);
+    }
+
+  int32_t status = 0;
+
+  while (NVTrue)
+    {
+      ssize_t got = read (in, buffer, SLAS_CLONE_BUFFER);
+
+      if (got < 0 && errno == EINTR) continue;
+
+      if (got <= 0)
+        {
+          if (got < 0) status = -1;
+          break;
+        }
+
+      for (ssize_t put = 0 ; put < got ; )
+        {
+          ssize_t count = write (out, &buffer[put], got - put);
+
+          if (count < 0 && errno == EINTR) continue;
+
+          if (count <= 0)
+            {
+              status = -1;
+              break;
+            }
+
+          put += count;
+        }
+
+      if (status) break;
+    }
+
+  free (buffer);
+
+  return (status);
+}
+
+#endif
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_clone_file
+
+ - Purpose:     Copy src to dst as cheaply as the filesystem allows (reflink, then
+                copy_file_range, then a plain copy).  dst is replaced if it exists (unless
+                it is src).  If the copy fails dst is removed.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - src            =    Source file
+                - dst            =    Destination file
+                - method         =    If not NULL, returns SLAS_CLONE_REFLINK,
+                                      SLAS_CLONE_COPY_RANGE, or SLAS_CLONE_COPY
+
+ - Returns:     int32_t          =    0 on success, -1 on error (message goes to stderr)
+
+*********************************************************************************************/
+
+int32_t slas_clone_file (const char *src, const char *dst, int32_t *method)
+{
+  int32_t status = 0, how = SLAS_CLONE_COPY;
+
+
+#ifdef NVWIN3X
+
+  if (!CopyFileA (src, dst, FALSE)) status = -1;
+
+#else
+
+  struct stat st;
+  int32_t in, out;
+
+
+  if ((in = open (src, O_RDONLY)) < 0)
+    {
+      fprintf (stderr, "\nUnable to open %s : %s\n\n", src, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+  //  Copying a file onto itself would truncate it before we read it.
+
+  struct stat dst_st;
+
+  if (!fstat (in, &st) && !stat (dst, &dst_st) && st.st_dev == dst_st.st_dev && st.st_ino == dst_st.st_ino)
+    {
+      fprintf (stderr, "\n%s and %s are the same file\n\n", src, dst);
+      fflush (stderr);
+      close (in);
+      return (-1);
+    }
+
+  if (fstat (in, &st) || (out = open (dst, O_WRONLY | O_CREAT | O_TRUNC, st.st_mode & 0777)) < 0)
+    {
+      fprintf (stderr, "\nUnable to create %s : %s\n\n", dst, strerror (errno));
+      fflush (stderr);
+      close (in);
+      return (-1);
+    }
+
+
+#ifdef FICLONE
+  if (!ioctl (out, FICLONE, in))
+    {
+      how = SLAS_CLONE_REFLINK;
+    }
+  else
+#endif
+    {
+      if (!(status = copy_range (in, out, (int64_t) st.st_size)))
+        {
+          how = SLAS_CLONE_COPY_RANGE;
+        }
+      else if (status > 0)
+        {
+          status = copy_plain (in, out);
+        }
+    }
+
+  if (close (out)) status = -1;
+  close (in);
+
+#endif
+
+
+  if (status)
+    {
+      fprintf (stderr, "\nUnable to copy %s to %s : %s\n\n", src, dst, strerror (errno));
+      fflush (stderr);
+
+      QFile::remove (QString (dst));
+      return (-1);
+    }
+
+  if (method != NULL) *method = how;
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_clone_method_name
+
+ - Purpose:     Get a printable name for a slas_clone_file method.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - method         =    SLAS_CLONE_REFLINK, SLAS_CLONE_COPY_RANGE, or SLAS_CLONE_COPY
+
+ - Returns:     const char *     =    Name
+
+*********************************************************************************************/
+
+const char *slas_clone_method_name (int32_t method)
+{
+  switch (method)
+    {
+    case SLAS_CLONE_REFLINK:
+      return ("reflink");
+
+    case SLAS_CLONE_COPY_RANGE:
+      return ("copy_file_range");
+    }
+
+  return ("copy");
+}
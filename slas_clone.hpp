@@ -0,0 +1,69 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Cheap copies of a LAS file for --output mode.  The copy is a reflink (FICLONE) if the filesystem can do it, which
+    shares all of the extents with the original until we write to them, so after las_zero patches the flag bytes only
+    the pages that changed take up new space.  Otherwise it's copy_file_range (which lets the kernel or a network
+    filesystem do the copy without bringing the data up into user space), and failing that a plain copy with big
+    sequential reads and writes.  */
+
+#ifndef __SLAS_CLONE_HPP__
+#define __SLAS_CLONE_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+
+//!  How slas_clone_file made the copy.
+
+#define SLAS_CLONE_REFLINK              0
+#define SLAS_CLONE_COPY_RANGE           1
+#define SLAS_CLONE_COPY                 2
+
+
+//!  Buffer size for the plain copy.
+
+#define SLAS_CLONE_BUFFER               8388608
+
+
+int32_t slas_clone_file (const char *src, const char *dst, int32_t *method);
+const char *slas_clone_method_name (int32_t method);
+
+
+#endif
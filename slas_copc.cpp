@@ -0,0 +1,591 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_copc.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#include <math.h>
+
+
+//!  Size of a COPC hierarchy entry and of the COPC info VLR payload.
+
+#define COPC_ENTRY_SIZE                 32
+#define COPC_INFO_SIZE                  160
+
+
+//  Pages pointing back at each other would have us going around forever so we give up after this many.
+
+#define COPC_MAX_PAGES                  1048576
+
+
+//  COPC is little endian no matter what we're running on.
+
+static int32_t get_i32 (const uint8_t *buf)
+{
+  return ((int32_t) ((uint32_t) buf[0] | ((uint32_t) buf[1] << 8) | ((uint32_t) buf[2] << 16) | ((uint32_t) buf[3] << 24)));
+}
+
+
+static uint64_t get_u64 (const uint8_t *buf)
+{
+  return ((uint64_t) (uint32_t) get_i32 (buf) | ((uint64_t) (uint32_t) get_i32 (&buf[4]) << 32));
+}
+
+
+static double get_f64 (const uint8_t *buf)
+{
+  double   value;
+  uint64_t bits = get_u64 (buf);
+
+  memcpy (&value, &bits, 8);
+
+  return (value);
+}
+
+
+static void put_i32 (uint8_t *buf, int32_t value)
+{
+  for (int32_t i = 0 ; i < 4 ; i++) buf[i] = (uint8_t) ((uint32_t) value >> (8 * i));
+}
+
+
+static void put_u64 (uint8_t *buf, uint64_t value)
+{
+  for (int32_t i = 0 ; i < 8 ; i++) buf[i] = (uint8_t) (value >> (8 * i));
+}
+
+
+static int compare_nodes (const void *a, const void *b)
+{
+  const SLAS_COPC_NODE *na = (const SLAS_COPC_NODE *) a;
+  const SLAS_COPC_NODE *nb = (const SLAS_COPC_NODE *) b;
+
+  if (na->offset < nb->offset) return (-1);
+  if (na->offset > nb->offset) return (1);
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_copc_read
+
+ - Purpose:     Check for the COPC info VLR and, if it's there, read the whole COPC hierarchy.
+                Only nodes that have points are kept.  They are sorted by chunk offset and
+                first_record is set to the record number of each node's first point.  This
+                only reads the uncompressed parts of the file so it's cheap.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - fd             =    The file descriptor
+                - lasheader      =    The LASheader from slas_read_header
+                - memory         =    Optional SLAS_MEMORY budget for the node array
+                - copc           =    Returned SLAS_COPC (free it with slas_copc_free)
+
+ - Returns:     int32_t          =    1 if it's a COPC file, 0 if it isn't, -1 on error, -2 if
+                                      the nodes don't fit in the memory budget
+
+*********************************************************************************************/
+
+int32_t slas_copc_read (int32_t fd, LASheader *lasheader, SLAS_MEMORY *memory, SLAS_COPC *copc)
+{
+  SLAS_VLR  *vlrs;
+  int32_t   count, size = 0;
+  uint8_t   info[COPC_INFO_SIZE];
+  uint64_t  *pages = NULL;
+  int32_t   num_pages = 0, pages_size = 0, pages_read = 0;
+  uint8_t   *page = NULL;
+
+
+  memset (copc, 0, sizeof (SLAS_COPC));
+
+  if (lasheader->version_major != 1 || lasheader->version_minor < 4) return (0);
+
+  if (slas_read_vlrs (fd, lasheader, &vlrs, &count)) return (-1);
+
+
+  //  The spec says the info VLR has to be the first one.
+
+  if (!count || vlrs[0].extended || strncmp (vlrs[0].user_id, "copc", 16) || vlrs[0].record_id != 1 ||
+      vlrs[0].record_length < COPC_INFO_SIZE)
+    {
+      free (vlrs);
+      return (0);
+    }
+
+  copc->info_offset = vlrs[0].data_offset;
+  copc->memory = memory;
+
+  int32_t status = slas_pread (fd, info, COPC_INFO_SIZE, vlrs[0].data_offset);
+
+  free (vlrs);
+
+  if (status) return (-1);
+
+
+  copc->center_x = get_f64 (&info[0]);
+  copc->center_y = get_f64 (&info[8]);
+  copc->center_z = get_f64 (&info[16]);
+  copc->halfsize = get_f64 (&info[24]);
+  copc->spacing = get_f64 (&info[32]);
+  copc->root_hier_offset = get_u64 (&info[40]);
+  copc->root_hier_size = get_u64 (&info[48]);
+
+
+  //  Walk the hierarchy pages.  Each page is an array of entries, an entry with a point count of -1 points at a child
+  //  page instead of a chunk.
+
+  int64_t file_size = lseek (fd, 0, SEEK_END);
+
+  uint64_t offset = copc->root_hier_offset;
+  uint64_t page_size = copc->root_hier_size;
+
+  status = 0;
+
+  while (NVTrue)
+    {
+      if (page_size % COPC_ENTRY_SIZE || offset + page_size > (uint64_t) file_size || ++pages_read > COPC_MAX_PAGES)
+        {
+          fprintf (stderr, "\nBad COPC hierarchy page (offset %" PRIu64 ", size %" PRIu64 ")\n\n", offset, page_size);
+          fflush (stderr);
+          status = -1;
+          break;
+        }
+
+      if ((int32_t) page_size > size)
+        {
+          uint8_t *new_page = (uint8_t *) realloc (page, page_size);
+
+          if (new_page == NULL)
+            {
+              status = -1;
+              break;
+            }
+
+          page = new_page;
+          size = (int32_t) page_size;
+        }
+
+      if (page_size && slas_pread (fd, page, page_size, offset))
+        {
+          status = -1;
+          break;
+        }
+
+      for (uint64_t e = 0 ; e < page_size ; e += COPC_ENTRY_SIZE)
+        {
+          uint8_t *entry = &page[e];
+          int32_t point_count = get_i32 (&entry[28]);
+
+
+          //  Child page, save it for later.
+
+          if (point_count == -1)
+            {
+              if (num_pages + 2 > pages_size)
+                {
+                  pages_size = pages_size ? pages_size * 2 : 64;
+
+                  uint64_t *new_pages = (uint64_t *) realloc (pages, pages_size * sizeof (uint64_t));
+
+                  if (new_pages == NULL)
+                    {
+                      status = -1;
+                      break;
+                    }
+
+                  pages = new_pages;
+                }
+
+              pages[num_pages++] = get_u64 (&entry[16]);
+              pages[num_pages++] = (uint64_t) (uint32_t) get_i32 (&entry[24]);
+              continue;
+            }
+
+          if (point_count <= 0) continue;
+
+
+          if (!(copc->num_nodes % 1024))
+            {
+              if (slas_memory_reserve (memory, 1024 * sizeof (SLAS_COPC_NODE)))
+                {
+                  status = -2;
+                  break;
+                }
+
+              copc->reserved += 1024 * sizeof (SLAS_COPC_NODE);
+
+              SLAS_COPC_NODE *new_nodes = (SLAS_COPC_NODE *) realloc (copc->nodes, (copc->num_nodes + 1024) * sizeof (SLAS_COPC_NODE));
+
+              if (new_nodes == NULL)
+                {
+                  status = -1;
+                  break;
+                }
+
+              copc->nodes = new_nodes;
+            }
+
+          SLAS_COPC_NODE *node = &copc->nodes[copc->num_nodes++];
+
+          node->level = get_i32 (&entry[0]);
+          node->x = get_i32 (&entry[4]);
+          node->y = get_i32 (&entry[8]);
+          node->z = get_i32 (&entry[12]);
+          node->offset = get_u64 (&entry[16]);
+          node->byte_size = get_i32 (&entry[24]);
+          node->point_count = point_count;
+
+
+          //  The cube edge halves at each level.
+
+          double side = (2.0 * copc->halfsize) / (double) ((uint64_t) 1 << (node->level & 63));
+
+          node->z_min = (copc->center_z - copc->halfsize) + (double) node->z * side;
+          node->z_max = node->z_min + side;
+          node->state = SLAS_COPC_STRADDLE;
+
+          copc->num_points += point_count;
+        }
+
+      if (status || !num_pages) break;
+
+      page_size = pages[--num_pages];
+      offset = pages[--num_pages];
+    }
+
+  free (page);
+  free (pages);
+
+  if (status)
+    {
+      slas_copc_free (copc);
+      return (status);
+    }
+
+
+  //  Put the nodes in chunk (record) order.
+
+  if (copc->num_nodes) qsort (copc->nodes, copc->num_nodes, sizeof (SLAS_COPC_NODE), compare_nodes);
+
+  uint64_t first = 0;
+
+  for (uint32_t i = 0 ; i < copc->num_nodes ; i++)
+    {
+      copc->nodes[i].first_record = first;
+      first += copc->nodes[i].point_count;
+    }
+
+
+  return (1);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_copc_valid
+
+ - Purpose:     Check that the COPC hierarchy accounts for every point in a file, which is
+                what we need before we use the node record ranges.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - copc           =    SLAS_COPC from slas_copc_read
+                - ctx            =    SLAS_CONTEXT of the (decompressed) file
+
+ - Returns:     uint8_t          =    NVTrue if the hierarchy matches the file
+
+*********************************************************************************************/
+
+uint8_t slas_copc_valid (SLAS_COPC *copc, SLAS_CONTEXT *ctx)
+{
+  return (copc->nodes != NULL && copc->num_points == ctx->number_of_points);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_copc_classify
+
+ - Purpose:     Set the state of each node by comparing its Z extent to the threshold.  A
+                node is only called BELOW or ABOVE if it's clear of the threshold by one Z
+                scale factor so points that were quantized just outside of their cube
+                can't fool us.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - copc           =    SLAS_COPC from slas_copc_read
+                - threshold      =    Withheld threshold
+                - z_scale_factor =    Z scale factor from the header
+
+ - Returns:     uint64_t         =    Number of points in nodes that aren't BELOW (that is,
+                                      points that might have to be changed)
+
+*********************************************************************************************/
+
+uint64_t slas_copc_classify (SLAS_COPC *copc, float threshold, double z_scale_factor)
+{
+  uint64_t count = 0;
+  double   tolerance = fabs (z_scale_factor);
+
+
+  for (uint32_t i = 0 ; i < copc->num_nodes ; i++)
+    {
+      SLAS_COPC_NODE *node = &copc->nodes[i];
+
+      if (node->z_max + tolerance <= (double) threshold)
+        {
+          node->state = SLAS_COPC_BELOW;
+        }
+      else
+        {
+          node->state = (node->z_min - tolerance > (double) threshold) ? SLAS_COPC_ABOVE : SLAS_COPC_STRADDLE;
+          count += node->point_count;
+        }
+    }
+
+  return (count);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_copc_update
+
+ - Purpose:     Put the new chunk offsets and sizes into the hierarchy of a COPC file whose
+                chunks were rewritten.  Everything from moved_from on in the old file (the
+                EVLRs, so the hierarchy pages) has to have been copied to the new file delta
+                bytes further along, so the child page offsets and the root page offset in
+                the info VLR are moved by delta too.  The pages are walked the same way
+                slas_copc_read walks them.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - fd             =    The new file (opened for reading and writing)
+                - copc           =    SLAS_COPC from slas_copc_read of the old file
+                - moved_from     =    Old offset of the part of the file that moved
+                - delta          =    How far it moved
+                - offsets        =    New chunk offset of each node (in copc->nodes order)
+                - sizes          =    New chunk size of each node
+
+ - Returns:     int32_t          =    0 on success, -1 if a page isn't in the part of the
+                                      file that moved, an entry doesn't match a node, or
+                                      on a read or write error
+
+*********************************************************************************************/
+
+int32_t slas_copc_update (int32_t fd, SLAS_COPC *copc, uint64_t moved_from, int64_t delta, const uint64_t *offsets, const uint64_t *sizes)
+{
+  uint64_t  *pages = NULL;
+  int32_t   num_pages = 0, pages_size = 0, pages_read = 0, size = 0, status = 0;
+  uint8_t   *page = NULL, value[8];
+
+
+  uint64_t offset = copc->root_hier_offset;
+  uint64_t page_size = copc->root_hier_size;
+
+  while (NVTrue)
+    {
+      //  The offsets in the entries are the old ones, the page itself is delta bytes further along now.
+
+      if (page_size % COPC_ENTRY_SIZE || offset < moved_from || ++pages_read > COPC_MAX_PAGES)
+        {
+          fprintf (stderr, "\nCOPC hierarchy page (offset %" PRIu64 ", size %" PRIu64 ") can't be moved\n\n", offset, page_size);
+          fflush (stderr);
+          status = -1;
+          break;
+        }
+
+      if ((int32_t) page_size > size)
+        {
+          uint8_t *new_page = (uint8_t *) realloc (page, page_size);
+
+          if (new_page == NULL)
+            {
+              status = -1;
+              break;
+            }
+
+          page = new_page;
+          size = (int32_t) page_size;
+        }
+
+      if (page_size && slas_pread (fd, page, page_size, offset + delta))
+        {
+          status = -1;
+          break;
+        }
+
+      for (uint64_t e = 0 ; e < page_size ; e += COPC_ENTRY_SIZE)
+        {
+          uint8_t *entry = &page[e];
+          int32_t point_count = get_i32 (&entry[28]);
+          SLAS_COPC_NODE key;
+
+
+          key.offset = get_u64 (&entry[16]);
+
+
+          //  Child page, it moved with the rest of the EVLRs.
+
+          if (point_count == -1)
+            {
+              if (num_pages + 2 > pages_size)
+                {
+                  pages_size = pages_size ? pages_size * 2 : 64;
+
+                  uint64_t *new_pages = (uint64_t *) realloc (pages, pages_size * sizeof (uint64_t));
+
+                  if (new_pages == NULL)
+                    {
+                      status = -1;
+                      break;
+                    }
+
+                  pages = new_pages;
+                }
+
+              pages[num_pages++] = key.offset;
+              pages[num_pages++] = (uint64_t) (uint32_t) get_i32 (&entry[24]);
+
+              put_u64 (&entry[16], key.offset + delta);
+              continue;
+            }
+
+          if (point_count <= 0) continue;
+
+
+          //  The nodes are sorted by (old) chunk offset.
+
+          SLAS_COPC_NODE *node = (SLAS_COPC_NODE *) bsearch (&key, copc->nodes, copc->num_nodes, sizeof (SLAS_COPC_NODE), compare_nodes);
+
+          if (node == NULL || sizes[node - copc->nodes] > INT32_MAX)
+            {
+              status = -1;
+              break;
+            }
+
+          put_u64 (&entry[16], offsets[node - copc->nodes]);
+          put_i32 (&entry[24], (int32_t) sizes[node - copc->nodes]);
+        }
+
+      if (status) break;
+
+      if (page_size && slas_pwrite (fd, page, page_size, offset + delta))
+        {
+          status = -1;
+          break;
+        }
+
+      if (!num_pages) break;
+
+      page_size = pages[--num_pages];
+      offset = pages[--num_pages];
+    }
+
+  free (page);
+  free (pages);
+
+
+  //  Last of all the root page in the info VLR (that's in front of the point data so it didn't move).
+
+  if (!status)
+    {
+      put_u64 (value, copc->root_hier_offset + delta);
+
+      if (slas_pwrite (fd, value, 8, copc->info_offset + 40)) status = -1;
+    }
+
+
+  return (status);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_copc_free
+
+ - Purpose:     Free the memory allocated by slas_copc_read.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - copc           =    SLAS_COPC
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_copc_free (SLAS_COPC *copc)
+{
+  free (copc->nodes);
+
+  slas_memory_release (copc->memory, copc->reserved);
+
+  copc->nodes = NULL;
+  copc->num_nodes = 0;
+  copc->num_points = 0;
+  copc->reserved = 0;
+}
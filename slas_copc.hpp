@@ -0,0 +1,108 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  COPC (cloud optimized point cloud) hierarchy.  A COPC file is a LAS 1.4 LAZ file where every node of an octree is
+    one LAZ chunk.  The "copc" info VLR gives the octree cube and where the root hierarchy page is, and the hierarchy
+    pages give each node's voxel key, chunk offset, and point count.  The Z extent of a node follows from its voxel key
+    so we can tell, without decompressing anything, which nodes can't have points above a threshold.
+
+    Chunks are stored in the order they appear in the file, so once the nodes are sorted by chunk offset the points of
+    each node are one contiguous range of records in the decompressed file.  When the chunks of a COPC file are rewritten
+    (and moved) slas_copc_update puts the new chunk offsets and sizes into the hierarchy.  */
+
+#ifndef __SLAS_COPC_HPP__
+#define __SLAS_COPC_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <lasreader.hpp>
+#include "slas.hpp"
+#include "slas_memory.hpp"
+
+
+//!  Node states from slas_copc_classify.
+
+#define SLAS_COPC_BELOW                 0                      //!<  Every point is at or below the threshold
+#define SLAS_COPC_STRADDLE              1                      //!<  Points may be on either side of the threshold
+#define SLAS_COPC_ABOVE                 2                      //!<  Every point is above the threshold
+
+
+typedef struct
+{
+  int32_t                     level;                           //!<  Voxel key
+  int32_t                     x;
+  int32_t                     y;
+  int32_t                     z;
+  uint64_t                    offset;                          //!<  File offset of the node's LAZ chunk
+  int32_t                     byte_size;                       //!<  Size of the chunk
+  int32_t                     point_count;
+  uint64_t                    first_record;                    //!<  Record number of the node's first point
+  double                      z_min;                           //!<  Z extent of the node's cube
+  double                      z_max;
+  uint8_t                     state;                           //!<  SLAS_COPC_BELOW, SLAS_COPC_STRADDLE, or SLAS_COPC_ABOVE
+} SLAS_COPC_NODE;
+
+
+typedef struct
+{
+  double                      center_x;                        //!<  Octree cube center
+  double                      center_y;
+  double                      center_z;
+  double                      halfsize;                        //!<  Half the cube edge length
+  double                      spacing;                         //!<  Root level point spacing
+  uint64_t                    root_hier_offset;                //!<  File offset of the root hierarchy page
+  uint64_t                    root_hier_size;
+  uint64_t                    info_offset;                     //!<  File offset of the info VLR payload
+  SLAS_COPC_NODE              *nodes;                          //!<  Nodes that have points, in record order
+  uint32_t                    num_nodes;
+  uint64_t                    num_points;                      //!<  Sum of the node point counts
+  SLAS_MEMORY                 *memory;                         //!<  Budget the nodes were reserved from
+  uint64_t                    reserved;                        //!<  Bytes reserved from it
+} SLAS_COPC;
+
+
+int32_t slas_copc_read (int32_t fd, LASheader *lasheader, SLAS_MEMORY *memory, SLAS_COPC *copc);
+uint8_t slas_copc_valid (SLAS_COPC *copc, SLAS_CONTEXT *ctx);
+uint64_t slas_copc_classify (SLAS_COPC *copc, float threshold, double z_scale_factor);
+int32_t slas_copc_update (int32_t fd, SLAS_COPC *copc, uint64_t moved_from, int64_t delta, const uint64_t *offsets, const uint64_t *sizes);
+void slas_copc_free (SLAS_COPC *copc);
+
+
+#endif
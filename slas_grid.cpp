@@ -0,0 +1,473 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <math.h>
+#include <sys/stat.h>
+
+#include <lasreader.hpp>
+
+#include "slas_grid.hpp"
+#include "slas.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+
+//  Read one tile from the .flt file.  Cells off the edge of the grid and NODATA cells are set to NaN.
+
+static int32_t load_tile (SLAS_GRID *grid, int32_t tile, float *data)
+{
+  int32_t row0 = (tile / grid->tile_cols) * SLAS_GRID_TILE;
+  int32_t col0 = (tile % grid->tile_cols) * SLAS_GRID_TILE;
+  int32_t cols = qMin (SLAS_GRID_TILE, grid->cols - col0);
+  int32_t rows = qMin (SLAS_GRID_TILE, grid->rows - row0);
+
+
+  for (int32_t i = 0 ; i < SLAS_GRID_TILE * SLAS_GRID_TILE ; i++) data[i] = NAN;
+
+  for (int32_t i = 0 ; i < rows ; i++)
+    {
+      float *row = &data[i * SLAS_GRID_TILE];
+      int64_t offset = ((int64_t) (row0 + i) * grid->cols + col0) * sizeof (float);
+
+      if (slas_pread (grid->fd, row, cols * sizeof (float), offset)) return (-1);
+
+      for (int32_t j = 0 ; j < cols ; j++)
+        {
+          if (grid->swap) swap_float (&row[j]);
+          if (row[j] == grid->nodata) row[j] = NAN;
+        }
+    }
+
+  return (0);
+}
+
+
+//  Get the value of a grid cell, loading its tile if we have to.
+
+static inline int32_t grid_cell (SLAS_GRID_CACHE *cache, int32_t row, int32_t col, float *value)
+{
+  SLAS_GRID *grid = cache->grid;
+  int32_t tile = (row / SLAS_GRID_TILE) * grid->tile_cols + col / SLAS_GRID_TILE;
+
+
+  if (tile != cache->last_tile && cache->tiles[tile] == NULL)
+    {
+      float *data;
+
+
+      //  Reuse the oldest tile's memory if the cache is full.
+
+      if (cache->count == cache->capacity)
+        {
+          int32_t old = cache->loaded[cache->next];
+
+          data = cache->tiles[old];
+          cache->tiles[old] = NULL;
+        }
+      else
+        {
+          if ((data = (float *) malloc (SLAS_GRID_TILE * SLAS_GRID_TILE * sizeof (float))) == NULL) return (-1);
+          cache->count++;
+        }
+
+      if (load_tile (grid, tile, data))
+        {
+          //  Either way the slot at next is now empty.
+
+          free (data);
+          cache->count--;
+          return (-1);
+        }
+
+      cache->tiles[tile] = data;
+      cache->loaded[cache->next] = tile;
+      cache->next = (cache->next + 1) % cache->capacity;
+      cache->loads++;
+    }
+
+  cache->last_tile = tile;
+
+  *value = cache->tiles[tile][(row % SLAS_GRID_TILE) * SLAS_GRID_TILE + col % SLAS_GRID_TILE];
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_grid_open
+
+ - Purpose:     Open an ESRI binary float grid (NAME.flt and NAME.hdr) for use as a threshold
+                surface.  Only the header is read, the data is read a tile at a time as it's
+                needed.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - grid           =    The SLAS_GRID
+                - file           =    NAME.flt, NAME.hdr, or just NAME
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_grid_open (SLAS_GRID *grid, const char *file)
+{
+  FILE         *fp;
+  char         line[256], key[128], base[1024], hdr_file[1100];
+  double       value, x_ll = 0.0, y_ll = 0.0;
+  uint8_t      center = NVFalse, msb = NVFalse;
+  struct stat  st;
+
+
+  memset (grid, 0, sizeof (SLAS_GRID));
+  grid->fd = -1;
+  grid->nodata = -9999.0;
+
+  if (strlen (file) >= sizeof (base)) return (-1);
+
+
+  //  Strip the extension (if there is one) so we can build the .hdr and .flt names.
+
+  strcpy (base, file);
+
+  QString name (file);
+  if (name.endsWith (".flt", Qt::CaseInsensitive) || name.endsWith (".hdr", Qt::CaseInsensitive)) base[strlen (base) - 4] = 0;
+
+  sprintf (hdr_file, "%s.hdr", base);
+  sprintf (grid->file, "%s.flt", base);
+
+
+  if ((fp = fopen (hdr_file, "r")) == NULL)
+    {
+      fprintf (stderr, "\nUnable to open grid header %s : %s\n\n", hdr_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+  while (fgets (line, sizeof (line), fp))
+    {
+      char text[128];
+
+      if (sscanf (line, "%127s %127s", key, text) != 2) continue;
+
+      value = atof (text);
+
+      QString k = QString (key).toLower ();
+
+      if (k == "ncols")
+        {
+          grid->cols = (int32_t) value;
+        }
+      else if (k == "nrows")
+        {
+          grid->rows = (int32_t) value;
+        }
+      else if (k == "xllcorner" || k == "xllcenter")
+        {
+          x_ll = value;
+          center = (k == "xllcenter");
+        }
+      else if (k == "yllcorner" || k == "yllcenter")
+        {
+          y_ll = value;
+        }
+      else if (k == "cellsize")
+        {
+          grid->cell_size = value;
+        }
+      else if (k == "nodata_value")
+        {
+          grid->nodata = (float) value;
+        }
+      else if (k == "byteorder")
+        {
+          msb = (QString (text).toUpper () == "MSBFIRST");
+        }
+    }
+
+  fclose (fp);
+
+
+  if (grid->cols <= 0 || grid->rows <= 0 || grid->cell_size <= 0.0)
+    {
+      fprintf (stderr, "\nBad or incomplete grid header %s\n\n", hdr_file);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  //  We work with the outside edges of the grid, not the cell centers.
+
+  if (center)
+    {
+      x_ll -= grid->cell_size / 2.0;
+      y_ll -= grid->cell_size / 2.0;
+    }
+
+  grid->x_origin = x_ll;
+  grid->y_top = y_ll + (double) grid->rows * grid->cell_size;
+  grid->swap = (msb != (uint8_t) big_endian ());
+  grid->tile_cols = (grid->cols + SLAS_GRID_TILE - 1) / SLAS_GRID_TILE;
+  grid->tile_rows = (grid->rows + SLAS_GRID_TILE - 1) / SLAS_GRID_TILE;
+
+
+  if ((grid->fd = open (grid->file, O_RDONLY | O_BINARY)) < 0)
+    {
+      fprintf (stderr, "\nUnable to open grid file %s : %s\n\n", grid->file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+  if (fstat (grid->fd, &st) || (uint64_t) st.st_size < (uint64_t) grid->cols * grid->rows * sizeof (float))
+    {
+      fprintf (stderr, "\nGrid file %s is shorter than its header says it should be\n\n", grid->file);
+      fflush (stderr);
+      close (grid->fd);
+      grid->fd = -1;
+      return (-1);
+    }
+
+  grid->mtime = (int64_t) st.st_mtime;
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_grid_close
+
+ - Purpose:     Close a threshold grid.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - grid           =    The SLAS_GRID
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_grid_close (SLAS_GRID *grid)
+{
+  if (grid->fd >= 0) close (grid->fd);
+  grid->fd = -1;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_grid_init_cache
+
+ - Purpose:     Set up a tile cache for a threshold grid.  Each thread that interpolates
+                from the grid needs its own cache.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - cache          =    The SLAS_GRID_CACHE
+                - grid           =    The (open) SLAS_GRID
+                - capacity       =    Maximum number of tiles to keep (0 for SLAS_GRID_CACHE_TILES)
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_grid_init_cache (SLAS_GRID_CACHE *cache, SLAS_GRID *grid, int32_t capacity)
+{
+  memset (cache, 0, sizeof (SLAS_GRID_CACHE));
+
+  cache->grid = grid;
+  cache->capacity = (capacity > 0) ? capacity : SLAS_GRID_CACHE_TILES;
+  cache->last_tile = -1;
+
+  cache->tiles = (float **) calloc ((size_t) grid->tile_cols * grid->tile_rows, sizeof (float *));
+  cache->loaded = (int32_t *) calloc (cache->capacity, sizeof (int32_t));
+
+  if (cache->tiles == NULL || cache->loaded == NULL)
+    {
+      slas_grid_free_cache (cache);
+      return (-1);
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_grid_free_cache
+
+ - Purpose:     Free a threshold grid tile cache.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - cache          =    The SLAS_GRID_CACHE
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_grid_free_cache (SLAS_GRID_CACHE *cache)
+{
+  if (cache->tiles)
+    {
+      for (int64_t i = 0 ; i < (int64_t) cache->grid->tile_cols * cache->grid->tile_rows ; i++)
+        {
+          if (cache->tiles[i]) free (cache->tiles[i]);
+        }
+
+      free (cache->tiles);
+    }
+
+  if (cache->loaded) free (cache->loaded);
+
+  cache->tiles = NULL;
+  cache->loaded = NULL;
+  cache->count = 0;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_grid_interpolate
+
+ - Purpose:     Bilinearly interpolate the grid at a block of positions.  The grid values
+                are at the cell centers.  Points within half a cell of the edge of the grid
+                use the edge cells, NODATA cells are left out (and the weights of the rest
+                renormalized).  If a point is outside of the grid, or all four surrounding
+                cells are NODATA, its value is NaN.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - cache          =    The SLAS_GRID_CACHE
+                - count          =    Number of positions
+                - x              =    X positions
+                - y              =    Y positions
+                - value          =    Returned interpolated values
+
+ - Returns:     int32_t          =    0 on success, -1 on a read error
+
+*********************************************************************************************/
+
+int32_t slas_grid_interpolate (SLAS_GRID_CACHE *cache, uint32_t count, const double *x, const double *y, float *value)
+{
+  SLAS_GRID *grid = cache->grid;
+  double inv = 1.0 / grid->cell_size;
+
+
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      double fc = (x[i] - grid->x_origin) * inv;
+      double fr = (grid->y_top - y[i]) * inv;
+
+      if (!(fc >= 0.0 && fc <= (double) grid->cols && fr >= 0.0 && fr <= (double) grid->rows))
+        {
+          value[i] = NAN;
+          continue;
+        }
+
+
+      //  Move to cell center coordinates and find the four surrounding cells.
+
+      fc -= 0.5;
+      fr -= 0.5;
+
+      int32_t c0 = (int32_t) floor (fc);
+      int32_t r0 = (int32_t) floor (fr);
+      double dc = fc - c0;
+      double dr = fr - r0;
+
+      int32_t c[2] = {qMax (c0, 0), qMin (c0 + 1, grid->cols - 1)};
+      int32_t r[2] = {qMax (r0, 0), qMin (r0 + 1, grid->rows - 1)};
+      double wc[2] = {1.0 - dc, dc};
+      double wr[2] = {1.0 - dr, dr};
+
+      double sum = 0.0, weight = 0.0;
+
+      for (int32_t j = 0 ; j < 2 ; j++)
+        {
+          for (int32_t k = 0 ; k < 2 ; k++)
+            {
+              float cell;
+
+              if (grid_cell (cache, r[j], c[k], &cell)) return (-1);
+
+              if (cell == cell)
+                {
+                  double w = wr[j] * wc[k];
+
+                  sum += w * cell;
+                  weight += w;
+                }
+            }
+        }
+
+      value[i] = (weight > 0.0) ? (float) (sum / weight) : NAN;
+    }
+
+
+  return (0);
+}
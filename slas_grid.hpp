@@ -0,0 +1,99 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Threshold grids.  Instead of one threshold for the whole file each point is compared against a value bilinearly
+    interpolated (at the point's X/Y) from a raster, typically a datum/water surface separation model.  The grid is an
+    ESRI binary float grid (NAME.flt with a NAME.hdr header) in the same horizontal coordinate system as the LAS data.
+
+    The grid isn't read up front.  It's split into SLAS_GRID_TILE x SLAS_GRID_TILE cell tiles that are read when a point
+    first needs them and kept in a small per-thread cache (SLAS_GRID_CACHE) so that the workers never have to lock
+    anything.  Points outside of the grid, or where the surrounding cells are all NODATA, get a NaN threshold (so they
+    are never withheld).  */
+
+#ifndef __SLAS_GRID_HPP__
+#define __SLAS_GRID_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+
+//!  Tile size (in cells) and default number of tiles kept in each cache.
+
+#define SLAS_GRID_TILE                  256
+#define SLAS_GRID_CACHE_TILES           64
+
+
+typedef struct
+{
+  char                        file[1024];                      //!<  .flt file name
+  int32_t                     fd;
+  int32_t                     cols;
+  int32_t                     rows;
+  double                      x_origin;                        //!<  X of the left edge of the grid
+  double                      y_top;                           //!<  Y of the top edge of the grid
+  double                      cell_size;
+  float                       nodata;
+  uint8_t                     swap;                            //!<  Byte order of the .flt file doesn't match ours
+  int32_t                     tile_cols;                       //!<  Number of tiles across
+  int32_t                     tile_rows;                       //!<  Number of tiles down
+  int64_t                     mtime;                           //!<  Modification time of the .flt file (for the manifest)
+} SLAS_GRID;
+
+
+typedef struct
+{
+  SLAS_GRID                   *grid;
+  float                       **tiles;                         //!<  One pointer per grid tile, NULL if not loaded
+  int32_t                     *loaded;                         //!<  Ring of loaded tile numbers (oldest is evicted first)
+  int32_t                     capacity;
+  int32_t                     count;
+  int32_t                     next;
+  int32_t                     last_tile;                       //!<  Most recently used tile (points come in runs)
+  uint64_t                    loads;                           //!<  Number of tile reads
+} SLAS_GRID_CACHE;
+
+
+int32_t slas_grid_open (SLAS_GRID *grid, const char *file);
+void slas_grid_close (SLAS_GRID *grid);
+int32_t slas_grid_init_cache (SLAS_GRID_CACHE *cache, SLAS_GRID *grid, int32_t capacity);
+void slas_grid_free_cache (SLAS_GRID_CACHE *cache);
+int32_t slas_grid_interpolate (SLAS_GRID_CACHE *cache, uint32_t count, const double *x, const double *y, float *value);
+
+
+#endif
@@ -0,0 +1,545 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_index.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#include <sys/stat.h>
+
+
+static const char index_magic[8] = {'S', 'L', 'A', 'S', 'I', 'D', 'X', '1'};
+static const uint32_t index_order = 0x01020304;
+
+
+static int32_t compare_ids (const void *a, const void *b)
+{
+  return ((int32_t) *(uint16_t *) a - (int32_t) *(uint16_t *) b);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_index_build
+
+ - Purpose:     Build the flightline/GPS time index for a LAS file (one pass through the
+                point records).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - chunk_size     =    Records per chunk (0 for SLAS_INDEX_CHUNK)
+                - index          =    The returned SLAS_INDEX (free with slas_index_free)
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_index_build (SLAS_CONTEXT *ctx, uint32_t chunk_size, SLAS_INDEX *index)
+{
+  struct stat  st;
+  uint8_t      *buffer, seen[65536 / 8];
+  uint32_t     allocated = 0;
+
+
+  memset (index, 0, sizeof (SLAS_INDEX));
+
+  if (!chunk_size) chunk_size = SLAS_INDEX_CHUNK;
+
+  if (fstat (ctx->fd, &st)) return (-1);
+
+  index->number_of_points = ctx->number_of_points;
+  index->offset_to_point_data = ctx->offset_to_point_data;
+  index->file_size = st.st_size;
+  index->record_length = ctx->record_length;
+  index->chunk_size = chunk_size;
+  index->num_chunks = (uint32_t) ((ctx->number_of_points + chunk_size - 1) / chunk_size);
+  index->has_time = (ctx->gps_time_offset >= 0);
+
+
+  if ((index->chunks = (SLAS_INDEX_CHUNK_INFO *) calloc (qMax (index->num_chunks, (uint32_t) 1), sizeof (SLAS_INDEX_CHUNK_INFO))) == NULL ||
+      (buffer = (uint8_t *) malloc ((size_t) chunk_size * ctx->record_length)) == NULL)
+    {
+      slas_index_free (index);
+      return (-1);
+    }
+
+  memset (seen, 0, sizeof (seen));
+
+
+  for (uint32_t c = 0 ; c < index->num_chunks ; c++)
+    {
+      SLAS_INDEX_CHUNK_INFO *chunk = &index->chunks[c];
+      uint64_t first = (uint64_t) c * chunk_size;
+      uint32_t count = (uint32_t) qMin ((uint64_t) chunk_size, ctx->number_of_points - first);
+
+
+      if (slas_ctx_read_records (ctx, first, count, buffer))
+        {
+          free (buffer);
+          slas_index_free (index);
+          return (-1);
+        }
+
+      chunk->first_id = index->num_ids;
+      chunk->gps_min = 1.0e300;
+      chunk->gps_max = -1.0e300;
+
+      for (uint32_t i = 0 ; i < count ; i++)
+        {
+          uint8_t *data = &buffer[(size_t) i * ctx->record_length];
+          int16_t id;
+
+          memcpy (&id, &data[ctx->point_source_id_offset], 2);
+          if (ctx->swap) swap_short (&id);
+
+          uint16_t psid = (uint16_t) id;
+
+          if (!SLAS_SELECTED_ID (seen, psid))
+            {
+              seen[psid >> 3] |= (1 << (psid & 7));
+
+              if (index->num_ids == allocated)
+                {
+                  allocated = allocated ? allocated * 2 : 1024;
+
+                  uint16_t *ids = (uint16_t *) realloc (index->ids, allocated * sizeof (uint16_t));
+
+                  if (ids == NULL)
+                    {
+                      free (buffer);
+                      slas_index_free (index);
+                      return (-1);
+                    }
+
+                  index->ids = ids;
+                }
+
+              index->ids[index->num_ids++] = psid;
+              chunk->num_ids++;
+            }
+
+          if (index->has_time)
+            {
+              double gps;
+
+              memcpy (&gps, &data[ctx->gps_time_offset], 8);
+              if (ctx->swap) swap_double (&gps);
+
+              if (gps < chunk->gps_min) chunk->gps_min = gps;
+              if (gps > chunk->gps_max) chunk->gps_max = gps;
+            }
+        }
+
+
+      //  Sort this chunk's IDs and clear them out of the seen map for the next chunk.
+
+      qsort (&index->ids[chunk->first_id], chunk->num_ids, sizeof (uint16_t), compare_ids);
+
+      for (uint32_t i = 0 ; i < chunk->num_ids ; i++)
+        {
+          uint16_t psid = index->ids[chunk->first_id + i];
+          seen[psid >> 3] &= ~(1 << (psid & 7));
+        }
+    }
+
+  free (buffer);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_index_build_file
+
+ - Purpose:     Build the index for a LAS file and write it to FILE.slx.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - las_file       =    LAS file name
+                - chunk_size     =    Records per chunk (0 for SLAS_INDEX_CHUNK)
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_index_build_file (const char *las_file, uint32_t chunk_size)
+{
+  LASheader     lasheader;
+  SLAS_CONTEXT  ctx;
+  SLAS_INDEX    index;
+  int32_t       fd, status = -1;
+  uint8_t       compressed;
+  char          index_file[1100];
+
+
+  if (strlen (las_file) >= 1024) return (-1);
+
+  if ((fd = open (las_file, O_RDONLY | O_BINARY)) < 0)
+    {
+      fprintf (stderr, "\nUnable to open LAS file %s : %s\n\n", las_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+  if (slas_read_header (fd, &lasheader, &compressed) || compressed || slas_init_context (&ctx, fd, &lasheader, big_endian ()))
+    {
+      fprintf (stderr, "\nUnable to index %s (bad header, unsupported format, or LAZ)\n\n", las_file);
+      fflush (stderr);
+    }
+  else if (!slas_index_build (&ctx, chunk_size, &index))
+    {
+      slas_index_name (las_file, index_file);
+      status = slas_index_write (&index, index_file);
+      slas_index_free (&index);
+    }
+
+  close (fd);
+
+
+  return (status);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_index_write
+
+ - Purpose:     Write an index file.  The index is written in native byte order (with a byte
+                order marker, an index from a machine with the other byte order is just
+                treated as missing).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - index          =    The SLAS_INDEX
+                - file           =    Index file name (see slas_index_name)
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_index_write (SLAS_INDEX *index, const char *file)
+{
+  FILE     *fp;
+  char     tmp_file[1100];
+  uint8_t  ok;
+
+
+  if (strlen (file) >= 1024) return (-1);
+
+  sprintf (tmp_file, "%s.tmp", file);
+
+  if ((fp = fopen (tmp_file, "wb")) == NULL)
+    {
+      fprintf (stderr, "\nUnable to open index file %s : %s\n\n", tmp_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+  ok = (fwrite (index_magic, sizeof (index_magic), 1, fp) == 1 &&
+        fwrite (&index_order, sizeof (uint32_t), 1, fp) == 1 &&
+        fwrite (&index->number_of_points, sizeof (uint64_t), 1, fp) == 1 &&
+        fwrite (&index->offset_to_point_data, sizeof (uint64_t), 1, fp) == 1 &&
+        fwrite (&index->file_size, sizeof (uint64_t), 1, fp) == 1 &&
+        fwrite (&index->record_length, sizeof (uint32_t), 1, fp) == 1 &&
+        fwrite (&index->chunk_size, sizeof (uint32_t), 1, fp) == 1 &&
+        fwrite (&index->num_chunks, sizeof (uint32_t), 1, fp) == 1 &&
+        fwrite (&index->num_ids, sizeof (uint32_t), 1, fp) == 1 &&
+        fwrite (&index->has_time, sizeof (uint8_t), 1, fp) == 1 &&
+        fwrite (index->chunks, sizeof (SLAS_INDEX_CHUNK_INFO), index->num_chunks, fp) == index->num_chunks &&
+        fwrite (index->ids, sizeof (uint16_t), index->num_ids, fp) == index->num_ids);
+
+
+  QFile::remove (QString (file));
+
+  if (fclose (fp) || !ok || !QFile::rename (QString (tmp_file), QString (file)))
+    {
+      QFile::remove (QString (tmp_file));
+
+      fprintf (stderr, "\nUnable to write index file %s\n\n", file);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_index_read
+
+ - Purpose:     Read an index file.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - file           =    Index file name
+                - memory         =    Optional SLAS_MEMORY budget for the chunk and ID arrays
+                - index          =    The returned SLAS_INDEX (free with slas_index_free)
+
+ - Returns:     int32_t          =    0 on success, -1 if the index is missing or unreadable,
+                                      -2 if it doesn't fit in the memory budget
+
+*********************************************************************************************/
+
+int32_t slas_index_read (const char *file, SLAS_MEMORY *memory, SLAS_INDEX *index)
+{
+  FILE     *fp;
+  char     magic[8];
+  uint32_t order;
+  uint8_t  ok;
+
+
+  memset (index, 0, sizeof (SLAS_INDEX));
+
+  if ((fp = fopen (file, "rb")) == NULL) return (-1);
+
+  ok = (fread (magic, sizeof (magic), 1, fp) == 1 && !memcmp (magic, index_magic, sizeof (magic)) &&
+        fread (&order, sizeof (uint32_t), 1, fp) == 1 && order == index_order &&
+        fread (&index->number_of_points, sizeof (uint64_t), 1, fp) == 1 &&
+        fread (&index->offset_to_point_data, sizeof (uint64_t), 1, fp) == 1 &&
+        fread (&index->file_size, sizeof (uint64_t), 1, fp) == 1 &&
+        fread (&index->record_length, sizeof (uint32_t), 1, fp) == 1 &&
+        fread (&index->chunk_size, sizeof (uint32_t), 1, fp) == 1 &&
+        fread (&index->num_chunks, sizeof (uint32_t), 1, fp) == 1 &&
+        fread (&index->num_ids, sizeof (uint32_t), 1, fp) == 1 &&
+        fread (&index->has_time, sizeof (uint8_t), 1, fp) == 1 &&
+        index->chunk_size &&
+        (uint64_t) index->num_chunks == (index->number_of_points + index->chunk_size - 1) / index->chunk_size);
+
+  if (ok)
+    {
+      uint64_t bytes = (uint64_t) qMax (index->num_chunks, (uint32_t) 1) * sizeof (SLAS_INDEX_CHUNK_INFO) +
+        (uint64_t) qMax (index->num_ids, (uint32_t) 1) * sizeof (uint16_t);
+
+      if (slas_memory_reserve (memory, bytes))
+        {
+          fclose (fp);
+          slas_index_free (index);
+          return (-2);
+        }
+
+      index->memory = memory;
+      index->reserved = bytes;
+
+      index->chunks = (SLAS_INDEX_CHUNK_INFO *) calloc (qMax (index->num_chunks, (uint32_t) 1), sizeof (SLAS_INDEX_CHUNK_INFO));
+      index->ids = (uint16_t *) calloc (qMax (index->num_ids, (uint32_t) 1), sizeof (uint16_t));
+
+      ok = (index->chunks != NULL && index->ids != NULL &&
+            fread (index->chunks, sizeof (SLAS_INDEX_CHUNK_INFO), index->num_chunks, fp) == index->num_chunks &&
+            fread (index->ids, sizeof (uint16_t), index->num_ids, fp) == index->num_ids);
+    }
+
+  fclose (fp);
+
+
+  //  Make sure the chunk ID lists are all inside the ID array.
+
+  for (uint32_t i = 0 ; ok && i < index->num_chunks ; i++)
+    {
+      if ((uint64_t) index->chunks[i].first_id + index->chunks[i].num_ids > index->num_ids) ok = NVFalse;
+    }
+
+  if (!ok)
+    {
+      slas_index_free (index);
+      return (-1);
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_index_valid
+
+ - Purpose:     Check that an index still matches a LAS file.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - index          =    The SLAS_INDEX
+                - ctx            =    The SLAS_CONTEXT for the file
+
+ - Returns:     uint8_t          =    NVTrue if the index can be used
+
+*********************************************************************************************/
+
+uint8_t slas_index_valid (SLAS_INDEX *index, SLAS_CONTEXT *ctx)
+{
+  struct stat st;
+
+  if (index->chunks == NULL || fstat (ctx->fd, &st)) return (NVFalse);
+
+  return (index->number_of_points == ctx->number_of_points && index->offset_to_point_data == (uint64_t) ctx->offset_to_point_data &&
+          index->record_length == ctx->record_length && index->file_size == (uint64_t) st.st_size);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_index_chunk_selected
+
+ - Purpose:     Check whether a chunk might have any points in a selection.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - index          =    The SLAS_INDEX
+                - chunk          =    Chunk number
+                - selection      =    The SLAS_SELECTION
+
+ - Returns:     uint8_t          =    NVFalse if none of the chunk's points can be selected
+
+*********************************************************************************************/
+
+uint8_t slas_index_chunk_selected (SLAS_INDEX *index, uint32_t chunk, SLAS_SELECTION *selection)
+{
+  SLAS_INDEX_CHUNK_INFO *info = &index->chunks[chunk];
+
+
+  if (selection->time_range && index->has_time && (info->gps_max < selection->time_min || info->gps_min > selection->time_max)) return (NVFalse);
+
+  if (selection->source_ids)
+    {
+      for (uint32_t i = 0 ; i < info->num_ids ; i++)
+        {
+          if (SLAS_SELECTED_ID (selection->source_ids, index->ids[info->first_id + i])) return (NVTrue);
+        }
+
+      return (NVFalse);
+    }
+
+
+  return (NVTrue);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_index_free
+
+ - Purpose:     Free an index.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - index          =    The SLAS_INDEX
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_index_free (SLAS_INDEX *index)
+{
+  if (index->chunks) free (index->chunks);
+  if (index->ids) free (index->ids);
+
+  slas_memory_release (index->memory, index->reserved);
+
+  index->chunks = NULL;
+  index->ids = NULL;
+  index->num_chunks = index->num_ids = 0;
+  index->memory = NULL;
+  index->reserved = 0;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_index_name
+
+ - Purpose:     Build the index file name for a LAS file (FILE.slx).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - las_file       =    LAS file name
+                - index_file     =    Returned index file name (at least 1030 characters)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_index_name (const char *las_file, char *index_file)
+{
+  sprintf (index_file, "%s.slx", las_file);
+}
@@ -0,0 +1,115 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Flightline/GPS time index.  For every chunk of SLAS_INDEX_CHUNK records (in file order) the index holds the set of
+    point source IDs and the GPS time range of the points in the chunk.  Since files are normally written in acquisition
+    order a selection by flightline (point source ID) and/or time window only hits a few chunks and the rest of the file
+    never has to be read.
+
+    The index is stored next to the LAS file as FILE.slx.  It's only good as long as the point records don't move so it
+    carries the point count, record length, offset to point data, and file size, and is ignored if any of those change.
+    Setting withheld bits doesn't touch anything that's indexed so a las_zero run doesn't invalidate it.  */
+
+#ifndef __SLAS_INDEX_HPP__
+#define __SLAS_INDEX_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <lasreader.hpp>
+#include "slas.hpp"
+#include "slas_memory.hpp"
+
+
+//!  Default number of records per index chunk.
+
+#define SLAS_INDEX_CHUNK                65536
+
+
+typedef struct
+{
+  double                      gps_min;                         //!<  Minimum GPS time in the chunk
+  double                      gps_max;                         //!<  Maximum GPS time in the chunk
+  uint32_t                    first_id;                        //!<  Index of the chunk's first point source ID in SLAS_INDEX ids
+  uint32_t                    num_ids;                         //!<  Number of distinct point source IDs in the chunk
+} SLAS_INDEX_CHUNK_INFO;
+
+
+typedef struct
+{
+  uint64_t                    number_of_points;
+  uint64_t                    offset_to_point_data;
+  uint64_t                    file_size;
+  uint32_t                    record_length;
+  uint32_t                    chunk_size;
+  uint32_t                    num_chunks;
+  uint32_t                    num_ids;
+  uint8_t                     has_time;                        //!<  NVFalse for point formats without GPS time
+  SLAS_INDEX_CHUNK_INFO       *chunks;
+  uint16_t                    *ids;                            //!<  Sorted point source IDs for all chunks, chunk by chunk
+  SLAS_MEMORY                 *memory;                         //!<  Budget chunks and ids were reserved from (slas_index_read)
+  uint64_t                    reserved;                        //!<  Bytes reserved from it
+} SLAS_INDEX;
+
+
+//!  Point selection (by flightline and/or time) applied on top of the threshold.
+
+typedef struct
+{
+  uint8_t                     *source_ids;                     //!<  65536 bit map of point source IDs to process (NULL = all)
+  uint8_t                     time_range;                      //!<  Only process points with GPS time in time_min through time_max
+  double                      time_min;
+  double                      time_max;
+} SLAS_SELECTION;
+
+
+#define SLAS_SELECTED_ID(map, id)  ((map)[(id) >> 3] & (1 << ((id) & 7)))
+
+
+int32_t slas_index_build (SLAS_CONTEXT *ctx, uint32_t chunk_size, SLAS_INDEX *index);
+int32_t slas_index_build_file (const char *las_file, uint32_t chunk_size);
+int32_t slas_index_write (SLAS_INDEX *index, const char *file);
+int32_t slas_index_read (const char *file, SLAS_MEMORY *memory, SLAS_INDEX *index);
+uint8_t slas_index_valid (SLAS_INDEX *index, SLAS_CONTEXT *ctx);
+uint8_t slas_index_chunk_selected (SLAS_INDEX *index, uint32_t chunk, SLAS_SELECTION *selection);
+void slas_index_free (SLAS_INDEX *index);
+void slas_index_name (const char *las_file, char *index_file);
+
+
+#endif
@@ -0,0 +1,859 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+#include "slas_laz.hpp"
+#include "nvutility.hpp"
+
+#include <laszip.hpp>
+#include <bytestreamin_array.hpp>
+#include <bytestreamout_array.hpp>
+#include <laswritepoint.hpp>
+#include <arithmeticencoder.hpp>
+#include <arithmeticdecoder.hpp>
+#include <integercompressor.hpp>
+
+
+//!  The point layers (channel/returns/XY, Z, classification, flags, intensity, scan angle, user data, point source,
+//!  GPS time), the flags layer is the fourth.
+
+#define LAZ_POINT_LAYERS                9
+#define LAZ_FLAGS_LAYER                 3
+
+
+//!  Size of a VLR header.
+
+#define LAZ_VLR_HEADER                  54
+
+
+//  LAZ is little endian no matter what we're running on.
+
+static uint32_t get_u32 (const uint8_t *buf)
+{
+  return ((uint32_t) buf[0] | ((uint32_t) buf[1] << 8) | ((uint32_t) buf[2] << 16) | ((uint32_t) buf[3] << 24));
+}
+
+
+static uint64_t get_u64 (const uint8_t *buf)
+{
+  return ((uint64_t) get_u32 (buf) | ((uint64_t) get_u32 (&buf[4]) << 32));
+}
+
+
+static void put_u32 (uint8_t *buf, uint32_t value)
+{
+  buf[0] = (uint8_t) value;
+  buf[1] = (uint8_t) (value >> 8);
+  buf[2] = (uint8_t) (value >> 16);
+  buf[3] = (uint8_t) (value >> 24);
+}
+
+
+//  The six bits LASzip keeps in the flags layer (edge of flight line, scan direction, and the four classification
+//  flags) from byte 15 of a point format 6 through 10 record.
+
+static inline uint32_t laz_flags (uint8_t byte)
+{
+  return (((uint32_t) (byte >> 7) << 5) | ((uint32_t) ((byte >> 6) & 1) << 4) | (byte & 0x0f));
+}
+
+
+//  Number of layers each chunk has, or -1 if the items aren't the LAS 1.4 ones.
+
+static int32_t count_layers (LASzip *laszip)
+{
+  int32_t layers = 0;
+
+
+  if (!laszip->num_items || laszip->items[0].type != LASitem::POINT14) return (-1);
+
+  for (int32_t i = 0 ; i < laszip->num_items ; i++)
+    {
+      switch (laszip->items[i].type)
+        {
+        case LASitem::POINT14:
+          layers += LAZ_POINT_LAYERS;
+          break;
+
+        case LASitem::RGB14:
+        case LASitem::WAVEPACKET14:
+          layers++;
+          break;
+
+        case LASitem::RGBNIR14:
+          layers += 2;
+          break;
+
+        case LASitem::BYTE14:
+          layers += laszip->items[i].size;
+          break;
+
+        default:
+          return (-1);
+        }
+    }
+
+  return (layers);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_read
+
+ - Purpose:     Read the laszip VLR and the chunk table of a LAZ file.  Only the
+                uncompressed parts of the file (and the chunk table) are read.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - fd             =    The file descriptor
+                - lasheader      =    The LASheader from slas_read_header
+                - memory         =    Optional SLAS_MEMORY budget for the chunk table
+                - laz            =    Returned SLAS_LAZ (free it with slas_laz_free)
+
+ - Returns:     int32_t          =    0, -1 if the file doesn't have a usable laszip VLR
+                                      or chunk table, or -2 if the chunk table doesn't fit
+                                      in the memory budget
+
+*********************************************************************************************/
+
+int32_t slas_laz_read (int32_t fd, LASheader *lasheader, SLAS_MEMORY *memory, SLAS_LAZ *laz)
+{
+  SLAS_VLR  *vlrs;
+  int32_t   count, status = -1;
+  uint8_t   *data = NULL, head[8];
+
+
+  memset (laz, 0, sizeof (SLAS_LAZ));
+
+  if (slas_read_vlrs (fd, lasheader, &vlrs, &count)) return (-1);
+
+  int32_t vlr = slas_find_vlr (vlrs, count, "laszip encoded", 22204);
+
+  if (vlr < 0 || vlrs[vlr].extended || !vlrs[vlr].record_length || (data = (uint8_t *) malloc (vlrs[vlr].record_length)) == NULL ||
+      slas_pread (fd, data, vlrs[vlr].record_length, vlrs[vlr].data_offset))
+    {
+      if (data) free (data);
+      free (vlrs);
+      return (-1);
+    }
+
+  laz->laszip = new LASzip;
+
+  uint8_t unpacked = laz->laszip->unpack (data, (I32) vlrs[vlr].record_length);
+
+  free (data);
+  free (vlrs);
+  data = NULL;
+
+
+  //  Only chunked files have a chunk table (LASzip hasn't written anything else in years).
+
+  laz->record_length = lasheader->point_data_record_length;
+  laz->chunk_size = laz->laszip->chunk_size;
+  laz->layered = (laz->laszip->compressor == LASZIP_COMPRESSOR_LAYERED_CHUNKED);
+
+  uint32_t record_length = 0;
+
+  for (int32_t i = 0 ; unpacked && i < laz->laszip->num_items ; i++) record_length += laz->laszip->items[i].size;
+
+  if (!unpacked || record_length != laz->record_length || !laz->chunk_size ||
+      (laz->laszip->compressor != LASZIP_COMPRESSOR_POINTWISE_CHUNKED && !laz->layered) ||
+      (laz->layered && (laz->num_layers = count_layers (laz->laszip)) < 0))
+    {
+      slas_laz_free (laz);
+      return (-1);
+    }
+
+
+  //  The point data starts with the offset of the chunk table.  LASzip writes -1 there if it couldn't seek back when it
+  //  wrote the file (the offset is then at the end of the file), we don't bother with those.
+
+  int64_t file_size = lseek (fd, 0, SEEK_END);
+
+  uint64_t points = lasheader->number_of_point_records;
+  if (lasheader->version_minor >= 4 && lasheader->extended_number_of_point_records) points = lasheader->extended_number_of_point_records;
+
+  uint64_t table = 0;
+
+  if (!slas_pread (fd, head, 8, lasheader->offset_to_point_data)) table = get_u64 (head);
+
+  if (table < (uint64_t) lasheader->offset_to_point_data + 8 || table + 8 > (uint64_t) file_size)
+    {
+      slas_laz_free (laz);
+      return (-1);
+    }
+
+
+  //  The table runs up to the EVLRs (or the waveform data of a LAS 1.3 file), or the end of the file.
+
+  laz->tail_offset = file_size;
+
+  if (lasheader->version_minor >= 4 && lasheader->number_of_extended_variable_length_records &&
+      lasheader->start_of_first_extended_variable_length_record > table)
+    laz->tail_offset = lasheader->start_of_first_extended_variable_length_record;
+
+  if (lasheader->start_of_waveform_data_packet_record > table && lasheader->start_of_waveform_data_packet_record < laz->tail_offset)
+    laz->tail_offset = lasheader->start_of_waveform_data_packet_record;
+
+  if (laz->tail_offset > (uint64_t) file_size || laz->tail_offset < table + 8)
+    {
+      slas_laz_free (laz);
+      return (-1);
+    }
+
+
+  //  The entries are arithmetic coded so we don't know exactly where they end.  The padding keeps the decoder from
+  //  running off the end of the buffer if it reads ahead.  The encoded table only lives until it's decoded but it
+  //  comes out of the budget while it does.
+
+  uint64_t size = laz->tail_offset - table;
+
+  if (slas_memory_reserve (memory, size + 16))
+    {
+      slas_laz_free (laz);
+      return (-2);
+    }
+
+  if ((data = (uint8_t *) calloc (size + 16, 1)) == NULL || slas_pread (fd, data, size, table) || get_u32 (data))
+    {
+      if (data) free (data);
+      slas_memory_release (memory, size + 16);
+      slas_laz_free (laz);
+      return (-1);
+    }
+
+  laz->num_chunks = get_u32 (&data[4]);
+
+
+  //  The decoded offsets and first records stay around as long as the SLAS_LAZ does.
+
+  uint64_t bytes = 2 * ((uint64_t) laz->num_chunks + 1) * sizeof (uint64_t);
+
+  if (slas_memory_reserve (memory, bytes))
+    {
+      free (data);
+      slas_memory_release (memory, size + 16);
+      slas_laz_free (laz);
+      return (-2);
+    }
+
+  laz->memory = memory;
+  laz->reserved = bytes;
+
+  laz->chunk_first = (uint64_t *) malloc ((laz->num_chunks + 1) * sizeof (uint64_t));
+  laz->chunk_offset = (uint64_t *) malloc ((laz->num_chunks + 1) * sizeof (uint64_t));
+
+  if (laz->chunk_first == NULL || laz->chunk_offset == NULL)
+    {
+      free (data);
+      slas_memory_release (memory, size + 16);
+      slas_laz_free (laz);
+      return (-1);
+    }
+
+  laz->chunk_first[0] = 0;
+  laz->chunk_offset[0] = (uint64_t) lasheader->offset_to_point_data + 8;
+
+  try
+    {
+      ByteStreamInArrayLE stream (&data[8], (I64) (size + 8));
+      ArithmeticDecoder dec;
+
+      dec.init (&stream);
+
+      IntegerCompressor ic (&dec, 32, 2);
+      ic.initDecompressor ();
+
+      I32 chunk_points = 0, chunk_bytes = 0;
+
+      for (uint32_t c = 0 ; c < laz->num_chunks ; c++)
+        {
+          if (laz->chunk_size == U32_MAX)
+            {
+              chunk_points = ic.decompress (c ? chunk_points : 0, 0);
+              laz->chunk_first[c + 1] = laz->chunk_first[c] + (uint32_t) chunk_points;
+            }
+          else
+            {
+              uint64_t end = (uint64_t) (c + 1) * laz->chunk_size;
+
+              laz->chunk_first[c + 1] = (end < points) ? end : points;
+            }
+
+          chunk_bytes = ic.decompress (c ? chunk_bytes : 0, 1);
+          laz->chunk_offset[c + 1] = laz->chunk_offset[c] + (uint32_t) chunk_bytes;
+        }
+
+      dec.done ();
+
+      status = 0;
+    }
+  catch (...)
+    {
+      status = -1;
+    }
+
+  free (data);
+  slas_memory_release (memory, size + 16);
+
+
+  //  The chunks have to account for every point and end right at the chunk table.
+
+  if (status || laz->chunk_first[laz->num_chunks] != points || laz->chunk_offset[laz->num_chunks] != table)
+    {
+      slas_laz_free (laz);
+      return (-1);
+    }
+
+  for (uint32_t c = 0 ; c < laz->num_chunks ; c++)
+    {
+      if (laz->chunk_first[c + 1] <= laz->chunk_first[c] || laz->chunk_offset[c + 1] <= laz->chunk_offset[c])
+        {
+          slas_laz_free (laz);
+          return (-1);
+        }
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_init
+
+ - Purpose:     Set up an SLAS_LAZ for writing a new LAZ file.  LAS 1.4 point formats get
+                the layered compressor, the others the pointwise one.  The chunk size is
+                U32_MAX so that every chunk can have a different number of points (their
+                counts go in the chunk table).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - laz            =    Returned SLAS_LAZ (free it with slas_laz_free)
+                - point_data_format = Point data format (0 through 10)
+                - record_length  =    Point data record length
+
+ - Returns:     int32_t          =    0 or -1 if LASzip can't compress the format
+
+*********************************************************************************************/
+
+int32_t slas_laz_init (SLAS_LAZ *laz, uint8_t point_data_format, uint16_t record_length)
+{
+  memset (laz, 0, sizeof (SLAS_LAZ));
+
+  laz->laszip = new LASzip;
+  laz->record_length = record_length;
+  laz->layered = (point_data_format >= 6);
+
+  if (!laz->laszip->setup (point_data_format, record_length, laz->layered ? LASZIP_COMPRESSOR_LAYERED_CHUNKED :
+                           LASZIP_COMPRESSOR_POINTWISE_CHUNKED) || !laz->laszip->request_version (laz->layered ? 3 : 2) ||
+      !laz->laszip->set_chunk_size (U32_MAX) || (laz->layered && (laz->num_layers = count_layers (laz->laszip)) < 0))
+    {
+      slas_laz_free (laz);
+      return (-1);
+    }
+
+  laz->chunk_size = U32_MAX;
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_vlr
+
+ - Purpose:     Build the laszip VLR (header and payload) for an SLAS_LAZ from
+                slas_laz_init.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - laz            =    SLAS_LAZ
+                - vlr            =    Returned VLR (replaces what was in it)
+
+ - Returns:     int32_t          =    0 or -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_laz_vlr (SLAS_LAZ *laz, SLAS_LAZ_BUFFER *vlr)
+{
+  uint8_t  head[LAZ_VLR_HEADER], *payload;
+  I32      size;
+
+
+  vlr->size = 0;
+
+  if (!laz->laszip->pack (payload, size) || size <= 0 || size > 65535) return (-1);
+
+  memset (head, 0, LAZ_VLR_HEADER);
+  strcpy ((char *) &head[2], "laszip encoded");
+  head[18] = 22204 & 0xff;
+  head[19] = 22204 >> 8;
+  head[20] = (uint8_t) (size & 0xff);
+  head[21] = (uint8_t) (size >> 8);
+  strcpy ((char *) &head[22], "by las_zero");
+
+  if (slas_laz_buffer_put (vlr, head, LAZ_VLR_HEADER) || slas_laz_buffer_put (vlr, payload, size)) return (-1);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_compress
+
+ - Purpose:     Compress records into one chunk.  This only uses the caller's point and
+                buffer so any number of threads can be compressing chunks at once.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - laz            =    SLAS_LAZ from slas_laz_init
+                - point          =    LASpoint set up for the point format (by the caller,
+                                      one per thread)
+                - records        =    The records
+                - count          =    Number of records
+                - out            =    Returned chunk (replaces what was in it)
+
+ - Returns:     int32_t          =    0 or -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_laz_compress (SLAS_LAZ *laz, LASpoint *point, const uint8_t *records, uint32_t count, SLAS_LAZ_BUFFER *out)
+{
+  ByteStreamOutArrayLE stream;
+  LASwritePoint writer;
+
+
+  out->size = 0;
+
+
+  //  The writer puts the (placeholder) offset of the chunk table in front of the first chunk, we leave that off.
+
+  if (!writer.setup (laz->laszip->num_items, laz->laszip->items, laz->laszip) || !writer.init (&stream)) return (-1);
+
+  I64 start = stream.getCurr ();
+
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      point->copy_from (&records[(size_t) i * laz->record_length]);
+
+      if (!writer.write (point->point)) return (-1);
+    }
+
+  if (!writer.chunk ()) return (-1);
+
+
+  return (slas_laz_buffer_put (out, stream.getData () + start, stream.getCurr () - start));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_find_chunk
+
+ - Purpose:     Find the chunk a record is in.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - laz            =    SLAS_LAZ from slas_laz_read
+                - record         =    Record number
+
+ - Returns:     uint32_t         =    Chunk number (num_chunks if the record is past the
+                                      end of the file)
+
+*********************************************************************************************/
+
+uint32_t slas_laz_find_chunk (SLAS_LAZ *laz, uint64_t record)
+{
+  uint32_t low = 0, high = laz->num_chunks;
+
+
+  if (record >= laz->chunk_first[laz->num_chunks]) return (laz->num_chunks);
+
+  while (high - low > 1)
+    {
+      uint32_t mid = (low + high) / 2;
+
+      if (laz->chunk_first[mid] <= record)
+        {
+          low = mid;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  return (low);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_rewrite_flags
+
+ - Purpose:     Rebuild a layered chunk with new withheld bits.  The withheld bit of the
+                first (uncompressed) point is patched, the flags layer is encoded again
+                from the records the same way LASzip's v3 point compressor does it (one
+                set of models per scanner channel, each point coded against the last
+                flags seen in its channel), and the other layers are copied as they are.
+                Only the withheld bits are taken from records, everything else in the
+                flags layer has to be the same as what was decoded.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - laz            =    SLAS_LAZ from slas_laz_read
+                - chunk          =    The chunk as it is in the file
+                - size           =    Size of the chunk
+                - records        =    The chunk's records (decoded, at least the flags
+                                      layer) with the withheld bits set
+                - count          =    Number of records in the chunk
+                - out            =    Returned chunk (replaces what was in it)
+
+ - Returns:     int32_t          =    0 or -1 if the chunk isn't what we expected
+
+*********************************************************************************************/
+
+int32_t slas_laz_rewrite_flags (SLAS_LAZ *laz, const uint8_t *chunk, uint64_t size, const uint8_t *records, uint32_t count,
+                                SLAS_LAZ_BUFFER *out)
+{
+  uint32_t rl = laz->record_length, offset;
+  uint8_t  first[512], sizes[4 * 256];
+
+
+  out->size = 0;
+
+  if (!laz->layered || !count || rl > sizeof (first) || size < rl) return (-1);
+
+
+  //  The first point is stored as a plain record, only the withheld bit changes.
+
+  memcpy (first, chunk, rl);
+  first[15] = (first[15] & ~0x04) | (records[15] & 0x04);
+
+  if (slas_laz_buffer_put (out, first, rl)) return (-1);
+
+  if (size == rl) return (count == 1 ? 0 : -1);
+
+
+  //  Then the point count, the size of every layer, and the layers themselves.
+
+  uint32_t header = 4 + 4 * laz->num_layers;
+
+  if (laz->num_layers > 256 || size < rl + header || get_u32 (&chunk[rl]) != count) return (-1);
+
+  memcpy (sizes, &chunk[rl + 4], 4 * laz->num_layers);
+
+  uint64_t total = rl + header;
+  uint64_t flags_start = 0;
+
+  for (int32_t l = 0 ; l < laz->num_layers ; l++)
+    {
+      if (l == LAZ_FLAGS_LAYER) flags_start = total;
+      total += get_u32 (&sizes[4 * l]);
+    }
+
+  if (total != size) return (-1);
+
+  offset = rl + header;
+  uint64_t flags_end = flags_start + get_u32 (&sizes[4 * LAZ_FLAGS_LAYER]);
+
+
+  //  Each scanner channel (context) starts out with the flags of the point before its first point.  The layer is left
+  //  out (size 0) if no point's flags differ from the last ones in its channel.
+
+  ByteStreamOutArrayLE stream;
+  ArithmeticEncoder enc;
+  ArithmeticModel *models[4][64];
+  uint32_t last[4], previous = laz_flags (records[15]);
+  uint8_t used[4] = {NVFalse, NVFalse, NVFalse, NVFalse}, changed = NVFalse;
+
+  memset (models, 0, sizeof (models));
+
+  enc.init (&stream);
+
+  used[(records[15] >> 4) & 3] = NVTrue;
+  last[(records[15] >> 4) & 3] = previous;
+
+  for (uint32_t i = 1 ; i < count ; i++)
+    {
+      uint8_t byte = records[(size_t) i * rl + 15];
+      uint32_t channel = (byte >> 4) & 3, flags = laz_flags (byte);
+
+      if (!used[channel])
+        {
+          used[channel] = NVTrue;
+          last[channel] = previous;
+        }
+
+      if (flags != last[channel]) changed = NVTrue;
+
+      ArithmeticModel **model = &models[channel][last[channel]];
+
+      if (*model == NULL)
+        {
+          *model = enc.createSymbolModel (64);
+          enc.initSymbolModel (*model);
+        }
+
+      enc.encodeSymbol (*model, flags);
+
+      last[channel] = previous = flags;
+    }
+
+  enc.done ();
+
+  for (int32_t c = 0 ; c < 4 ; c++)
+    {
+      for (int32_t f = 0 ; f < 64 ; f++) if (models[c][f]) enc.destroySymbolModel (models[c][f]);
+    }
+
+  uint32_t flags_size = changed ? (uint32_t) stream.getCurr () : 0;
+
+  put_u32 (&sizes[4 * LAZ_FLAGS_LAYER], flags_size);
+
+
+  if (slas_laz_buffer_put (out, &chunk[rl], 4) || slas_laz_buffer_put (out, sizes, 4 * laz->num_layers) ||
+      slas_laz_buffer_put (out, &chunk[offset], flags_start - offset) ||
+      (flags_size && slas_laz_buffer_put (out, stream.getData (), flags_size)) ||
+      slas_laz_buffer_put (out, &chunk[flags_end], size - flags_end)) return (-1);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_chunk_table
+
+ - Purpose:     Build a chunk table (what goes after the last chunk and what the offset at
+                the start of the point data points to).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - laz            =    SLAS_LAZ (the point counts are only stored if the
+                                      chunk size is U32_MAX)
+                - points         =    Points in each chunk
+                - bytes          =    Size of each chunk
+                - num_chunks     =    Number of chunks
+                - table          =    Returned chunk table (replaces what was in it)
+
+ - Returns:     int32_t          =    0 or -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_laz_chunk_table (SLAS_LAZ *laz, const uint32_t *points, const uint64_t *bytes, uint32_t num_chunks, SLAS_LAZ_BUFFER *table)
+{
+  uint8_t head[8];
+
+
+  table->size = 0;
+
+  put_u32 (head, 0);
+  put_u32 (&head[4], num_chunks);
+
+  if (slas_laz_buffer_put (table, head, 8)) return (-1);
+
+  if (!num_chunks) return (0);
+
+
+  ByteStreamOutArrayLE stream;
+  ArithmeticEncoder enc;
+
+  enc.init (&stream);
+
+  IntegerCompressor ic (&enc, 32, 2);
+  ic.initCompressor ();
+
+  for (uint32_t c = 0 ; c < num_chunks ; c++)
+    {
+      if (bytes[c] > 0x7fffffff) return (-1);
+
+      if (laz->chunk_size == U32_MAX) ic.compress (c ? (I32) points[c - 1] : 0, (I32) points[c], 0);
+
+      ic.compress (c ? (I32) bytes[c - 1] : 0, (I32) bytes[c], 1);
+    }
+
+  enc.done ();
+
+
+  return (slas_laz_buffer_put (table, stream.getData (), stream.getCurr ()));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_buffer_put
+
+ - Purpose:     Append to an SLAS_LAZ_BUFFER (zero it before the first use).  If data is
+                NULL the room is added but not filled in.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - buffer         =    SLAS_LAZ_BUFFER
+                - data           =    Bytes to append
+                - size           =    Number of bytes
+
+ - Returns:     int32_t          =    0 or -1 if we ran out of memory
+
+*********************************************************************************************/
+
+int32_t slas_laz_buffer_put (SLAS_LAZ_BUFFER *buffer, const void *data, uint64_t size)
+{
+  if (buffer->size + size > buffer->alloc)
+    {
+      uint64_t alloc = buffer->alloc ? buffer->alloc : 65536;
+
+      while (alloc < buffer->size + size) alloc *= 2;
+
+      uint8_t *new_data = (uint8_t *) realloc (buffer->data, alloc);
+
+      if (new_data == NULL) return (-1);
+
+      buffer->data = new_data;
+      buffer->alloc = alloc;
+    }
+
+  if (size && data) memcpy (&buffer->data[buffer->size], data, size);
+
+  buffer->size += size;
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_buffer_free
+
+ - Purpose:     Free the memory of an SLAS_LAZ_BUFFER.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - buffer         =    SLAS_LAZ_BUFFER
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_laz_buffer_free (SLAS_LAZ_BUFFER *buffer)
+{
+  free (buffer->data);
+
+  memset (buffer, 0, sizeof (SLAS_LAZ_BUFFER));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_laz_free
+
+ - Purpose:     Free the memory allocated by slas_laz_read.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - laz            =    SLAS_LAZ
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_laz_free (SLAS_LAZ *laz)
+{
+  if (laz->laszip) delete laz->laszip;
+  free (laz->chunk_first);
+  free (laz->chunk_offset);
+
+  slas_memory_release (laz->memory, laz->reserved);
+
+  memset (laz, 0, sizeof (SLAS_LAZ));
+}
@@ -0,0 +1,97 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  LAZ chunk access.  LASzip compresses the points of a LAZ file in chunks (50000 points by default, one per octree
+    node in a COPC file) that don't depend on each other, and the chunk table after the last chunk gives the size of
+    each one.  For the LAS 1.4 point formats (6 through 10) each chunk is the first point (uncompressed) followed by
+    the rest of the points split into layers, one per field (or group of fields), each compressed on its own.  The
+    withheld bit lives in the flags layer so setting it only means re-encoding that one layer of the chunks that have
+    points to change, everything else is copied as is.  New LAZ files (archives) are put together the same way, each
+    chunk is compressed on its own (by whichever worker read the records) and the chunks are appended in order.  */
+
+#ifndef __SLAS_LAZ_HPP__
+#define __SLAS_LAZ_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <lasreader.hpp>
+#include "slas.hpp"
+#include "slas_memory.hpp"
+
+
+//!  Growable byte buffer (a chunk or a chunk table).
+
+typedef struct
+{
+  uint8_t                     *data;
+  uint64_t                    size;
+  uint64_t                    alloc;
+} SLAS_LAZ_BUFFER;
+
+
+typedef struct
+{
+  LASzip                      *laszip;                         //!<  Items and compressor from the laszip VLR
+  uint16_t                    record_length;
+  uint8_t                     layered;                         //!<  NVTrue for the LAS 1.4 layered compressor
+  int32_t                     num_layers;                      //!<  Layers in each chunk (layered only)
+  uint32_t                    chunk_size;                      //!<  Points per chunk (U32_MAX if they vary, like COPC)
+  uint32_t                    num_chunks;
+  uint64_t                    *chunk_first;                    //!<  First record of each chunk (num_chunks + 1, the last is the point count)
+  uint64_t                    *chunk_offset;                   //!<  File offset of each chunk (num_chunks + 1, the last is the chunk table)
+  uint64_t                    tail_offset;                     //!<  Where whatever follows the chunk table (EVLRs) starts (file size if nothing does)
+  SLAS_MEMORY                 *memory;                         //!<  Budget chunk_first and chunk_offset were reserved from (slas_laz_read)
+  uint64_t                    reserved;                        //!<  Bytes reserved from it
+} SLAS_LAZ;
+
+
+int32_t slas_laz_read (int32_t fd, LASheader *lasheader, SLAS_MEMORY *memory, SLAS_LAZ *laz);
+int32_t slas_laz_init (SLAS_LAZ *laz, uint8_t point_data_format, uint16_t record_length);
+int32_t slas_laz_vlr (SLAS_LAZ *laz, SLAS_LAZ_BUFFER *vlr);
+int32_t slas_laz_compress (SLAS_LAZ *laz, LASpoint *point, const uint8_t *records, uint32_t count, SLAS_LAZ_BUFFER *out);
+uint32_t slas_laz_find_chunk (SLAS_LAZ *laz, uint64_t record);
+int32_t slas_laz_rewrite_flags (SLAS_LAZ *laz, const uint8_t *chunk, uint64_t size, const uint8_t *records, uint32_t count, SLAS_LAZ_BUFFER *out);
+int32_t slas_laz_chunk_table (SLAS_LAZ *laz, const uint32_t *points, const uint64_t *bytes, uint32_t num_chunks, SLAS_LAZ_BUFFER *table);
+int32_t slas_laz_buffer_put (SLAS_LAZ_BUFFER *buffer, const void *data, uint64_t size);
+void slas_laz_buffer_free (SLAS_LAZ_BUFFER *buffer);
+void slas_laz_free (SLAS_LAZ *laz);
+
+
+#endif
@@ -0,0 +1,645 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_manifest.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#include <limits.h>
+#include <sys/stat.h>
+
+
+//  Absolute path (the manifest key).  If the file doesn't exist we just use the name we were given.
+
+static void manifest_key (const char *path, char *key)
+{
+#ifdef NVWIN3X
+  if (_fullpath (key, path, 1024) == NULL) strcpy (key, path);
+#else
+  char real[PATH_MAX];
+
+  if (realpath (path, real) == NULL || strlen (real) >= 1024)
+    {
+      strcpy (key, path);
+    }
+  else
+    {
+      strcpy (key, real);
+    }
+#endif
+}
+
+
+//  Size and modification time of a file.
+
+static int32_t file_stat (const char *path, uint64_t *size, int64_t *mtime)
+{
+  struct stat st;
+
+  if (stat (path, &st)) return (-1);
+
+  *size = st.st_size;
+
+#if defined (NVWIN3X)
+  *mtime = (int64_t) st.st_mtime * 1000000000;
+#elif defined (__APPLE__)
+  *mtime = (int64_t) st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+  *mtime = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+
+  return (0);
+}
+
+
+//  FNV-1a (a word at a time) of the first and last SLAS_MANIFEST_HASH_BYTES of the file.  The header and VLRs are
+//  almost always in the first block so any change to those (or to the size) gets caught along with changes to the
+//  start and end of the point data.
+
+static int32_t file_hash (const char *path, uint64_t size, uint64_t *hash)
+{
+  static const uint64_t prime = 0x100000001b3ULL;
+  uint64_t buffer[SLAS_MANIFEST_HASH_BYTES / 8];
+  uint64_t h = 0xcbf29ce484222325ULL ^ size;
+  int32_t fd;
+
+
+  if ((fd = open (path, O_RDONLY | O_BINARY)) < 0) return (-1);
+
+  for (int32_t pass = 0 ; pass < 2 ; pass++)
+    {
+      uint64_t bytes = qMin (size, (uint64_t) SLAS_MANIFEST_HASH_BYTES);
+      int64_t offset = pass ? size - bytes : 0;
+
+
+      //  Small files are completely covered by the first pass.
+
+      if (pass && size <= SLAS_MANIFEST_HASH_BYTES) break;
+
+      memset (buffer, 0, sizeof (buffer));
+
+      if (slas_pread (fd, buffer, bytes, offset))
+        {
+          close (fd);
+          return (-1);
+        }
+
+      for (uint32_t i = 0 ; i < (bytes + 7) / 8 ; i++) h = (h ^ buffer[i]) * prime;
+    }
+
+  close (fd);
+
+  *hash = h;
+
+  return (0);
+}
+
+
+//  Binary search for a key.  Returns the index if found, otherwise -(insertion point) - 1.
+
+static int32_t manifest_find (SLAS_MANIFEST *manifest, const char *key)
+{
+  int32_t low = 0, high = manifest->count - 1;
+
+  while (low <= high)
+    {
+      int32_t mid = (low + high) / 2;
+      int32_t cmp = strcmp (manifest->entries[mid].path, key);
+
+      if (!cmp) return (mid);
+
+      if (cmp < 0)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid - 1;
+        }
+    }
+
+  return (-low - 1);
+}
+
+
+static int32_t compare_entries (const void *a, const void *b)
+{
+  return (strcmp (((SLAS_MANIFEST_ENTRY *) a)->path, ((SLAS_MANIFEST_ENTRY *) b)->path));
+}
+
+
+static int32_t manifest_grow (SLAS_MANIFEST *manifest)
+{
+  if (manifest->count < manifest->allocated) return (0);
+
+  int32_t allocated = manifest->allocated ? manifest->allocated * 2 : 1024;
+  SLAS_MANIFEST_ENTRY *entries = (SLAS_MANIFEST_ENTRY *) realloc (manifest->entries, allocated * sizeof (SLAS_MANIFEST_ENTRY));
+
+  if (entries == NULL) return (-1);
+
+  manifest->entries = entries;
+  manifest->allocated = allocated;
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_manifest_params
+
+ - Purpose:     Build the rule parameter string that is stored with each manifest entry.
+                If this changes between runs every file gets processed again.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - options        =    SLAS_ZERO_OPTIONS for the run
+                - params         =    Returned parameter string
+                - size           =    Size of params
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_manifest_params (SLAS_ZERO_OPTIONS *options, char *params, int32_t size)
+{
+  int32_t len = snprintf (params, size, "threshold=%.9g", options->threshold);
+
+
+  //  A changed grid file has to force a rerun too.
+
+  if (options->grid && len < size) len += snprintf (&params[len], size - len, " grid=%s@%" PRId64, options->grid->file, options->grid->mtime);
+
+
+  //  So does a different selection.  The source ID map is too big to store so we store its hash.
+
+  if (options->selection.source_ids && len < size)
+    {
+      uint64_t h = 0xcbf29ce484222325ULL;
+
+      for (int32_t i = 0 ; i < 65536 / 8 ; i++) h = (h ^ options->selection.source_ids[i]) * 0x100000001b3ULL;
+
+      len += snprintf (&params[len], size - len, " sources=%016" PRIx64, h);
+    }
+
+  if (options->selection.time_range && len < size)
+    len += snprintf (&params[len], size - len, " time=%.17g:%.17g", options->selection.time_min, options->selection.time_max);
+
+
+  //  And different extra bytes rules.  Names can be 32 characters so these get hashed as well.
+
+  if (options->extra && options->extra->count && len < size)
+    {
+      uint64_t h = 0xcbf29ce484222325ULL;
+
+      for (int32_t i = 0 ; i < options->extra->count ; i++)
+        {
+          char rule[80];
+
+          snprintf (rule, sizeof (rule), "%s%c%.17g;", options->extra->name[i], options->extra->greater[i] ? '>' : '<', options->extra->value[i]);
+
+          for (char *c = rule ; *c ; c++) h = (h ^ (uint8_t) *c) * 0x100000001b3ULL;
+        }
+
+      len += snprintf (&params[len], size - len, " extra=%016" PRIx64, h);
+    }
+
+
+  //  Adding --sort (or --sort-index) to a run has to reorder files that were zeroed without it.  The
+  //  memory budget and thread count don't change the output so they aren't part of this.
+
+  if (options->sort && len < size)
+    len += snprintf (&params[len], size - len, " sort=1 sort_index=%d", options->sort->index_chunk ? 1 : 0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_manifest_open
+
+ - Purpose:     Load a manifest file.  A manifest that doesn't exist yet isn't an error, you
+                just get an empty one.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - manifest       =    The SLAS_MANIFEST
+                - file           =    Manifest file name
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_manifest_open (SLAS_MANIFEST *manifest, const char *file)
+{
+  FILE     *fp;
+  char     line[4096];
+
+
+  memset (manifest, 0, sizeof (SLAS_MANIFEST));
+
+  if (strlen (file) >= sizeof (manifest->file)) return (-1);
+
+  strcpy (manifest->file, file);
+
+
+  if ((fp = fopen (file, "r")) == NULL)
+    {
+      if (errno == ENOENT) return (0);
+
+      fprintf (stderr, "\nUnable to open manifest file %s : %s\n\n", file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  while (fgets (line, sizeof (line), fp))
+    {
+      SLAS_MANIFEST_ENTRY entry;
+      int32_t params_start, path_start;
+
+
+      if (line[0] == '#') continue;
+
+      memset (&entry, 0, sizeof (SLAS_MANIFEST_ENTRY));
+
+      if (sscanf (line, "%" SCNu64 "\t%" SCNd64 "\t%" SCNx64 "\t%" SCNu64 "\t%" SCNu64 "\t%" SCNu64 "\t%n", &entry.size, &entry.mtime,
+                  &entry.hash, &entry.records, &entry.withheld, &entry.already_withheld, &params_start) != 6) continue;
+
+
+      //  The last two fields are the parameters and the path (which may contain spaces).
+
+      char *tab = strchr (&line[params_start], '\t');
+      if (tab == NULL) continue;
+
+      *tab = 0;
+      path_start = tab - line + 1;
+
+      char *nl = strchr (&line[path_start], '\n');
+      if (nl) *nl = 0;
+
+
+      //  Then, for a file that was made from another one, the input's size, time, hash and name.
+
+      int32_t source_start = -1;
+
+      if ((tab = strchr (&line[path_start], '\t')) != NULL)
+        {
+          *tab = 0;
+
+          if (sscanf (tab + 1, "%" SCNu64 "\t%" SCNd64 "\t%" SCNx64 "\t%n", &entry.source_size, &entry.source_mtime, &entry.source_hash,
+                      &source_start) != 3 || source_start < 0) continue;
+
+          source_start += tab + 1 - line;
+        }
+
+      if (strlen (&line[params_start]) >= sizeof (entry.params) || strlen (&line[path_start]) >= sizeof (entry.path) ||
+          (source_start >= 0 && (!line[source_start] || strlen (&line[source_start]) >= sizeof (entry.source)))) continue;
+
+      strcpy (entry.params, &line[params_start]);
+      strcpy (entry.path, &line[path_start]);
+      if (source_start >= 0) strcpy (entry.source, &line[source_start]);
+
+
+      if (manifest_grow (manifest))
+        {
+          fclose (fp);
+          return (-1);
+        }
+
+      manifest->entries[manifest->count++] = entry;
+    }
+
+  fclose (fp);
+
+
+  //  It should already be sorted (that's how we write it) but somebody might have edited it.
+
+  if (manifest->count) qsort (manifest->entries, manifest->count, sizeof (SLAS_MANIFEST_ENTRY), compare_entries);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_manifest_up_to_date
+
+ - Purpose:     Check whether a file was already processed (successfully, with the same
+                parameters) and hasn't changed since.  This costs a stat and two small reads
+                for files that are in the manifest, and a binary search for those that
+                aren't.  If the file is made from another one (source) it also has to have
+                been made from the same file, and that has to be unchanged too.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - manifest       =    The SLAS_MANIFEST
+                - path           =    LAS or LAZ file name
+                - source         =    Input file that path is made from (--output or --archive),
+                                      NULL if path is processed in place
+                - params         =    Rule parameters (from slas_manifest_params)
+
+ - Returns:     uint8_t          =    NVTrue if the file can be skipped
+
+*********************************************************************************************/
+
+uint8_t slas_manifest_up_to_date (SLAS_MANIFEST *manifest, const char *path, const char *source, const char *params)
+{
+  char      key[1024], source_key[1024];
+  uint64_t  size, hash;
+  int64_t   mtime;
+  int32_t   index;
+
+
+  manifest_key (path, key);
+
+  if ((index = manifest_find (manifest, key)) < 0) return (NVFalse);
+
+  SLAS_MANIFEST_ENTRY *entry = &manifest->entries[index];
+
+  if (strcmp (entry->params, params)) return (NVFalse);
+
+  if (file_stat (path, &size, &mtime) || size != entry->size || mtime != entry->mtime) return (NVFalse);
+
+  if (file_hash (path, size, &hash) || hash != entry->hash) return (NVFalse);
+
+
+  //  A redelivered input (or a different one) means the file has to be made again.
+
+  if (source == NULL) return (!entry->source[0]);
+
+  manifest_key (source, source_key);
+
+  if (strcmp (entry->source, source_key)) return (NVFalse);
+
+  if (file_stat (source, &size, &mtime) || size != entry->source_size || mtime != entry->source_mtime) return (NVFalse);
+
+  if (file_hash (source, size, &hash) || hash != entry->source_hash) return (NVFalse);
+
+
+  return (NVTrue);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_manifest_update
+
+ - Purpose:     Record a successful run on a file.  This has to be called after the file has
+                been closed so we get its final size, time and hash.  The input it was made
+                from (if any) is recorded as it is now.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - manifest       =    The SLAS_MANIFEST
+                - path           =    LAS or LAZ file name
+                - source         =    Input file that path was made from (--output or --archive),
+                                      NULL if path was processed in place
+                - params         =    Rule parameters (from slas_manifest_params)
+                - stats          =    SLAS_ZERO_STATS from the run
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_manifest_update (SLAS_MANIFEST *manifest, const char *path, const char *source, const char *params, SLAS_ZERO_STATS *stats)
+{
+  SLAS_MANIFEST_ENTRY  entry;
+  int32_t              index;
+
+
+  memset (&entry, 0, sizeof (SLAS_MANIFEST_ENTRY));
+
+  if (strlen (params) >= sizeof (entry.params) || strchr (params, '\t') || strchr (params, '\n')) return (-1);
+
+  manifest_key (path, entry.path);
+  strcpy (entry.params, params);
+
+  if (strchr (entry.path, '\t') || strchr (entry.path, '\n')) return (-1);
+
+  if (file_stat (path, &entry.size, &entry.mtime) || file_hash (path, entry.size, &entry.hash)) return (-1);
+
+  if (source)
+    {
+      manifest_key (source, entry.source);
+
+      if (strchr (entry.source, '\t') || strchr (entry.source, '\n')) return (-1);
+
+      if (file_stat (source, &entry.source_size, &entry.source_mtime) || file_hash (source, entry.source_size, &entry.source_hash))
+        return (-1);
+    }
+
+  entry.records = stats->records;
+  entry.withheld = stats->withheld;
+  entry.already_withheld = stats->already_withheld;
+
+
+  if ((index = manifest_find (manifest, entry.path)) < 0)
+    {
+      if (manifest_grow (manifest)) return (-1);
+
+      index = -index - 1;
+
+      memmove (&manifest->entries[index + 1], &manifest->entries[index], (manifest->count - index) * sizeof (SLAS_MANIFEST_ENTRY));
+      manifest->count++;
+    }
+
+  manifest->entries[index] = entry;
+  manifest->modified++;
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_manifest_remove
+
+ - Purpose:     Forget about a file (so that it will be processed next time).  Call this when
+                a run on the file fails.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - manifest       =    The SLAS_MANIFEST
+                - path           =    LAS or LAZ file name
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_manifest_remove (SLAS_MANIFEST *manifest, const char *path)
+{
+  char     key[1024];
+  int32_t  index;
+
+
+  manifest_key (path, key);
+
+  if ((index = manifest_find (manifest, key)) < 0) return;
+
+  memmove (&manifest->entries[index], &manifest->entries[index + 1], (manifest->count - index - 1) * sizeof (SLAS_MANIFEST_ENTRY));
+  manifest->count--;
+  manifest->modified++;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_manifest_save
+
+ - Purpose:     Write the manifest out (to a temporary file that is then renamed so an
+                interrupted save never leaves a partial manifest).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - manifest       =    The SLAS_MANIFEST
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_manifest_save (SLAS_MANIFEST *manifest)
+{
+  FILE     *fp;
+  char     tmp_file[1100];
+
+
+  sprintf (tmp_file, "%s.tmp", manifest->file);
+
+  if ((fp = fopen (tmp_file, "w")) == NULL)
+    {
+      fprintf (stderr, "\nUnable to open manifest file %s : %s\n\n", tmp_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  fprintf (fp, "# las_zero manifest\n");
+  fprintf (fp, "# size\tmtime\thash\trecords\twithheld\talready\tparams\tpath[\tsource size\tsource mtime\tsource hash\tsource]\n");
+
+  for (int32_t i = 0 ; i < manifest->count ; i++)
+    {
+      SLAS_MANIFEST_ENTRY *entry = &manifest->entries[i];
+
+      fprintf (fp, "%" PRIu64 "\t%" PRId64 "\t%016" PRIx64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%s\t%s", entry->size, entry->mtime,
+               entry->hash, entry->records, entry->withheld, entry->already_withheld, entry->params, entry->path);
+
+      if (entry->source[0])
+        fprintf (fp, "\t%" PRIu64 "\t%" PRId64 "\t%016" PRIx64 "\t%s", entry->source_size, entry->source_mtime, entry->source_hash, entry->source);
+
+      fprintf (fp, "\n");
+    }
+
+
+  QFile::remove (QString (manifest->file));
+
+  if (fclose (fp) || !QFile::rename (QString (tmp_file), QString (manifest->file)))
+    {
+      QFile::remove (QString (tmp_file));
+
+      fprintf (stderr, "\nUnable to write manifest file %s\n\n", manifest->file);
+      fflush (stderr);
+      return (-1);
+    }
+
+  manifest->modified = 0;
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_manifest_close
+
+ - Purpose:     Free the manifest (this does not save it).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - manifest       =    The SLAS_MANIFEST
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_manifest_close (SLAS_MANIFEST *manifest)
+{
+  if (manifest->entries) free (manifest->entries);
+
+  manifest->entries = NULL;
+  manifest->count = manifest->allocated = 0;
+}
@@ -0,0 +1,105 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Incremental job manifest.  The manifest remembers, for every file that was successfully processed, its size,
+    modification time and a fast content hash (after we were done with it), the rule parameters that were used, and
+    what we did to it.  On the next run a file whose size, time, hash and parameters all still match can be skipped
+    without opening it as a LAS file at all.
+
+    The manifest is a plain text file, one line per file, tab separated (paths can contain anything but a tab or
+    newline):
+
+        size    mtime    hash    records    withheld    already    params    path
+
+    When the file was made from another one (--output or --archive) the input has to be unchanged as well, so its size,
+    modification time, hash and name follow the path:
+
+        size    mtime    hash    records    withheld    already    params    path    size    mtime    hash    source  */
+
+#ifndef __SLAS_MANIFEST_HPP__
+#define __SLAS_MANIFEST_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "slas_zero.hpp"
+
+
+//!  Number of bytes at the start and end of the file that go into the content hash.
+
+#define SLAS_MANIFEST_HASH_BYTES        65536
+
+
+typedef struct
+{
+  char                        path[1024];                      //!<  Absolute file name (the key)
+  uint64_t                    size;                            //!<  File size after the last run
+  int64_t                     mtime;                           //!<  Modification time (nanoseconds) after the last run
+  uint64_t                    hash;                            //!<  Header/content hash after the last run
+  uint64_t                    records;
+  uint64_t                    withheld;
+  uint64_t                    already_withheld;
+  char                        params[256];                     //!<  Rule parameters (see slas_manifest_params)
+  char                        source[1024];                    //!<  Absolute input file name (empty if the file was done in place)
+  uint64_t                    source_size;                     //!<  Input file size, time, and hash when the file was made
+  int64_t                     source_mtime;
+  uint64_t                    source_hash;
+} SLAS_MANIFEST_ENTRY;
+
+
+typedef struct
+{
+  char                        file[1024];                      //!<  Manifest file name
+  SLAS_MANIFEST_ENTRY         *entries;                        //!<  Sorted by path
+  int32_t                     count;
+  int32_t                     allocated;
+  int32_t                     modified;                        //!<  Number of updates since the last save
+} SLAS_MANIFEST;
+
+
+void slas_manifest_params (SLAS_ZERO_OPTIONS *options, char *params, int32_t size);
+int32_t slas_manifest_open (SLAS_MANIFEST *manifest, const char *file);
+uint8_t slas_manifest_up_to_date (SLAS_MANIFEST *manifest, const char *path, const char *source, const char *params);
+int32_t slas_manifest_update (SLAS_MANIFEST *manifest, const char *path, const char *source, const char *params, SLAS_ZERO_STATS *stats);
+void slas_manifest_remove (SLAS_MANIFEST *manifest, const char *path);
+int32_t slas_manifest_save (SLAS_MANIFEST *manifest);
+void slas_manifest_close (SLAS_MANIFEST *manifest);
+
+
+#endif
@@ -0,0 +1,168 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_memory.hpp"
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_memory_init
+
+ - Purpose:     Set up a memory budget.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - memory         =    The SLAS_MEMORY
+                - limit          =    Budget in bytes (0 = unlimited)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_memory_init (SLAS_MEMORY *memory, uint64_t limit)
+{
+  memory->limit = limit;
+  memory->used = 0;
+  memory->peak = 0;
+  memory->refused = 0;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_memory_available
+
+ - Purpose:     Get the number of bytes left in the budget.  Anyone can take it before you
+                get to slas_memory_reserve so check the return from that as well.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - memory         =    The SLAS_MEMORY (NULL means no budget)
+
+ - Returns:     uint64_t         =    Bytes available (UINT64_MAX if there's no limit)
+
+*********************************************************************************************/
+
+uint64_t slas_memory_available (SLAS_MEMORY *memory)
+{
+  if (memory == NULL || !memory->limit) return (UINT64_MAX);
+
+  QMutexLocker lock (&memory->mutex);
+
+  return (memory->used < memory->limit ? memory->limit - memory->used : 0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_memory_reserve
+
+ - Purpose:     Take bytes out of the budget.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - memory         =    The SLAS_MEMORY (NULL means no budget)
+                - bytes          =    Bytes to reserve
+
+ - Returns:     int32_t          =    0 if they were reserved, -1 if they don't fit
+
+*********************************************************************************************/
+
+int32_t slas_memory_reserve (SLAS_MEMORY *memory, uint64_t bytes)
+{
+  if (memory == NULL) return (0);
+
+  QMutexLocker lock (&memory->mutex);
+
+  if (memory->limit && (bytes > memory->limit || memory->used > memory->limit - bytes))
+    {
+      memory->refused++;
+      return (-1);
+    }
+
+  memory->used += bytes;
+  if (memory->used > memory->peak) memory->peak = memory->used;
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_memory_release
+
+ - Purpose:     Give bytes from slas_memory_reserve back to the budget.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - memory         =    The SLAS_MEMORY (NULL means no budget)
+                - bytes          =    Bytes to release
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_memory_release (SLAS_MEMORY *memory, uint64_t bytes)
+{
+  if (memory == NULL) return;
+
+  QMutexLocker lock (&memory->mutex);
+
+  memory->used = (bytes < memory->used) ? memory->used - bytes : 0;
+}
@@ -0,0 +1,73 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Process wide memory budget.  Everything that allocates a lot (block buffers, grid tile caches, QA statistics, the
+    sort buffers) reserves what it's going to use from the budget first, and sizes itself down (smaller blocks, fewer
+    cached tiles, fewer threads) when the whole thing doesn't fit.  The per file tables (the selection index, the COPC
+    nodes, the LAZ chunk table, the verification checksums) can't be made smaller so they're reserved as they're read
+    and released when they're freed.  That keeps a big run under a cgroup limit instead of having the kernel OOM killer
+    end it hours in.  The budget only covers those big allocations so it should be set a little below the real limit
+    to leave room for the program itself.  */
+
+#ifndef __SLAS_MEMORY_HPP__
+#define __SLAS_MEMORY_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <QtCore>
+
+
+typedef struct
+{
+  uint64_t                    limit;                           //!<  Budget in bytes (0 = unlimited)
+  uint64_t                    used;                            //!<  Bytes reserved right now
+  uint64_t                    peak;                            //!<  Most bytes ever reserved at once
+  uint64_t                    refused;                         //!<  Number of reservations that didn't fit
+  QMutex                      mutex;
+} SLAS_MEMORY;
+
+
+void slas_memory_init (SLAS_MEMORY *memory, uint64_t limit);
+uint64_t slas_memory_available (SLAS_MEMORY *memory);
+int32_t slas_memory_reserve (SLAS_MEMORY *memory, uint64_t bytes);
+void slas_memory_release (SLAS_MEMORY *memory, uint64_t bytes);
+
+
+#endif
@@ -0,0 +1,259 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_numa.hpp"
+
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+
+#ifdef __linux__
+
+//  Read a kernel CPU list ("0-15,32-47") into a bit map.  Returns the number of CPUs in it.
+
+static int32_t read_cpulist (const char *path, uint8_t *map)
+{
+  FILE *fp;
+  char line[4096], *ptr;
+  int32_t count = 0;
+
+
+  memset (map, 0, SLAS_NUMA_MAX_CPUS / 8);
+
+  if ((fp = fopen (path, "r")) == NULL) return (0);
+
+  if (fgets (line, sizeof (line), fp) == NULL) line[0] = 0;
+
+  fclose (fp);
+
+
+  ptr = line;
+
+  while (*ptr >= '0' && *ptr <= '9')
+    {
+      int32_t first = (int32_t) strtol (ptr, &ptr, 10), last = first;
+
+      if (*ptr == '-') last = (int32_t) strtol (ptr + 1, &ptr, 10);
+
+      for (int32_t cpu = first ; cpu <= last && cpu < SLAS_NUMA_MAX_CPUS ; cpu++)
+        {
+          if (!(map[cpu / 8] & (1 << (cpu % 8))))
+            {
+              map[cpu / 8] |= (1 << (cpu % 8));
+              count++;
+            }
+        }
+
+      if (*ptr == ',') ptr++;
+    }
+
+  return (count);
+}
+
+#endif
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_numa_init
+
+ - Purpose:     Find the NUMA nodes and the CPUs on each one that this process is allowed
+                to use.  Nodes with no usable CPUs (memory only nodes, or ones we've been
+                fenced off from by taskset or a cpuset) are left out.  If there's no NUMA
+                information there's one node with every usable CPU on it.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - numa           =    The SLAS_NUMA
+
+ - Returns:     int32_t          =    Number of nodes (always at least 1)
+
+*********************************************************************************************/
+
+int32_t slas_numa_init (SLAS_NUMA *numa)
+{
+  memset (numa, 0, sizeof (SLAS_NUMA));
+
+  numa->num_nodes = 1;
+
+
+#ifdef __linux__
+
+  cpu_set_t allowed;
+  DIR *dir;
+  struct dirent *entry;
+
+
+  CPU_ZERO (&allowed);
+
+  if (sched_getaffinity (0, sizeof (cpu_set_t), &allowed)) return (numa->num_nodes);
+
+
+  if ((dir = opendir ("/sys/devices/system/node")) == NULL) return (numa->num_nodes);
+
+  int32_t count = 0;
+
+  while ((entry = readdir (dir)) != NULL && count < SLAS_NUMA_MAX_NODES)
+    {
+      char path[512];
+      uint8_t *map = numa->cpus[count];
+
+      if (strncmp (entry->d_name, "node", 4) || entry->d_name[4] < '0' || entry->d_name[4] > '9') continue;
+
+      sprintf (path, "/sys/devices/system/node/%s/cpulist", entry->d_name);
+
+      if (!read_cpulist (path, map)) continue;
+
+
+      //  Keep only the CPUs we can actually run on.
+
+      int32_t cpus = 0;
+
+      for (int32_t cpu = 0 ; cpu < SLAS_NUMA_MAX_CPUS ; cpu++)
+        {
+          if (!(map[cpu / 8] & (1 << (cpu % 8)))) continue;
+
+          if (cpu < CPU_SETSIZE && CPU_ISSET (cpu, &allowed))
+            {
+              cpus++;
+            }
+          else
+            {
+              map[cpu / 8] &= ~(1 << (cpu % 8));
+            }
+        }
+
+      if (!cpus) continue;
+
+      numa->node[count] = atoi (&entry->d_name[4]);
+      numa->num_cpus[count] = cpus;
+      count++;
+    }
+
+  closedir (dir);
+
+
+  //  readdir doesn't give them to us in any particular order.
+
+  for (int32_t i = 1 ; i < count ; i++)
+    {
+      for (int32_t j = i ; j > 0 && numa->node[j] < numa->node[j - 1] ; j--)
+        {
+          int32_t node = numa->node[j], cpus = numa->num_cpus[j];
+          uint8_t map[SLAS_NUMA_MAX_CPUS / 8];
+
+          memcpy (map, numa->cpus[j], sizeof (map));
+
+          numa->node[j] = numa->node[j - 1];
+          numa->num_cpus[j] = numa->num_cpus[j - 1];
+          memcpy (numa->cpus[j], numa->cpus[j - 1], sizeof (map));
+
+          numa->node[j - 1] = node;
+          numa->num_cpus[j - 1] = cpus;
+          memcpy (numa->cpus[j - 1], map, sizeof (map));
+        }
+    }
+
+  if (count) numa->num_nodes = count;
+
+#endif
+
+
+  return (numa->num_nodes);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_numa_bind
+
+ - Purpose:     Keep the calling thread on the CPUs of one node.  Memory the thread touches
+                first after this (its buffers, and the page cache for what it reads) comes
+                from that node.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - numa           =    The SLAS_NUMA from slas_numa_init
+                - n              =    Node (0 through num_nodes - 1, not the kernel node number)
+
+ - Returns:     int32_t          =    0 on success, -1 if the thread couldn't be bound
+
+*********************************************************************************************/
+
+int32_t slas_numa_bind (SLAS_NUMA *numa, int32_t n)
+{
+  if (numa == NULL || n < 0 || n >= numa->num_nodes || numa->num_nodes < 2) return (-1);
+
+
+#ifdef __linux__
+
+  cpu_set_t set;
+
+  CPU_ZERO (&set);
+
+  for (int32_t cpu = 0 ; cpu < SLAS_NUMA_MAX_CPUS && cpu < CPU_SETSIZE ; cpu++)
+    {
+      if (numa->cpus[n][cpu / 8] & (1 << (cpu % 8))) CPU_SET (cpu, &set);
+    }
+
+  if (sched_setaffinity (0, sizeof (cpu_set_t), &set)) return (-1);
+
+  return (0);
+
+#else
+
+  return (-1);
+
+#endif
+}
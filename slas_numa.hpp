@@ -0,0 +1,70 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  NUMA node layout.  On a multi-socket machine each socket has its own memory and reaching the other socket's memory
+    costs a lot more, so a pass over a big file does better if its workers are spread evenly over the nodes, stay
+    there, and each one works on its own part of the file with buffers (and page cache) in local memory.  The layout
+    comes from /sys/devices/system/node (trimmed to the CPUs we're allowed to run on).  Anywhere that isn't Linux, or
+    on a machine with one node, there's just one node and binding does nothing.  */
+
+#ifndef __SLAS_NUMA_HPP__
+#define __SLAS_NUMA_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+
+#define SLAS_NUMA_MAX_NODES             16
+#define SLAS_NUMA_MAX_CPUS              1024
+
+
+typedef struct
+{
+  int32_t                     num_nodes;                       //!<  Nodes that have CPUs we can use (1 if not NUMA)
+  int32_t                     node[SLAS_NUMA_MAX_NODES];       //!<  Kernel node number
+  int32_t                     num_cpus[SLAS_NUMA_MAX_NODES];   //!<  Usable CPUs on the node
+  uint8_t                     cpus[SLAS_NUMA_MAX_NODES][SLAS_NUMA_MAX_CPUS / 8];  //!<  Bit map of the usable CPUs
+} SLAS_NUMA;
+
+
+int32_t slas_numa_init (SLAS_NUMA *numa);
+int32_t slas_numa_bind (SLAS_NUMA *numa, int32_t n);
+
+
+#endif
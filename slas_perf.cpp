@@ -0,0 +1,322 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_perf.hpp"
+
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#endif
+
+
+static const char *counter_name[SLAS_PERF_COUNTERS] = {"cycles", "instructions", "LLC misses", "context switches"};
+static const char *phase_name[SLAS_PERF_PHASES] = {"decode", "predicate", "write back"};
+
+
+#ifdef __linux__
+
+static int32_t open_counter (uint32_t type, uint64_t config)
+{
+  struct perf_event_attr attr;
+
+  memset (&attr, 0, sizeof (attr));
+  attr.size = sizeof (attr);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+
+  //  This thread only, any CPU.
+
+  return ((int32_t) syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+#endif
+
+
+//  Read all of the counters and charge the difference since the last read to the current phase.
+
+static void charge (SLAS_PERF_THREAD *perf)
+{
+  int64_t now = perf->timer.nsecsElapsed ();
+
+  if (perf->phase >= 0) perf->counts.seconds[perf->phase] += (double) (now - perf->last_time) / 1.0e9;
+  perf->last_time = now;
+
+#ifdef __linux__
+  for (int32_t i = 0 ; i < SLAS_PERF_COUNTERS ; i++)
+    {
+      uint64_t value;
+
+      if (perf->fd[i] < 0 || read (perf->fd[i], &value, sizeof (value)) != sizeof (value)) continue;
+
+      if (perf->phase >= 0) perf->counts.value[perf->phase][i] += value - perf->last[i];
+      perf->last[i] = value;
+    }
+#endif
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_perf_init_counts
+
+ - Purpose:     Clear a set of profile counts before a run.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - counts         =    The SLAS_PERF_COUNTS
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_perf_init_counts (SLAS_PERF_COUNTS *counts)
+{
+  memset (counts, 0, sizeof (SLAS_PERF_COUNTS));
+
+  for (int32_t i = 0 ; i < SLAS_PERF_COUNTERS ; i++) counts->available[i] = 1;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_perf_start
+
+ - Purpose:     Open the hardware counters for the calling thread.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - perf           =    The SLAS_PERF_THREAD for this thread
+
+ - Returns:     int32_t          =    Number of counters that could be opened (0 is not an
+                                      error, you still get the phase times)
+
+*********************************************************************************************/
+
+int32_t slas_perf_start (SLAS_PERF_THREAD *perf)
+{
+  int32_t available = 0;
+
+
+  memset (&perf->counts, 0, sizeof (SLAS_PERF_COUNTS));
+
+  for (int32_t i = 0 ; i < SLAS_PERF_COUNTERS ; i++)
+    {
+      perf->fd[i] = -1;
+      perf->last[i] = 0;
+    }
+
+#ifdef __linux__
+  perf->fd[SLAS_PERF_CYCLES] = open_counter (PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  perf->fd[SLAS_PERF_INSTRUCTIONS] = open_counter (PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  perf->fd[SLAS_PERF_LLC_MISSES] = open_counter (PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  perf->fd[SLAS_PERF_CONTEXT_SWITCHES] = open_counter (PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+#endif
+
+  for (int32_t i = 0 ; i < SLAS_PERF_COUNTERS ; i++)
+    {
+      perf->counts.available[i] = (perf->fd[i] >= 0);
+      available += perf->counts.available[i];
+    }
+
+  perf->phase = -1;
+  perf->timer.start ();
+  perf->last_time = 0;
+
+  charge (perf);
+
+
+  return (available);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_perf_phase
+
+ - Purpose:     Switch the calling thread to a new phase.  Everything counted since the last
+                switch is charged to the old phase.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - perf           =    The SLAS_PERF_THREAD for this thread (NULL if we're not
+                                      profiling)
+                - phase          =    New phase (SLAS_PERF_DECODE, etc., -1 for none)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_perf_phase (SLAS_PERF_THREAD *perf, int32_t phase)
+{
+  if (perf == NULL || phase == perf->phase) return;
+
+  charge (perf);
+
+  perf->phase = phase;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_perf_stop
+
+ - Purpose:     Close the calling thread's counters and add its counts to the totals.  The
+                caller has to serialize calls that share a total.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - perf           =    The SLAS_PERF_THREAD for this thread
+                - total          =    The SLAS_PERF_COUNTS to add to
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_perf_stop (SLAS_PERF_THREAD *perf, SLAS_PERF_COUNTS *total)
+{
+  slas_perf_phase (perf, -1);
+
+  for (int32_t i = 0 ; i < SLAS_PERF_COUNTERS ; i++)
+    {
+#ifdef __linux__
+      if (perf->fd[i] >= 0) close (perf->fd[i]);
+#endif
+      perf->fd[i] = -1;
+
+      if (!perf->counts.available[i]) total->available[i] = 0;
+    }
+
+  for (int32_t p = 0 ; p < SLAS_PERF_PHASES ; p++)
+    {
+      for (int32_t i = 0 ; i < SLAS_PERF_COUNTERS ; i++) total->value[p][i] += perf->counts.value[p][i];
+      total->seconds[p] += perf->counts.seconds[p];
+    }
+
+  total->points += perf->counts.points;
+  total->threads++;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_perf_report
+
+ - Purpose:     Print the profile, per million points for each phase.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - fp             =    Where to print it
+                - counts         =    The SLAS_PERF_COUNTS
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_perf_report (FILE *fp, SLAS_PERF_COUNTS *counts)
+{
+  double scale = counts->points ? 1.0e6 / (double) counts->points : 0.0;
+
+
+  fprintf (fp, "Profile (%" PRIu64 " points, %d thread(s), counts per million points):\n\n", counts->points, counts->threads);
+
+  fprintf (fp, "%-12s %14s", "phase", "thread sec");
+  for (int32_t i = 0 ; i < SLAS_PERF_COUNTERS ; i++) fprintf (fp, " %16s", counter_name[i]);
+  fprintf (fp, " %8s\n", "IPC");
+
+  for (int32_t p = 0 ; p < SLAS_PERF_PHASES ; p++)
+    {
+      fprintf (fp, "%-12s %14.4f", phase_name[p], counts->seconds[p]);
+
+      for (int32_t i = 0 ; i < SLAS_PERF_COUNTERS ; i++)
+        {
+          if (counts->available[i])
+            {
+              fprintf (fp, " %16.1f", (double) counts->value[p][i] * scale);
+            }
+          else
+            {
+              fprintf (fp, " %16s", "n/a");
+            }
+        }
+
+      if (counts->available[SLAS_PERF_CYCLES] && counts->available[SLAS_PERF_INSTRUCTIONS] && counts->value[p][SLAS_PERF_CYCLES])
+        {
+          fprintf (fp, " %8.2f\n", (double) counts->value[p][SLAS_PERF_INSTRUCTIONS] / (double) counts->value[p][SLAS_PERF_CYCLES]);
+        }
+      else
+        {
+          fprintf (fp, " %8s\n", "n/a");
+        }
+    }
+
+  fprintf (fp, "\n");
+  fflush (fp);
+}
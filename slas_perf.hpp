@@ -0,0 +1,101 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Hardware counter profiling.  Each worker thread opens its own set of perf_event_open counters (cycles, instructions,
+    last level cache misses, and context switches) and the counts are charged to whichever phase of the pass the thread
+    is in (decode, predicate, or write back).  Counters that can't be opened (no PMU in a VM, perf_event_paranoid set
+    too high, not Linux) are just marked as unavailable, the rest (and the phase times) are still reported.  */
+
+#ifndef __SLAS_PERF_HPP__
+#define __SLAS_PERF_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <QtCore>
+
+
+//!  Phases.
+
+#define SLAS_PERF_DECODE                0                       //!<  Reading the records and decoding X/Y/grid thresholds
+#define SLAS_PERF_PREDICATE             1                       //!<  Testing the points and setting the withheld bits
+#define SLAS_PERF_WRITE                 2                       //!<  Writing changed records back
+#define SLAS_PERF_PHASES                3
+
+
+//!  Counters.
+
+#define SLAS_PERF_CYCLES                0
+#define SLAS_PERF_INSTRUCTIONS          1
+#define SLAS_PERF_LLC_MISSES            2
+#define SLAS_PERF_CONTEXT_SWITCHES      3
+#define SLAS_PERF_COUNTERS              4
+
+
+typedef struct
+{
+  uint64_t                    value[SLAS_PERF_PHASES][SLAS_PERF_COUNTERS];
+  double                      seconds[SLAS_PERF_PHASES];
+  uint8_t                     available[SLAS_PERF_COUNTERS];   //!<  Counter could be opened (by every thread)
+  uint64_t                    points;                          //!<  Points processed
+  int32_t                     threads;                         //!<  Threads that reported
+} SLAS_PERF_COUNTS;
+
+
+//!  Per thread counter state.
+
+typedef struct
+{
+  int32_t                     fd[SLAS_PERF_COUNTERS];          //!<  -1 if the counter isn't available
+  uint64_t                    last[SLAS_PERF_COUNTERS];
+  int64_t                     last_time;
+  int32_t                     phase;                           //!<  Current phase (-1 for none)
+  SLAS_PERF_COUNTS            counts;
+  QElapsedTimer               timer;
+} SLAS_PERF_THREAD;
+
+
+void slas_perf_init_counts (SLAS_PERF_COUNTS *counts);
+int32_t slas_perf_start (SLAS_PERF_THREAD *perf);
+void slas_perf_phase (SLAS_PERF_THREAD *perf, int32_t phase);
+void slas_perf_stop (SLAS_PERF_THREAD *perf, SLAS_PERF_COUNTS *total);
+void slas_perf_report (FILE *fp, SLAS_PERF_COUNTS *counts);
+
+
+#endif
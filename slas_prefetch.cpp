@@ -0,0 +1,297 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <lasreader.hpp>
+
+#include "slas.hpp"
+#include "slas_prefetch.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#include <sys/stat.h>
+
+#ifndef NVWIN3X
+#include <fcntl.h>
+#endif
+
+
+class prefetch_worker;
+
+
+typedef struct
+{
+  char                        **files;
+  int32_t                     count;
+  int32_t                     depth;
+  uint64_t                    lead_bytes;
+  const uint8_t               *skip;                           //!<  Files that won't be processed (optional)
+  int32_t                     current;                         //!<  File the main thread is working on
+  int32_t                     next;                            //!<  Next file to prefetch
+  uint8_t                     shutdown;
+  QMutex                      mutex;
+  QWaitCondition              wait;
+  prefetch_worker             *worker;
+} PREFETCH_STATE;
+
+
+//  Open the file, read the header, and get the kernel started on the header, VLRs and the first lead_bytes of points
+//  (or less if the file is smaller).  Returns the number of bytes we asked for.  None of this is charged to the throttle,
+//  the pass is charged when it reads the same bytes (out of the cache, if we got there first) so counting them here
+//  would count them twice.
+
+static uint64_t prefetch_file (const char *path, uint64_t lead_bytes)
+{
+  LASheader    lasheader;
+  struct stat  st;
+  int32_t      fd;
+  uint64_t     bytes = 0;
+
+
+  if ((fd = open (path, O_RDONLY | O_BINARY)) < 0) return (0);
+
+  if (!slas_read_header (fd, &lasheader, NULL) && !fstat (fd, &st))
+    {
+      bytes = qMin ((uint64_t) lasheader.offset_to_point_data + lead_bytes, (uint64_t) st.st_size);
+
+#if defined (POSIX_FADV_WILLNEED) && !defined (NVWIN3X)
+      posix_fadvise (fd, 0, (off_t) bytes, POSIX_FADV_WILLNEED);
+#else
+
+      //  No fadvise so we just read it (into a small buffer, it's the OS cache we're after).
+
+      uint8_t buffer[65536];
+
+      for (uint64_t pos = 0 ; pos < bytes ; pos += sizeof (buffer))
+        {
+          if (read (fd, buffer, sizeof (buffer)) <= 0) break;
+        }
+#endif
+    }
+
+  close (fd);
+
+  return (bytes);
+}
+
+
+class prefetch_worker : public QThread
+{
+public:
+
+  SLAS_PREFETCH *prefetch;
+
+protected:
+
+  void run ()
+  {
+    PREFETCH_STATE *state = (PREFETCH_STATE *) prefetch->state;
+
+
+    state->mutex.lock ();
+
+    while (!state->shutdown)
+      {
+        //  Files that are going to be skipped don't get prefetched or take up room in the look-ahead window.
+
+        while (state->skip && state->next < state->count && state->skip[state->next]) state->next++;
+
+
+        //  Wait until the next file is inside the look-ahead window.
+
+        int32_t ahead = 0;
+
+        for (int32_t i = qMax (state->current + 1, 0) ; i < state->next ; i++)
+          {
+            if (!state->skip || !state->skip[i]) ahead++;
+          }
+
+        if (state->next >= state->count || ahead >= state->depth)
+          {
+            state->wait.wait (&state->mutex);
+            continue;
+          }
+
+        int32_t file = state->next++;
+
+        if (file <= state->current) continue;
+
+        state->mutex.unlock ();
+
+        uint64_t bytes = prefetch_file (state->files[file], state->lead_bytes);
+
+        state->mutex.lock ();
+
+        prefetch->files++;
+        prefetch->bytes += bytes;
+      }
+
+    state->mutex.unlock ();
+  }
+};
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_prefetch_start
+
+ - Purpose:     Start the prefetch thread for a list of files.  Nothing is prefetched until
+                slas_prefetch_advance says which file we're on.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - prefetch       =    The SLAS_PREFETCH
+                - files          =    File names (must stay around until slas_prefetch_stop)
+                - count          =    Number of files
+                - depth          =    Number of files to look ahead
+                - lead_bytes     =    Bytes of point data to prefetch from each file
+                - skip           =    Optional per file flags, files that have it set won't be
+                                      processed so they aren't prefetched (must stay around
+                                      until slas_prefetch_stop)
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_prefetch_start (SLAS_PREFETCH *prefetch, char **files, int32_t count, int32_t depth, uint64_t lead_bytes,
+                             const uint8_t *skip)
+{
+  memset (prefetch, 0, sizeof (SLAS_PREFETCH));
+
+  if (depth <= 0 || count <= 1) return (0);
+
+  PREFETCH_STATE *state = new PREFETCH_STATE;
+
+  state->files = files;
+  state->count = count;
+  state->depth = depth;
+  state->lead_bytes = lead_bytes;
+  state->skip = skip;
+  state->current = -1;
+  state->next = 0;
+  state->shutdown = NVFalse;
+
+  prefetch->state = state;
+
+  state->worker = new prefetch_worker;
+  state->worker->prefetch = prefetch;
+  state->worker->start ();
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_prefetch_advance
+
+ - Purpose:     Tell the prefetch thread which file we're starting on.  It will prefetch the
+                depth files after it.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - prefetch       =    The SLAS_PREFETCH
+                - current        =    Index of the file we're starting on
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_prefetch_advance (SLAS_PREFETCH *prefetch, int32_t current)
+{
+  PREFETCH_STATE *state = (PREFETCH_STATE *) prefetch->state;
+
+  if (state == NULL) return;
+
+  QMutexLocker lock (&state->mutex);
+
+  state->current = current;
+  if (state->next <= current) state->next = current + 1;
+
+  state->wait.wakeAll ();
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_prefetch_stop
+
+ - Purpose:     Stop the prefetch thread and free everything.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - prefetch       =    The SLAS_PREFETCH
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_prefetch_stop (SLAS_PREFETCH *prefetch)
+{
+  PREFETCH_STATE *state = (PREFETCH_STATE *) prefetch->state;
+
+  if (state == NULL) return;
+
+  state->mutex.lock ();
+  state->shutdown = NVTrue;
+  state->wait.wakeAll ();
+  state->mutex.unlock ();
+
+  state->worker->wait ();
+
+  delete state->worker;
+  delete state;
+
+  prefetch->state = NULL;
+}
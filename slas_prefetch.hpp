@@ -0,0 +1,73 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Look-ahead for batch runs.  While we're working on file i a background thread opens the next few files, reads their
+    headers, and asks the kernel to start reading the first part of their point data (posix_fadvise WILLNEED) so that
+    when we get to them the open, header read, and first blocks don't have to wait on the disk (or the network).  The
+    look-ahead is bounded by a number of files and a number of bytes per file so it can't push the file we're working on
+    out of the cache.  */
+
+#ifndef __SLAS_PREFETCH_HPP__
+#define __SLAS_PREFETCH_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+
+//!  Default number of files to look ahead and bytes of point data to prefetch from each one.
+
+#define SLAS_PREFETCH_DEPTH             2
+#define SLAS_PREFETCH_BYTES             16777216
+
+
+typedef struct
+{
+  void                        *state;                          //!<  Prefetch thread and its queue (internal)
+  uint64_t                    files;                           //!<  Files prefetched so far
+  uint64_t                    bytes;                           //!<  Bytes requested so far
+} SLAS_PREFETCH;
+
+
+int32_t slas_prefetch_start (SLAS_PREFETCH *prefetch, char **files, int32_t count, int32_t depth, uint64_t lead_bytes,
+                             const uint8_t *skip);
+void slas_prefetch_advance (SLAS_PREFETCH *prefetch, int32_t current);
+void slas_prefetch_stop (SLAS_PREFETCH *prefetch);
+
+
+#endif
@@ -0,0 +1,425 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_qa.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#include <math.h>
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_qa_init
+
+ - Purpose:     Set up an SLAS_QA for a file.  The Z histogram covers z_min to z_max (normally
+                the header min and max Z) in SLAS_QA_Z_BINS bins.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - qa             =    The SLAS_QA
+                - ctx            =    SLAS_CONTEXT of the file
+                - z_min          =    Low end of the Z histogram
+                - z_max          =    High end of the Z histogram
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_qa_init (SLAS_QA *qa, SLAS_CONTEXT *ctx, double z_min, double z_max)
+{
+  memset (qa, 0, sizeof (SLAS_QA));
+
+  qa->z_min = z_min;
+  qa->z_max = z_max;
+
+  qa->x_scale_factor = ctx->x_scale_factor;
+  qa->y_scale_factor = ctx->y_scale_factor;
+  qa->z_scale_factor = ctx->z_scale_factor;
+  qa->x_offset = ctx->x_offset;
+  qa->y_offset = ctx->y_offset;
+  qa->z_offset = ctx->z_offset;
+
+
+  //  Binning is done on the raw integers so the per record work is a subtract, a multiply, and a divide.
+
+  qa->raw_low = (int64_t) floor ((z_min - ctx->z_offset) / ctx->z_scale_factor);
+  int64_t raw_high = (int64_t) ceil ((z_max - ctx->z_offset) / ctx->z_scale_factor);
+
+  qa->raw_span = raw_high - qa->raw_low + 1;
+  if (qa->raw_span < 1) qa->raw_span = 1;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_qa_clear
+
+ - Purpose:     Zero the counts of an SLAS_QA but keep its setup.  This is used to start the
+                per thread copies.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - qa             =    The SLAS_QA
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_qa_clear (SLAS_QA *qa)
+{
+  qa->records = 0;
+  qa->withheld = 0;
+  qa->z_under = 0;
+  qa->z_over = 0;
+
+  memset (qa->z_bins, 0, sizeof (qa->z_bins));
+  memset (qa->classification, 0, sizeof (qa->classification));
+  memset (qa->returns, 0, sizeof (qa->returns));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_qa_accumulate
+
+ - Purpose:     Add a buffer of raw point records to the statistics.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - qa             =    The SLAS_QA
+                - ctx            =    SLAS_CONTEXT of the file
+                - buffer         =    Point records
+                - count          =    Number of records in buffer
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_qa_accumulate (SLAS_QA *qa, SLAS_CONTEXT *ctx, const uint8_t *buffer, uint32_t count)
+{
+  uint8_t extended = (ctx->point_data_format > 5);
+  uint8_t class_mask = extended ? 0xff : 0x1f;
+  int16_t class_offset = ctx->classification_offset;
+  int16_t flags_offset = ctx->flags_offset;
+  uint8_t withheld_mask = ctx->withheld_mask;
+
+
+  if (!count) return;
+
+  if (!qa->records)
+    {
+      int32_t xyz[3];
+
+      memcpy (xyz, buffer, 12);
+
+      if (ctx->swap)
+        {
+          swap_int (&xyz[0]);
+          swap_int (&xyz[1]);
+          swap_int (&xyz[2]);
+        }
+
+      qa->min_x = qa->max_x = xyz[0];
+      qa->min_y = qa->max_y = xyz[1];
+      qa->min_z = qa->max_z = xyz[2];
+    }
+
+
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      const uint8_t *data = &buffer[(size_t) i * ctx->record_length];
+      int32_t x, y, z;
+
+      memcpy (&x, &data[0], 4);
+      memcpy (&y, &data[4], 4);
+      memcpy (&z, &data[8], 4);
+
+      if (ctx->swap)
+        {
+          swap_int (&x);
+          swap_int (&y);
+          swap_int (&z);
+        }
+
+      if (x < qa->min_x) qa->min_x = x;
+      if (x > qa->max_x) qa->max_x = x;
+      if (y < qa->min_y) qa->min_y = y;
+      if (y > qa->max_y) qa->max_y = y;
+      if (z < qa->min_z) qa->min_z = z;
+      if (z > qa->max_z) qa->max_z = z;
+
+
+      int64_t offset = (int64_t) z - qa->raw_low;
+
+      if (offset < 0)
+        {
+          qa->z_under++;
+        }
+      else if (offset >= qa->raw_span)
+        {
+          qa->z_over++;
+        }
+      else
+        {
+          qa->z_bins[(offset * SLAS_QA_Z_BINS) / qa->raw_span]++;
+        }
+
+
+      qa->classification[data[class_offset] & class_mask]++;
+
+
+      //  Return number and number of returns are 3 bits each in the old formats and 4 bits each in the new ones.
+
+      uint8_t returns = data[14];
+
+      if (extended)
+        {
+          qa->returns[returns >> 4][returns & 0x0f]++;
+        }
+      else
+        {
+          qa->returns[(returns >> 3) & 0x07][returns & 0x07]++;
+        }
+
+      if (data[flags_offset] & withheld_mask) qa->withheld++;
+    }
+
+  qa->records += count;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_qa_merge
+
+ - Purpose:     Add the counts from a per thread SLAS_QA to the file's SLAS_QA.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - qa             =    The file's SLAS_QA
+                - thread_qa      =    A thread's SLAS_QA
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_qa_merge (SLAS_QA *qa, SLAS_QA *thread_qa)
+{
+  if (!thread_qa->records) return;
+
+  if (!qa->records)
+    {
+      qa->min_x = thread_qa->min_x;
+      qa->min_y = thread_qa->min_y;
+      qa->min_z = thread_qa->min_z;
+      qa->max_x = thread_qa->max_x;
+      qa->max_y = thread_qa->max_y;
+      qa->max_z = thread_qa->max_z;
+    }
+  else
+    {
+      qa->min_x = qMin (qa->min_x, thread_qa->min_x);
+      qa->min_y = qMin (qa->min_y, thread_qa->min_y);
+      qa->min_z = qMin (qa->min_z, thread_qa->min_z);
+      qa->max_x = qMax (qa->max_x, thread_qa->max_x);
+      qa->max_y = qMax (qa->max_y, thread_qa->max_y);
+      qa->max_z = qMax (qa->max_z, thread_qa->max_z);
+    }
+
+  qa->records += thread_qa->records;
+  qa->withheld += thread_qa->withheld;
+  qa->z_under += thread_qa->z_under;
+  qa->z_over += thread_qa->z_over;
+
+  for (int32_t i = 0 ; i < SLAS_QA_Z_BINS ; i++) qa->z_bins[i] += thread_qa->z_bins[i];
+  for (int32_t i = 0 ; i < 256 ; i++) qa->classification[i] += thread_qa->classification[i];
+
+  for (int32_t i = 0 ; i < 16 ; i++)
+    {
+      for (int32_t j = 0 ; j < 16 ; j++) qa->returns[i][j] += thread_qa->returns[i][j];
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_qa_write
+
+ - Purpose:     Write the statistics to a JSON sidecar file.  Only non-zero classification
+                and return counts are written.  The file is written to a temporary name
+                and renamed so a reader never sees half of one.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - qa             =    The SLAS_QA
+                - path           =    Sidecar file name
+                - las_file       =    LAS/LAZ file name (goes in the sidecar)
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_qa_write (SLAS_QA *qa, const char *path, const char *las_file)
+{
+  FILE     *fp;
+  char     tmp_file[1100];
+  int32_t  first;
+
+
+  if (strlen (path) >= 1024) return (-1);
+
+  sprintf (tmp_file, "%s.tmp", path);
+
+  if ((fp = fopen (tmp_file, "w")) == NULL)
+    {
+      fprintf (stderr, "\nUnable to open QA file %s : %s\n\n", tmp_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  //  The file name goes in as is except for the characters JSON needs escaped.
+
+  fprintf (fp, "{\n  \"file\": \"");
+
+  for (const char *c = las_file ; *c ; c++)
+    {
+      if (*c == '"' || *c == '\\')
+        {
+          fprintf (fp, "\\%c", *c);
+        }
+      else if ((uint8_t) *c < 0x20)
+        {
+          fprintf (fp, "\\u%04x", (uint8_t) *c);
+        }
+      else
+        {
+          fputc (*c, fp);
+        }
+    }
+
+  fprintf (fp, "\",\n  \"records\": %" PRIu64 ",\n  \"withheld\": %" PRIu64 ",\n", qa->records, qa->withheld);
+
+  if (qa->records)
+    {
+      fprintf (fp, "  \"bounds\": [%.*f, %.*f, %.*f, %.*f, %.*f, %.*f],\n",
+               9, (double) qa->min_x * qa->x_scale_factor + qa->x_offset, 9, (double) qa->min_y * qa->y_scale_factor + qa->y_offset,
+               9, (double) qa->min_z * qa->z_scale_factor + qa->z_offset, 9, (double) qa->max_x * qa->x_scale_factor + qa->x_offset,
+               9, (double) qa->max_y * qa->y_scale_factor + qa->y_offset, 9, (double) qa->max_z * qa->z_scale_factor + qa->z_offset);
+    }
+
+
+  fprintf (fp, "  \"z_histogram\": {\"min\": %.9f, \"max\": %.9f, \"under\": %" PRIu64 ", \"over\": %" PRIu64 ", \"bins\": [",
+           qa->z_min, qa->z_max, qa->z_under, qa->z_over);
+
+  for (int32_t i = 0 ; i < SLAS_QA_Z_BINS ; i++) fprintf (fp, "%s%" PRIu64, i ? "," : "", qa->z_bins[i]);
+
+  fprintf (fp, "]},\n  \"classification\": {");
+
+  first = NVTrue;
+
+  for (int32_t i = 0 ; i < 256 ; i++)
+    {
+      if (!qa->classification[i]) continue;
+
+      fprintf (fp, "%s\"%d\": %" PRIu64, first ? "" : ", ", i, qa->classification[i]);
+      first = NVFalse;
+    }
+
+
+  //  Return counts are [number of returns, return number, count] triples.
+
+  fprintf (fp, "},\n  \"returns\": [");
+
+  first = NVTrue;
+
+  for (int32_t i = 0 ; i < 16 ; i++)
+    {
+      for (int32_t j = 0 ; j < 16 ; j++)
+        {
+          if (!qa->returns[i][j]) continue;
+
+          fprintf (fp, "%s[%d, %d, %" PRIu64 "]", first ? "" : ", ", i, j, qa->returns[i][j]);
+          first = NVFalse;
+        }
+    }
+
+  fprintf (fp, "]\n}\n");
+
+
+  QFile::remove (QString (path));
+
+  if (fclose (fp) || !QFile::rename (QString (tmp_file), QString (path)))
+    {
+      QFile::remove (QString (tmp_file));
+
+      fprintf (stderr, "\nError writing QA file %s\n\n", path);
+      fflush (stderr);
+      return (-1);
+    }
+
+  return (0);
+}
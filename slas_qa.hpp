@@ -0,0 +1,95 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  QA statistics gathered during the zeroing pass.  Each worker thread accumulates its own SLAS_QA for the records it
+    reads (from the raw record bytes, after the withheld bit has been set) and the thread results are added together
+    at the end of the pass, so the statistics cost one extra loop over data that is already in cache rather than another
+    read of the file.  slas_qa_write puts them in a small JSON sidecar file.  */
+
+#ifndef __SLAS_QA_HPP__
+#define __SLAS_QA_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <lasreader.hpp>
+#include "slas.hpp"
+
+
+//!  Number of Z histogram bins (between the header min and max Z).
+
+#define SLAS_QA_Z_BINS                  256
+
+
+typedef struct
+{
+  double                      z_min;                           //!<  Histogram range (from the header)
+  double                      z_max;
+  int64_t                     raw_low;                         //!<  Histogram range as raw Z integers
+  int64_t                     raw_span;
+  double                      x_scale_factor;                  //!<  Used to convert the raw bounds
+  double                      y_scale_factor;
+  double                      z_scale_factor;
+  double                      x_offset;
+  double                      y_offset;
+  double                      z_offset;
+  uint64_t                    records;
+  uint64_t                    withheld;                        //!<  Records withheld after the pass (ours and ones that already were)
+  int32_t                     min_x;                           //!<  Raw bounds
+  int32_t                     min_y;
+  int32_t                     min_z;
+  int32_t                     max_x;
+  int32_t                     max_y;
+  int32_t                     max_z;
+  uint64_t                    z_under;                         //!<  Records below the histogram range
+  uint64_t                    z_over;                          //!<  Records above the histogram range
+  uint64_t                    z_bins[SLAS_QA_Z_BINS];
+  uint64_t                    classification[256];
+  uint64_t                    returns[16][16];                 //!<  [number of returns][return number]
+} SLAS_QA;
+
+
+void slas_qa_init (SLAS_QA *qa, SLAS_CONTEXT *ctx, double z_min, double z_max);
+void slas_qa_clear (SLAS_QA *qa);
+void slas_qa_accumulate (SLAS_QA *qa, SLAS_CONTEXT *ctx, const uint8_t *buffer, uint32_t count);
+void slas_qa_merge (SLAS_QA *qa, SLAS_QA *thread_qa);
+int32_t slas_qa_write (SLAS_QA *qa, const char *path, const char *las_file);
+
+
+#endif
@@ -0,0 +1,332 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_shard.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+
+static int32_t compare_names (const void *a, const void *b)
+{
+  return (strcmp (*(char **) a, *(char **) b));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shard_parse
+
+ - Purpose:     Parse a shard specification of the form I/N (shard I of N, 0 <= I < N).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - spec           =    The shard specification string
+                - shard          =    Returned shard number
+                - shards         =    Returned number of shards
+
+ - Returns:     int32_t          =    0 on success, -1 on a bad specification
+
+*********************************************************************************************/
+
+int32_t slas_shard_parse (const char *spec, int32_t *shard, int32_t *shards)
+{
+  char junk;
+
+  if (sscanf (spec, "%d/%d%c", shard, shards, &junk) != 2 || *shards < 1 || *shard < 0 || *shard >= *shards) return (-1);
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shard_files
+
+ - Purpose:     Work out which files in a batch belong to a shard.  The list is sorted (so
+                every shard sees the same order no matter how the shell expanded the
+                arguments) and shard I gets files I, I + N, I + 2N, ...
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - count          =    Number of files
+                - files          =    The file names.  This is sorted in place and this shard's
+                                      files are moved to the front of it.
+                - shard          =    Shard number
+                - shards         =    Number of shards
+
+ - Returns:     int32_t          =    Number of files (at the front of files) that belong to
+                                      this shard
+
+*********************************************************************************************/
+
+int32_t slas_shard_files (int32_t count, char **files, int32_t shard, int32_t shards)
+{
+  int32_t selected = 0;
+
+
+  qsort (files, count, sizeof (char *), compare_names);
+
+  for (int32_t i = shard ; i < count ; i += shards)
+    {
+      char *name = files[i];
+
+      memmove (&files[selected + 1], &files[selected], (i - selected) * sizeof (char *));
+      files[selected++] = name;
+    }
+
+
+  return (selected);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shard_range
+
+ - Purpose:     Work out the range of records in a single LAS file that belong to a shard.
+                The point data is split into N roughly equal byte ranges, each boundary is
+                pulled back to a page boundary, and the shard starts at the first record
+                that begins at or after that page boundary.  The ranges never overlap and
+                always cover the whole file (a record that straddles a page boundary goes
+                to the shard below it).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - offset_to_point_data =  Byte offset of the first point record
+                - record_length  =    Point record length
+                - number_of_points =  Number of point records in the file
+                - shard          =    Shard number
+                - shards         =    Number of shards
+                - first          =    Returned first record
+                - count          =    Returned number of records (may be 0 for small files)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+static uint64_t shard_boundary (uint64_t offset_to_point_data, uint32_t record_length, uint64_t number_of_points, int32_t shard,
+                                int32_t shards)
+{
+  if (shard <= 0) return (0);
+  if (shard >= shards) return (number_of_points);
+
+
+  //  Do the split in records first (so a huge file can't overflow the multiply) then convert to a byte position.
+
+  uint64_t split = number_of_points / shards * shard + (number_of_points % shards) * shard / shards;
+  uint64_t page = (offset_to_point_data + split * record_length) & ~((uint64_t) SLAS_SHARD_PAGE_SIZE - 1);
+
+  if (page <= offset_to_point_data) return (0);
+
+  uint64_t record = (page - offset_to_point_data + record_length - 1) / record_length;
+
+  return (qMin (record, number_of_points));
+}
+
+
+void slas_shard_range (uint64_t offset_to_point_data, uint32_t record_length, uint64_t number_of_points, int32_t shard, int32_t shards,
+                       uint64_t *first, uint64_t *count)
+{
+  *first = shard_boundary (offset_to_point_data, record_length, number_of_points, shard, shards);
+  *count = shard_boundary (offset_to_point_data, record_length, number_of_points, shard + 1, shards) - *first;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shard_file_range
+
+ - Purpose:     Open a LAS file and get the range of records that belongs to a shard (see
+                slas_shard_range).  LAZ files can't be split so shard 0 gets all of the
+                records and the rest get none.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - path           =    LAS or LAZ file name
+                - shard          =    Shard number
+                - shards         =    Number of shards
+                - first          =    Returned first record
+                - count          =    Returned number of records
+
+ - Returns:     int32_t          =    SLAS_ZERO_SUCCESS or one of the SLAS_ZERO error codes
+
+*********************************************************************************************/
+
+int32_t slas_shard_file_range (const char *path, int32_t shard, int32_t shards, uint64_t *first, uint64_t *count)
+{
+  LASheader     lasheader;
+  SLAS_CONTEXT  ctx;
+  int32_t       fd, status = SLAS_ZERO_SUCCESS;
+  uint8_t       compressed;
+
+
+  *first = *count = 0;
+
+  if ((fd = open (path, O_RDONLY | O_BINARY)) < 0) return (SLAS_ZERO_OPEN_ERROR);
+
+  if (slas_read_header (fd, &lasheader, &compressed))
+    {
+      status = SLAS_ZERO_HEADER_ERROR;
+    }
+  else if (compressed)
+    {
+      if (!shard)
+        {
+          *count = lasheader.number_of_point_records;
+          if (lasheader.version_minor >= 4 && lasheader.extended_number_of_point_records) *count = lasheader.extended_number_of_point_records;
+        }
+    }
+  else if (slas_init_context (&ctx, fd, &lasheader, big_endian ()))
+    {
+      status = SLAS_ZERO_FORMAT_ERROR;
+    }
+  else
+    {
+      slas_shard_range (ctx.offset_to_point_data, ctx.record_length, ctx.number_of_points, shard, shards, first, count);
+    }
+
+  close (fd);
+
+
+  return (status);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shard_write_record
+
+ - Purpose:     Write a shard completion record.  This is a small text file that looks like
+
+                <pre>
+                las_zero shard 3/40 threshold 0.000000
+                file /data/t1.las first=0 records=1000000 withheld=10 already=0 status=0
+                ...
+                complete files=2 errors=0
+                </pre>
+
+                It's written to a temporary name and renamed so a coordinator will never see
+                a partial record.  The "complete" line is always last.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - record_file    =    Completion record file name
+                - shard          =    Shard number
+                - shards         =    Number of shards
+                - threshold      =    Threshold that was used
+                - count          =    Number of entries
+                - entries        =    One SLAS_SHARD_ENTRY per file processed
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_shard_write_record (const char *record_file, int32_t shard, int32_t shards, float threshold, int32_t count,
+                                 SLAS_SHARD_ENTRY *entries)
+{
+  FILE     *fp;
+  int32_t  errors = 0;
+  char     tmp_file[1100];
+
+
+  if (strlen (record_file) >= 1024) return (-1);
+
+  sprintf (tmp_file, "%s.tmp", record_file);
+
+  if ((fp = fopen (tmp_file, "w")) == NULL)
+    {
+      fprintf (stderr, "\nUnable to open shard record file %s : %s\n\n", tmp_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  fprintf (fp, "las_zero shard %d/%d threshold %f\n", shard, shards, threshold);
+
+  for (int32_t i = 0 ; i < count ; i++)
+    {
+      fprintf (fp, "file %s first=%" PRIu64 " records=%" PRIu64 " withheld=%" PRIu64 " already=%" PRIu64 " status=%d\n", entries[i].path,
+               entries[i].first_record, entries[i].num_records, entries[i].stats.withheld, entries[i].stats.already_withheld, entries[i].status);
+
+      if (entries[i].status) errors++;
+    }
+
+  fprintf (fp, "complete files=%d errors=%d\n", count, errors);
+
+
+  QFile::remove (QString (record_file));
+
+  if (fclose (fp) || !QFile::rename (QString (tmp_file), QString (record_file)))
+    {
+      QFile::remove (QString (tmp_file));
+
+      fprintf (stderr, "\nUnable to write shard record file %s\n\n", record_file);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  return (0);
+}
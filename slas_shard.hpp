@@ -0,0 +1,87 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Deterministic sharding of a batch run across several processes (or machines sharing a file system).  Every shard
+    is given the same file list and its own shard number (I/N) and works out for itself what it owns, so there is no
+    coordinator process needed to hand out work.
+
+    - With more than one file the list is sorted and shard I gets every Nth file starting with the Ith.
+    - With one (LAS) file the records are split into N non-overlapping ranges whose boundaries fall on the first
+      record that starts at or after a page boundary, so no two shards write into the same page of the file.  LAZ
+      files can't be split so shard 0 gets the whole thing.
+
+    Each shard writes a small completion record (see slas_shard_write_record) that a coordinator can check to make sure
+    every file (or every record range) was covered.  */
+
+#ifndef __SLAS_SHARD_HPP__
+#define __SLAS_SHARD_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "slas_zero.hpp"
+
+
+//!  Page size that record range boundaries are aligned to.
+
+#define SLAS_SHARD_PAGE_SIZE            4096
+
+
+//!  One line of a shard completion record.
+
+typedef struct
+{
+  char                        path[1024];                      //!<  File name
+  uint64_t                    first_record;                    //!<  First record processed
+  uint64_t                    num_records;                     //!<  Number of records processed
+  int32_t                     status;                          //!<  SLAS_ZERO status
+  SLAS_ZERO_STATS             stats;
+} SLAS_SHARD_ENTRY;
+
+
+int32_t slas_shard_parse (const char *spec, int32_t *shard, int32_t *shards);
+int32_t slas_shard_files (int32_t count, char **files, int32_t shard, int32_t shards);
+void slas_shard_range (uint64_t offset_to_point_data, uint32_t record_length, uint64_t number_of_points, int32_t shard, int32_t shards,
+                       uint64_t *first, uint64_t *count);
+int32_t slas_shard_file_range (const char *path, int32_t shard, int32_t shards, uint64_t *first, uint64_t *count);
+int32_t slas_shard_write_record (const char *record_file, int32_t shard, int32_t shards, float threshold, int32_t count,
+                                 SLAS_SHARD_ENTRY *entries);
+
+
+#endif
@@ -0,0 +1,658 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_sort.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#include <algorithm>
+
+
+typedef struct
+{
+  uint64_t                    key;                             //!<  Morton key
+  uint32_t                    index;                           //!<  Record number within the run
+} SORT_KEY;
+
+
+static inline bool key_less (const SORT_KEY &a, const SORT_KEY &b)
+{
+  if (a.key != b.key) return (a.key < b.key);
+  return (a.index < b.index);
+}
+
+
+//  Spread the 32 bits of v out to the even bits of a 64 bit word.
+
+static inline uint64_t spread_bits (uint32_t v)
+{
+  uint64_t x = v;
+
+  x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+  x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+  x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  x = (x | (x << 2)) & 0x3333333333333333ULL;
+  x = (x | (x << 1)) & 0x5555555555555555ULL;
+
+  return (x);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_morton_key
+
+ - Purpose:     Morton (Z order) key of the raw integer X and Y of a point record.  The
+                sign bit is flipped so that negative coordinates sort before positive ones.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - x              =    Raw X from the point record
+                - y              =    Raw Y from the point record
+
+ - Returns:     uint64_t         =    The key
+
+*********************************************************************************************/
+
+uint64_t slas_morton_key (int32_t x, int32_t y)
+{
+  return (spread_bits ((uint32_t) x ^ 0x80000000) | (spread_bits ((uint32_t) y ^ 0x80000000) << 1));
+}
+
+
+static inline void record_xy (SLAS_CONTEXT *ctx, const uint8_t *data, int32_t *x, int32_t *y)
+{
+  memcpy (x, &data[0], 4);
+  memcpy (y, &data[4], 4);
+
+  if (ctx->swap)
+    {
+      swap_int (x);
+      swap_int (y);
+    }
+}
+
+
+static inline uint64_t record_key (SLAS_CONTEXT *ctx, const uint8_t *data)
+{
+  int32_t x, y;
+
+  record_xy (ctx, data, &x, &y);
+
+  return (slas_morton_key (x, y));
+}
+
+
+//  Each thread sorts one slice of the keys, then the slices are merged pairwise.
+
+class sort_worker : public QThread
+{
+public:
+
+  SORT_KEY *first, *last;
+
+protected:
+
+  void run ()
+  {
+    std::sort (first, last, key_less);
+  }
+};
+
+
+static void sort_keys (SORT_KEY *keys, uint32_t count, int32_t threads)
+{
+  if (threads <= 0) threads = QThread::idealThreadCount ();
+  if (threads < 1) threads = 1;
+
+
+  //  Not worth starting threads for small runs.
+
+  if (threads == 1 || count < 65536)
+    {
+      std::sort (keys, keys + count, key_less);
+      return;
+    }
+
+
+  sort_worker *workers = new sort_worker[threads];
+  uint32_t *bounds = new uint32_t[threads + 1];
+
+  for (int32_t i = 0 ; i <= threads ; i++) bounds[i] = (uint32_t) (((uint64_t) count * i) / threads);
+
+  for (int32_t i = 0 ; i < threads ; i++)
+    {
+      workers[i].first = keys + bounds[i];
+      workers[i].last = keys + bounds[i + 1];
+      workers[i].start ();
+    }
+
+  for (int32_t i = 0 ; i < threads ; i++) workers[i].wait ();
+
+
+  for (int32_t width = 1 ; width < threads ; width *= 2)
+    {
+      for (int32_t i = 0 ; i + width < threads ; i += 2 * width)
+        {
+          int32_t end = i + 2 * width;
+          if (end > threads) end = threads;
+
+          std::inplace_merge (keys + bounds[i], keys + bounds[i + width], keys + bounds[end], key_less);
+        }
+    }
+
+  delete[] bounds;
+  delete[] workers;
+}
+
+
+//  Copy length bytes starting at offset in the input file to the current position in the output file.
+
+static int32_t copy_bytes (int32_t fd, int64_t offset, int64_t length, FILE *out)
+{
+  uint8_t buffer[65536];
+
+  while (length > 0)
+    {
+      size_t size = length > (int64_t) sizeof (buffer) ? sizeof (buffer) : (size_t) length;
+
+      if (slas_pread (fd, buffer, size, offset) || fwrite (buffer, size, 1, out) != 1) return (-1);
+
+      offset += size;
+      length -= size;
+    }
+
+  return (0);
+}
+
+
+//  Spatial chunk index bookkeeping.  Bounds are kept as raw integers and converted when the index is written.
+
+typedef struct
+{
+  uint32_t                    chunk;                           //!<  Records per chunk (0 = no index)
+  uint64_t                    chunks;
+  uint64_t                    count;                           //!<  Records seen so far
+  int32_t                     *bounds;                         //!<  min X, min Y, max X, max Y per chunk
+} SORT_INDEX;
+
+
+static inline void index_record (SLAS_CONTEXT *ctx, SORT_INDEX *index, const uint8_t *data)
+{
+  if (!index->chunk) return;
+
+  int32_t x, y;
+  record_xy (ctx, data, &x, &y);
+
+  int32_t *b = &index->bounds[(index->count / index->chunk) * 4];
+
+  if (!(index->count % index->chunk))
+    {
+      b[0] = b[2] = x;
+      b[1] = b[3] = y;
+    }
+  else
+    {
+      if (x < b[0]) b[0] = x;
+      if (y < b[1]) b[1] = y;
+      if (x > b[2]) b[2] = x;
+      if (y > b[3]) b[3] = y;
+    }
+
+  index->count++;
+}
+
+
+static int32_t write_index (SLAS_CONTEXT *ctx, SORT_INDEX *index, const char *file)
+{
+  FILE     *fp;
+  char     tmp_file[1100];
+  uint32_t bom = 0x01020304;
+
+
+  sprintf (tmp_file, "%s.tmp", file);
+
+  if ((fp = fopen (tmp_file, "wb")) == NULL)
+    {
+      fprintf (stderr, "\nUnable to open spatial index file %s : %s\n\n", tmp_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+  int32_t status = (fwrite ("SLASSBX1", 8, 1, fp) != 1 || fwrite (&bom, 4, 1, fp) != 1 || fwrite (&index->chunk, 4, 1, fp) != 1 ||
+                    fwrite (&index->chunks, 8, 1, fp) != 1);
+
+  for (uint64_t i = 0 ; i < index->chunks && !status ; i++)
+    {
+      int32_t *b = &index->bounds[i * 4];
+      double   v[4];
+
+      v[0] = (double) b[0] * ctx->x_scale_factor + ctx->x_offset;
+      v[1] = (double) b[1] * ctx->y_scale_factor + ctx->y_offset;
+      v[2] = (double) b[2] * ctx->x_scale_factor + ctx->x_offset;
+      v[3] = (double) b[3] * ctx->y_scale_factor + ctx->y_offset;
+
+      if (fwrite (v, sizeof (v), 1, fp) != 1) status = -1;
+    }
+
+  if (fclose (fp)) status = -1;
+
+  if (status)
+    {
+      QFile::remove (QString (tmp_file));
+
+      fprintf (stderr, "\nError writing spatial index file %s\n\n", tmp_file);
+      fflush (stderr);
+      return (-1);
+    }
+
+  QFile::remove (QString (file));
+
+  if (!QFile::rename (QString (tmp_file), QString (file)))
+    {
+      QFile::remove (QString (tmp_file));
+
+      fprintf (stderr, "\nUnable to rename %s to %s\n\n", tmp_file, file);
+      fflush (stderr);
+      return (-1);
+    }
+
+  return (0);
+}
+
+
+//  One run file being merged.
+
+typedef struct
+{
+  FILE                        *fp;
+  uint8_t                     *record;                         //!<  Current (smallest unmerged) record of the run
+  uint64_t                    key;
+  uint64_t                    left;                            //!<  Records not yet read from the run file
+} SORT_RUN;
+
+
+static inline bool run_greater (SORT_RUN *runs, int32_t a, int32_t b)
+{
+  if (runs[a].key != runs[b].key) return (runs[a].key > runs[b].key);
+  return (a > b);
+}
+
+
+static void sift_down (SORT_RUN *runs, int32_t *heap, int32_t count, int32_t pos)
+{
+  for (;;)
+    {
+      int32_t child = 2 * pos + 1;
+      if (child >= count) break;
+
+      if (child + 1 < count && run_greater (runs, heap[child], heap[child + 1])) child++;
+
+      if (!run_greater (runs, heap[pos], heap[child])) break;
+
+      int32_t tmp = heap[pos];
+      heap[pos] = heap[child];
+      heap[child] = tmp;
+
+      pos = child;
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_sort_file
+
+ - Purpose:     Rewrite the point records of an uncompressed LAS file in Morton order of
+                their X/Y.  The sort uses at most about options->memory MB of memory for
+                records and keys.  When there are more points than that it sorts runs that
+                fit, writes them to temporary run files next to the LAS file, and merges
+                the runs.  Points with the same key stay in their original order.  The
+                sorted copy replaces the LAS file when it is complete.  If
+                index_file is set, the X/Y bounds of each options->index_chunk
+                records of the sorted file are written to index_file.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - las_file       =    Uncompressed LAS file
+                - options        =    SLAS_SORT_OPTIONS
+                - index_file     =    Spatial chunk index file or NULL
+
+ - Returns:     int32_t          =    0 on success, -1 on error (messages go to stderr)
+
+*********************************************************************************************/
+
+int32_t slas_sort_file (const char *las_file, SLAS_SORT_OPTIONS *options, const char *index_file)
+{
+  LASheader     lasheader;
+  SLAS_CONTEXT  ctx;
+  int32_t       fd, status = 0, nruns = 0;
+  char          out_file[1100], run_file[1100];
+  FILE          *out = NULL;
+  uint8_t       *records = NULL, *sorted = NULL;
+  SORT_KEY      *keys = NULL;
+  SORT_RUN      *runs = NULL;
+  int32_t       *heap = NULL;
+  SORT_INDEX    index;
+
+
+  memset (&index, 0, sizeof (SORT_INDEX));
+
+  if (strlen (las_file) >= 1024) return (-1);
+
+  if ((fd = open (las_file, O_RDONLY | O_BINARY)) < 0)
+    {
+      fprintf (stderr, "\nUnable to open %s : %s\n\n", las_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+  if (slas_read_header (fd, &lasheader, NULL) || slas_init_context (&ctx, fd, &lasheader, big_endian ()))
+    {
+      fprintf (stderr, "\nUnable to read the header of %s\n\n", las_file);
+      fflush (stderr);
+      close (fd);
+      return (-1);
+    }
+
+
+  uint64_t points = ctx.number_of_points;
+  uint32_t length = ctx.record_length;
+  int64_t data_end = ctx.offset_to_point_data + (int64_t) (points * length);
+  int64_t file_size = lseek (fd, 0, SEEK_END);
+
+  if (file_size < data_end)
+    {
+      fprintf (stderr, "\n%s is shorter than its point records\n\n", las_file);
+      fflush (stderr);
+      close (fd);
+      return (-1);
+    }
+
+
+  //  Records per run.  Each record costs its own length in the read buffer and the sorted buffer plus its key.
+
+  uint64_t budget = (uint64_t) (options->memory ? options->memory : SLAS_SORT_MEMORY) * 1048576;
+  uint64_t per_run = budget / (2 * (uint64_t) length + sizeof (SORT_KEY));
+
+  if (per_run < 1) per_run = 1;
+  if (per_run > points) per_run = points;
+  if (per_run > 0x7fffffff) per_run = 0x7fffffff;
+
+  nruns = points ? (int32_t) ((points + per_run - 1) / per_run) : 0;
+
+
+  if (index_file != NULL && options->index_chunk && points)
+    {
+      index.chunk = options->index_chunk;
+      index.chunks = (points + index.chunk - 1) / index.chunk;
+
+      if ((index.bounds = (int32_t *) malloc ((size_t) index.chunks * 4 * sizeof (int32_t))) == NULL) status = -1;
+    }
+
+
+  if (!status && points)
+    {
+      records = (uint8_t *) malloc ((size_t) per_run * length);
+      sorted = (uint8_t *) malloc ((size_t) per_run * length);
+      keys = (SORT_KEY *) malloc ((size_t) per_run * sizeof (SORT_KEY));
+      runs = (SORT_RUN *) calloc (nruns, sizeof (SORT_RUN));
+      heap = (int32_t *) malloc (nruns * sizeof (int32_t));
+
+      if (records == NULL || sorted == NULL || keys == NULL || runs == NULL || heap == NULL) status = -1;
+    }
+
+  if (status)
+    {
+      fprintf (stderr, "\nUnable to allocate memory for sorting %s\n\n", las_file);
+      fflush (stderr);
+    }
+
+
+  sprintf (out_file, "%s.sort", las_file);
+
+  if (!status && (out = fopen (out_file, "wb")) == NULL)
+    {
+      fprintf (stderr, "\nUnable to open %s : %s\n\n", out_file, strerror (errno));
+      fflush (stderr);
+      status = -1;
+    }
+
+
+  //  Header and VLRs go across unchanged.
+
+  if (!status && copy_bytes (fd, 0, ctx.offset_to_point_data, out)) status = -1;
+
+
+  //  Sort each run.  If there's only one run it goes straight to the output file.
+
+  for (int32_t r = 0 ; r < nruns && !status ; r++)
+    {
+      uint64_t first = (uint64_t) r * per_run;
+      uint32_t count = (uint32_t) (points - first < per_run ? points - first : per_run);
+
+      if (slas_ctx_read_records (&ctx, first, count, records))
+        {
+          status = -1;
+          break;
+        }
+
+      for (uint32_t i = 0 ; i < count ; i++)
+        {
+          keys[i].key = record_key (&ctx, &records[(size_t) i * length]);
+          keys[i].index = i;
+        }
+
+      sort_keys (keys, count, options->threads);
+
+      for (uint32_t i = 0 ; i < count ; i++) memcpy (&sorted[(size_t) i * length], &records[(size_t) keys[i].index * length], length);
+
+
+      if (nruns == 1)
+        {
+          for (uint32_t i = 0 ; i < count ; i++) index_record (&ctx, &index, &sorted[(size_t) i * length]);
+
+          if (fwrite (sorted, (size_t) count * length, 1, out) != 1) status = -1;
+        }
+      else
+        {
+          sprintf (run_file, "%s.run%d", las_file, r);
+
+          if ((runs[r].fp = fopen (run_file, "w+b")) == NULL)
+            {
+              fprintf (stderr, "\nUnable to open %s : %s\n\n", run_file, strerror (errno));
+              fflush (stderr);
+              status = -1;
+              break;
+            }
+
+          if (fwrite (sorted, (size_t) count * length, 1, runs[r].fp) != 1 || fflush (runs[r].fp))
+            {
+              status = -1;
+              break;
+            }
+
+          runs[r].left = count;
+        }
+    }
+
+
+  //  Merge the runs.  The sort buffers aren't needed any more so they're split up for the run records and file buffers.
+
+  if (!status && nruns > 1)
+    {
+      free (keys);
+      keys = NULL;
+      free (sorted);
+      sorted = NULL;
+
+      size_t buffer_size = (size_t) ((per_run * length) / (nruns + 1));
+      if (buffer_size < 65536) buffer_size = 65536;
+
+      free (records);
+
+      if ((records = (uint8_t *) malloc ((size_t) nruns * length)) == NULL)
+        {
+          fprintf (stderr, "\nUnable to allocate memory for sorting %s\n\n", las_file);
+          fflush (stderr);
+          status = -1;
+        }
+
+      int32_t count = 0;
+
+      for (int32_t r = 0 ; r < nruns && !status ; r++)
+        {
+          runs[r].record = &records[(size_t) r * length];
+
+          rewind (runs[r].fp);
+          setvbuf (runs[r].fp, NULL, _IOFBF, buffer_size);
+
+          if (fread (runs[r].record, length, 1, runs[r].fp) != 1)
+            {
+              status = -1;
+              break;
+            }
+
+          runs[r].left--;
+          runs[r].key = record_key (&ctx, runs[r].record);
+          heap[count++] = r;
+        }
+
+      setvbuf (out, NULL, _IOFBF, buffer_size);
+
+      for (int32_t i = count / 2 - 1 ; i >= 0 ; i--) sift_down (runs, heap, count, i);
+
+
+      while (count && !status)
+        {
+          SORT_RUN *run = &runs[heap[0]];
+
+          index_record (&ctx, &index, run->record);
+
+          if (fwrite (run->record, length, 1, out) != 1)
+            {
+              status = -1;
+              break;
+            }
+
+          if (run->left)
+            {
+              if (fread (run->record, length, 1, run->fp) != 1)
+                {
+                  status = -1;
+                  break;
+                }
+
+              run->left--;
+              run->key = record_key (&ctx, run->record);
+            }
+          else
+            {
+              heap[0] = heap[--count];
+            }
+
+          sift_down (runs, heap, count, 0);
+        }
+    }
+
+
+  //  Waveform packets and EVLRs go across unchanged.  The point data area is the same size so their offsets are still
+  //  good.
+
+  if (!status && copy_bytes (fd, data_end, file_size - data_end, out)) status = -1;
+
+  if (out != NULL && fclose (out)) status = -1;
+
+  close (fd);
+
+
+  for (int32_t r = 0 ; r < nruns && runs != NULL ; r++)
+    {
+      if (runs[r].fp != NULL)
+        {
+          fclose (runs[r].fp);
+
+          sprintf (run_file, "%s.run%d", las_file, r);
+          QFile::remove (QString (run_file));
+        }
+    }
+
+  free (heap);
+  free (runs);
+  free (keys);
+  free (sorted);
+  free (records);
+
+
+  if (!status)
+    {
+      if (!QFile::remove (QString (las_file)) || !QFile::rename (QString (out_file), QString (las_file)))
+        {
+          fprintf (stderr, "\nUnable to replace %s with %s\n\n", las_file, out_file);
+          fflush (stderr);
+          status = -1;
+        }
+    }
+  else
+    {
+      fprintf (stderr, "\nError sorting %s\n\n", las_file);
+      fflush (stderr);
+
+      QFile::remove (QString (out_file));
+    }
+
+
+  if (!status && index.chunk) status = write_index (&ctx, &index, index_file);
+
+  free (index.bounds);
+
+
+  return (status);
+}
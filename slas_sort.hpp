@@ -0,0 +1,80 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Spatial (Morton order) reordering of the point records in a LAS file.  This is used on the LAZ path, where the file
+    has to be rewritten anyway, so that tools that read the tiles spatially don't thrash.
+
+    The sort is an external merge sort with a fixed memory budget.  Runs of records that fit in the budget are sorted
+    (in parallel) by the Morton key of their raw X/Y integers and written to temporary run files next to the LAS file,
+    then the runs are merged into a new copy of the file.  The header, VLRs, and everything after the point records
+    (internal waveform packets, EVLRs) are copied unchanged.  Since the point data area doesn't change size, the
+    waveform packet offsets stored in each record still point at the right packet after the record moves.  */
+
+#ifndef __SLAS_SORT_HPP__
+#define __SLAS_SORT_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <lasreader.hpp>
+#include "slas.hpp"
+
+
+//!  Default sort memory budget (MB) and index chunk size (the laszip default chunk size).
+
+#define SLAS_SORT_MEMORY                512
+#define SLAS_SORT_INDEX_CHUNK           50000
+
+
+typedef struct
+{
+  uint32_t                    memory;                          //!<  Memory budget in MB
+  int32_t                     threads;                         //!<  Threads used to sort each run (0 = one per core)
+  uint32_t                    index_chunk;                     //!<  Records per chunk in the spatial chunk index (0 = no index)
+} SLAS_SORT_OPTIONS;
+
+
+/*!  Spatial chunk index.  The file is "SLASSBX1", a uint32_t byte order marker (0x01020304), the uint32_t chunk size and
+     uint64_t number of chunks, then four doubles per chunk (min X, min Y, max X, max Y).  */
+
+int32_t slas_sort_file (const char *las_file, SLAS_SORT_OPTIONS *options, const char *index_file);
+uint64_t slas_morton_key (int32_t x, int32_t y);
+
+
+#endif
@@ -0,0 +1,271 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_throttle.hpp"
+#include "nvutility.hpp"
+
+#include <sys/stat.h>
+
+#ifdef NVWIN3X
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+
+static void set_rate (SLAS_TOKEN_BUCKET *bucket, double rate)
+{
+  if (rate < 0.0) rate = 0.0;
+
+
+  //  Start with a full bucket (one second's worth) unless we're just changing the rate.
+
+  if (bucket->rate == 0.0 || bucket->tokens > rate) bucket->tokens = rate;
+
+  bucket->rate = rate;
+}
+
+
+static void refill (SLAS_TOKEN_BUCKET *bucket, double seconds)
+{
+  if (bucket->rate > 0.0) bucket->tokens = qMin (bucket->rate, bucket->tokens + bucket->rate * seconds);
+}
+
+
+//  Take tokens and return how long (in seconds) the caller has to wait to pay off any debt.
+
+static double take (SLAS_TOKEN_BUCKET *bucket, double amount)
+{
+  if (bucket->rate <= 0.0) return (0.0);
+
+  bucket->tokens -= amount;
+
+  return ((bucket->tokens < 0.0) ? -bucket->tokens / bucket->rate : 0.0);
+}
+
+
+//  Read the control file if it has changed.  Anything not in the file is left alone.
+
+static void check_control_file (SLAS_THROTTLE *throttle)
+{
+  struct stat st;
+  FILE *fp;
+  char line[256], key[128];
+  double value;
+
+
+  if (stat (throttle->control_file, &st) || ((int64_t) st.st_mtime == throttle->control_mtime && !throttle->reload)) return;
+
+  throttle->control_mtime = (int64_t) st.st_mtime;
+  throttle->reload = 0;
+
+  if ((fp = fopen (throttle->control_file, "r")) == NULL) return;
+
+  while (fgets (line, sizeof (line), fp))
+    {
+      if (sscanf (line, "%127s %lf", key, &value) != 2) continue;
+
+      if (!strcmp (key, "read_mbps"))
+        {
+          set_rate (&throttle->bytes[SLAS_THROTTLE_READ], value * 1048576.0);
+        }
+      else if (!strcmp (key, "write_mbps"))
+        {
+          set_rate (&throttle->bytes[SLAS_THROTTLE_WRITE], value * 1048576.0);
+        }
+      else if (!strcmp (key, "read_iops"))
+        {
+          set_rate (&throttle->ops[SLAS_THROTTLE_READ], value);
+        }
+      else if (!strcmp (key, "write_iops"))
+        {
+          set_rate (&throttle->ops[SLAS_THROTTLE_WRITE], value);
+        }
+    }
+
+  fclose (fp);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_throttle_init
+
+ - Purpose:     Set up an I/O throttle.  If there's a control file its settings override the
+                ones passed in.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - throttle       =    The SLAS_THROTTLE
+                - read_mbps      =    Read bandwidth limit in MB/s (0 = none)
+                - write_mbps     =    Write bandwidth limit in MB/s (0 = none)
+                - read_iops      =    Read operations per second limit (0 = none)
+                - write_iops     =    Write operations per second limit (0 = none)
+                - control_file   =    Control file name (NULL or empty for none)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_throttle_init (SLAS_THROTTLE *throttle, double read_mbps, double write_mbps, double read_iops, double write_iops,
+                         const char *control_file)
+{
+  for (int32_t i = 0 ; i < 2 ; i++) throttle->bytes[i].rate = throttle->bytes[i].tokens = throttle->ops[i].rate = throttle->ops[i].tokens = 0.0;
+
+  set_rate (&throttle->bytes[SLAS_THROTTLE_READ], read_mbps * 1048576.0);
+  set_rate (&throttle->bytes[SLAS_THROTTLE_WRITE], write_mbps * 1048576.0);
+  set_rate (&throttle->ops[SLAS_THROTTLE_READ], read_iops);
+  set_rate (&throttle->ops[SLAS_THROTTLE_WRITE], write_iops);
+
+  throttle->control_file[0] = 0;
+  if (control_file && strlen (control_file) < sizeof (throttle->control_file)) strcpy (throttle->control_file, control_file);
+
+  throttle->control_mtime = -1;
+  throttle->reload = 0;
+  throttle->waits = 0;
+  throttle->waited = 0.0;
+
+  throttle->timer.start ();
+  throttle->last_refill = throttle->last_check = 0;
+
+  if (throttle->control_file[0]) check_control_file (throttle);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_throttle_wait
+
+ - Purpose:     Take the tokens for one I/O operation, sleeping if we're over the limit.  Call
+                this before every read or write.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - throttle       =    The SLAS_THROTTLE (NULL for no throttling)
+                - direction      =    SLAS_THROTTLE_READ or SLAS_THROTTLE_WRITE
+                - bytes          =    Size of the I/O
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_throttle_wait (SLAS_THROTTLE *throttle, int32_t direction, uint64_t bytes)
+{
+  double wait;
+
+
+  if (throttle == NULL) return;
+
+  throttle->mutex.lock ();
+
+  int64_t now = throttle->timer.elapsed ();
+
+  if (throttle->control_file[0] && (throttle->reload || now - throttle->last_check >= 1000))
+    {
+      check_control_file (throttle);
+      throttle->last_check = now;
+    }
+
+  double seconds = (double) (now - throttle->last_refill) / 1000.0;
+  throttle->last_refill = now;
+
+  for (int32_t i = 0 ; i < 2 ; i++)
+    {
+      refill (&throttle->bytes[i], seconds);
+      refill (&throttle->ops[i], seconds);
+    }
+
+  wait = qMax (take (&throttle->bytes[direction], (double) bytes), take (&throttle->ops[direction], 1.0));
+
+  if (wait > 0.0)
+    {
+      throttle->waits++;
+      throttle->waited += wait;
+    }
+
+  throttle->mutex.unlock ();
+
+
+  //  Sleep off the debt outside of the lock so the other threads can queue up behind us.
+
+  if (wait > 0.0)
+    {
+#ifdef NVWIN3X
+      Sleep ((DWORD) (wait * 1000.0));
+#else
+      usleep ((useconds_t) (wait * 1000000.0));
+#endif
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_throttle_reload
+
+ - Purpose:     Force the control file to be reread on the next I/O.  This only sets a flag so
+                it can be called from a signal handler.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - throttle       =    The SLAS_THROTTLE
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_throttle_reload (SLAS_THROTTLE *throttle)
+{
+  throttle->reload = 1;
+}
@@ -0,0 +1,97 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  I/O throttling.  A token bucket limiter for the read and write paths, with separate bandwidth (bytes/second) and
+    operation (IOPS) limits for each, shared by every thread in the process.  Callers take tokens before each I/O
+    (slas_throttle_wait) and sleep off any debt, so a request bigger than the bucket still goes through, it just
+    makes everybody wait longer afterwards.
+
+    The limits can be changed while running by editing a control file with lines like
+
+        read_mbps 50
+        write_mbps 20
+        read_iops 0
+        write_iops 500
+
+    (0 means no limit).  The file is checked for changes about once a second, or right away after a call to
+    slas_throttle_reload (which is safe to call from a signal handler).  */
+
+#ifndef __SLAS_THROTTLE_HPP__
+#define __SLAS_THROTTLE_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <signal.h>
+
+#include <QtCore>
+
+
+#define SLAS_THROTTLE_READ              0
+#define SLAS_THROTTLE_WRITE             1
+
+
+typedef struct
+{
+  double                      rate;                            //!<  Tokens per second (0 = unlimited)
+  double                      tokens;                          //!<  Tokens available (negative when in debt)
+} SLAS_TOKEN_BUCKET;
+
+
+typedef struct
+{
+  SLAS_TOKEN_BUCKET           bytes[2];                        //!<  Read and write bandwidth buckets
+  SLAS_TOKEN_BUCKET           ops[2];                          //!<  Read and write IOPS buckets
+  char                        control_file[1024];              //!<  Optional control file (empty if none)
+  int64_t                     control_mtime;
+  int64_t                     last_refill;                     //!<  Timer time (ms) of the last refill
+  int64_t                     last_check;                      //!<  Timer time (ms) of the last control file check
+  volatile sig_atomic_t       reload;                          //!<  Set to force a control file check
+  uint64_t                    waits;                           //!<  Number of times a caller had to sleep
+  double                      waited;                          //!<  Total seconds spent sleeping
+  QElapsedTimer               timer;
+  QMutex                      mutex;
+} SLAS_THROTTLE;
+
+
+void slas_throttle_init (SLAS_THROTTLE *throttle, double read_mbps, double write_mbps, double read_iops, double write_iops,
+                         const char *control_file);
+void slas_throttle_wait (SLAS_THROTTLE *throttle, int32_t direction, uint64_t bytes);
+void slas_throttle_reload (SLAS_THROTTLE *throttle);
+
+
+#endif
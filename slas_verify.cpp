@@ -0,0 +1,487 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include "slas_verify.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define SLAS_CRC32C_SSE42
+#include <nmmintrin.h>
+#endif
+
+
+//  Castagnoli polynomial (reflected).
+
+#define CRC32C_POLY                     0x82f63b78
+
+
+static uint32_t crc_table[256];
+static uint8_t crc_table_done = NVFalse;
+static int32_t crc_hardware = -1;
+
+
+static uint32_t crc32c_table (uint32_t crc, const uint8_t *data, size_t size)
+{
+  if (!crc_table_done)
+    {
+      for (uint32_t i = 0 ; i < 256 ; i++)
+        {
+          uint32_t value = i;
+
+          for (int32_t bit = 0 ; bit < 8 ; bit++) value = (value & 1) ? (value >> 1) ^ CRC32C_POLY : value >> 1;
+
+          crc_table[i] = value;
+        }
+
+      crc_table_done = NVTrue;
+    }
+
+  for (size_t i = 0 ; i < size ; i++) crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+  return (crc);
+}
+
+
+#ifdef SLAS_CRC32C_SSE42
+
+__attribute__ ((target ("sse4.2"))) static uint32_t crc32c_sse42 (uint32_t crc, const uint8_t *data, size_t size)
+{
+#ifdef __x86_64__
+
+  uint64_t crc64 = crc;
+
+  for ( ; size >= 8 ; size -= 8, data += 8)
+    {
+      uint64_t value;
+
+      memcpy (&value, data, 8);
+      crc64 = _mm_crc32_u64 (crc64, value);
+    }
+
+  crc = (uint32_t) crc64;
+
+#endif
+
+  for ( ; size >= 4 ; size -= 4, data += 4)
+    {
+      uint32_t value;
+
+      memcpy (&value, data, 4);
+      crc = _mm_crc32_u32 (crc, value);
+    }
+
+  for ( ; size ; size--, data++) crc = _mm_crc32_u8 (crc, *data);
+
+  return (crc);
+}
+
+#endif
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_crc32c_hardware
+
+ - Purpose:     Check whether slas_crc32c can use the SSE4.2 crc32 instruction on this CPU.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:   void
+
+ - Returns:     uint8_t          =    NVTrue if it can
+
+*********************************************************************************************/
+
+uint8_t slas_crc32c_hardware ()
+{
+  if (crc_hardware < 0)
+    {
+#ifdef SLAS_CRC32C_SSE42
+      crc_hardware = __builtin_cpu_supports ("sse4.2") ? NVTrue : NVFalse;
+#else
+      crc_hardware = NVFalse;
+#endif
+    }
+
+  return ((uint8_t) crc_hardware);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_crc32c
+
+ - Purpose:     Compute (or continue) a CRC32C.  Start with a crc of 0 and pass the result
+                back in to keep going.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - crc            =    CRC so far (0 to start)
+                - data           =    Data
+                - size           =    Number of bytes in data
+
+ - Returns:     uint32_t         =    CRC32C
+
+*********************************************************************************************/
+
+uint32_t slas_crc32c (uint32_t crc, const void *data, size_t size)
+{
+  crc = ~crc;
+
+#ifdef SLAS_CRC32C_SSE42
+  if (slas_crc32c_hardware ()) return (~crc32c_sse42 (crc, (const uint8_t *) data, size));
+#endif
+
+  return (~crc32c_table (crc, (const uint8_t *) data, size));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_verify_init
+
+ - Purpose:     Allocate the per chunk checksums for a file.  Set verify->chunk_size first
+                (0 means SLAS_VERIFY_CHUNK).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - verify         =    The SLAS_VERIFY
+                - ctx            =    The SLAS_CONTEXT for the file
+                - memory         =    Optional SLAS_MEMORY budget for the checksum arrays
+
+ - Returns:     int32_t          =    0 on success, -1 if we couldn't allocate memory (or it
+                                      doesn't fit in the budget)
+
+*********************************************************************************************/
+
+int32_t slas_verify_init (SLAS_VERIFY *verify, SLAS_CONTEXT *ctx, SLAS_MEMORY *memory)
+{
+  uint32_t chunk_size = verify->chunk_size ? verify->chunk_size : SLAS_VERIFY_CHUNK;
+
+
+  memset (verify, 0, sizeof (SLAS_VERIFY));
+
+  verify->chunk_size = chunk_size;
+  verify->number_of_points = ctx->number_of_points;
+  verify->num_chunks = (uint32_t) ((ctx->number_of_points + chunk_size - 1) / chunk_size);
+  verify->hardware = slas_crc32c_hardware ();
+
+
+  //  Build the table now so the worker threads don't all try to at once.
+
+  crc32c_table (0, NULL, 0);
+
+  if (!verify->num_chunks) return (0);
+
+  uint64_t bytes = (uint64_t) verify->num_chunks * (2 * sizeof (uint32_t) + sizeof (uint64_t));
+
+  if (slas_memory_reserve (memory, bytes)) return (-1);
+
+  verify->memory = memory;
+  verify->reserved = bytes;
+
+  verify->before = (uint32_t *) calloc (verify->num_chunks, sizeof (uint32_t));
+  verify->after = (uint32_t *) calloc (verify->num_chunks, sizeof (uint32_t));
+  verify->records = (uint64_t *) calloc (verify->num_chunks, sizeof (uint64_t));
+
+  if (verify->before == NULL || verify->after == NULL || verify->records == NULL)
+    {
+      slas_verify_free (verify);
+      verify->chunk_size = chunk_size;
+      return (-1);
+    }
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_verify_free
+
+ - Purpose:     Free the per chunk checksums (the chunk size is kept).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - verify         =    The SLAS_VERIFY
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_verify_free (SLAS_VERIFY *verify)
+{
+  if (verify->before) free (verify->before);
+  if (verify->after) free (verify->after);
+  if (verify->records) free (verify->records);
+
+  slas_memory_release (verify->memory, verify->reserved);
+
+  verify->before = verify->after = NULL;
+  verify->records = NULL;
+  verify->num_chunks = 0;
+  verify->memory = NULL;
+  verify->reserved = 0;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_verify_records
+
+ - Purpose:     Compute the checksum of each record in a block of raw records.  The record
+                number goes in first (so records that trade places are caught) and the
+                withheld bit is masked off.  This doesn't touch any shared state so any
+                number of threads can call it.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - first          =    Record number of the first record in buffer
+                - count          =    Number of records in buffer
+                - buffer         =    count * ctx->record_length bytes of raw records
+                - crc            =    Returned checksum for each record
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_verify_records (SLAS_CONTEXT *ctx, uint64_t first, uint32_t count, const uint8_t *buffer, uint32_t *crc)
+{
+  uint32_t (*crc32c) (uint32_t, const uint8_t *, size_t) = crc32c_table;
+  uint8_t mask = (uint8_t) ~ctx->withheld_mask;
+  size_t tail = ctx->record_length - ctx->flags_offset - 1;
+
+
+#ifdef SLAS_CRC32C_SSE42
+  if (slas_crc32c_hardware ()) crc32c = crc32c_sse42;
+#endif
+
+
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      const uint8_t *data = &buffer[(size_t) i * ctx->record_length];
+      uint8_t recnum[8], flags = data[ctx->flags_offset] & mask;
+
+      for (int32_t j = 0 ; j < 8 ; j++) recnum[j] = (uint8_t) ((first + i) >> (j * 8));
+
+      uint32_t value = crc32c (0xffffffff, recnum, 8);
+      value = crc32c (value, data, ctx->flags_offset);
+      value = crc32c (value, &flags, 1);
+      crc[i] = ~crc32c (value, &data[ctx->flags_offset + 1], tail);
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_verify_fold
+
+ - Purpose:     Add record checksums from slas_verify_records to their chunks.  The caller
+                has to make sure only one thread at a time does this.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - verify         =    The SLAS_VERIFY
+                - first          =    Record number of the first checksum
+                - count          =    Number of checksums
+                - crc            =    Record checksums
+                - after          =    NVFalse for the pass, NVTrue for the read back
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_verify_fold (SLAS_VERIFY *verify, uint64_t first, uint32_t count, const uint32_t *crc, uint8_t after)
+{
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      uint32_t chunk = (uint32_t) ((first + i) / verify->chunk_size);
+
+      if (chunk >= verify->num_chunks) break;
+
+      if (after)
+        {
+          verify->after[chunk] ^= crc[i];
+        }
+      else
+        {
+          verify->before[chunk] ^= crc[i];
+          verify->records[chunk]++;
+        }
+    }
+
+  if (after) verify->checked += count;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_verify_compare
+
+ - Purpose:     Count the chunks where the pass and the read back disagree.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - verify         =    The SLAS_VERIFY
+
+ - Returns:     uint32_t         =    Number of mismatched chunks (also in verify->mismatches)
+
+*********************************************************************************************/
+
+uint32_t slas_verify_compare (SLAS_VERIFY *verify)
+{
+  verify->mismatches = 0;
+
+  for (uint32_t i = 0 ; i < verify->num_chunks ; i++)
+    {
+      if (verify->records[i] && verify->before[i] != verify->after[i]) verify->mismatches++;
+    }
+
+  return (verify->mismatches);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_verify_write
+
+ - Purpose:     Write the per chunk checksums to a text sidecar file.  There's one line for
+                each chunk the pass read with the record range, the number of records
+                checked, the before and after checksums, and ok or MISMATCH.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - verify         =    The SLAS_VERIFY
+                - path           =    Sidecar file name
+                - las_file       =    LAS/LAZ file the checksums are for (only recorded)
+
+ - Returns:     int32_t          =    0 on success, -1 on error
+
+*********************************************************************************************/
+
+int32_t slas_verify_write (SLAS_VERIFY *verify, const char *path, const char *las_file)
+{
+  FILE     *fp;
+  char     tmp_file[1100];
+
+
+  if (strlen (path) >= 1024) return (-1);
+
+  sprintf (tmp_file, "%s.tmp", path);
+
+  if ((fp = fopen (tmp_file, "w")) == NULL)
+    {
+      fprintf (stderr, "\nUnable to open verification file %s : %s\n\n", tmp_file, strerror (errno));
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  fprintf (fp, "# file %s\n", las_file);
+  fprintf (fp, "# CRC32C (%s), withheld bit masked, %u records per chunk, %u mismatched chunk(s)\n", verify->hardware ? "SSE4.2" : "table",
+           verify->chunk_size, verify->mismatches);
+  fprintf (fp, "# first\tlast\trecords\tbefore\tafter\tstatus\n");
+
+  for (uint32_t i = 0 ; i < verify->num_chunks ; i++)
+    {
+      if (!verify->records[i]) continue;
+
+      uint64_t first = (uint64_t) i * verify->chunk_size;
+      uint64_t last = qMin (first + verify->chunk_size, verify->number_of_points) - 1;
+
+      fprintf (fp, "%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%08x\t%08x\t%s\n", first, last, verify->records[i],
+               verify->before[i], verify->after[i], verify->before[i] == verify->after[i] ? "ok" : "MISMATCH");
+    }
+
+
+  QFile::remove (QString (path));
+
+  if (fclose (fp) || !QFile::rename (QString (tmp_file), QString (path)))
+    {
+      QFile::remove (QString (tmp_file));
+
+      fprintf (stderr, "\nError writing verification file %s\n\n", path);
+      fflush (stderr);
+      return (-1);
+    }
+
+  return (0);
+}
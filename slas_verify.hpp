@@ -0,0 +1,89 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Record integrity checking.  Every record the zeroing pass reads gets a CRC32C (seeded with the record number, with
+    the withheld bit masked off) and the record CRCs are XORed together per chunk of records.  After the pass the same
+    records are read back from storage and checked the same way, so any chunk whose before and after values differ had
+    something other than the withheld bit change.  The CRC uses the SSE4.2 crc32 instruction when the CPU has it (that
+    goes several GB/s per core, faster than the storage) and a table otherwise.  */
+
+#ifndef __SLAS_VERIFY_HPP__
+#define __SLAS_VERIFY_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <lasreader.hpp>
+#include "slas.hpp"
+#include "slas_memory.hpp"
+
+
+//!  Default number of records per checksum chunk.
+
+#define SLAS_VERIFY_CHUNK               65536
+
+
+typedef struct
+{
+  uint32_t                    chunk_size;                      //!<  Records per chunk (set this before slas_verify_init)
+  uint64_t                    number_of_points;
+  uint32_t                    num_chunks;
+  uint32_t                    *before;                         //!<  Per chunk checksum of the records as read by the pass
+  uint32_t                    *after;                          //!<  Per chunk checksum of the same records read back afterward
+  uint64_t                    *records;                        //!<  Records in the chunk that the pass read (0 = not checked)
+  uint64_t                    checked;                         //!<  Records read back
+  uint32_t                    mismatches;                      //!<  Chunks where before and after differ
+  double                      seconds;                         //!<  Time taken reading back
+  uint8_t                     hardware;                        //!<  NVTrue if the CRC used SSE4.2
+  SLAS_MEMORY                 *memory;                         //!<  Budget the arrays were reserved from
+  uint64_t                    reserved;                        //!<  Bytes reserved from it
+} SLAS_VERIFY;
+
+
+uint32_t slas_crc32c (uint32_t crc, const void *data, size_t size);
+uint8_t slas_crc32c_hardware ();
+int32_t slas_verify_init (SLAS_VERIFY *verify, SLAS_CONTEXT *ctx, SLAS_MEMORY *memory);
+void slas_verify_free (SLAS_VERIFY *verify);
+void slas_verify_records (SLAS_CONTEXT *ctx, uint64_t first, uint32_t count, const uint8_t *buffer, uint32_t *crc);
+void slas_verify_fold (SLAS_VERIFY *verify, uint64_t first, uint32_t count, const uint32_t *crc, uint8_t after);
+uint32_t slas_verify_compare (SLAS_VERIFY *verify);
+int32_t slas_verify_write (SLAS_VERIFY *verify, const char *path, const char *las_file);
+
+
+#endif
@@ -0,0 +1,2572 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <math.h>
+#include <sys/stat.h>
+
+#include "slas_zero.hpp"
+#include "slas_laz.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+
+//  Range of records (first up to, but not including, end) to be processed.
+
+typedef struct
+{
+  uint64_t                    first;
+  uint64_t                    end;
+} ZERO_RANGE;
+
+
+//  Where a slice of the ranges is up to.  The ranges from range up to (but not including) last belong to the slice.
+
+typedef struct
+{
+  uint32_t                    range;
+  uint32_t                    last;
+  uint64_t                    next;
+} ZERO_CURSOR;
+
+
+//  A LAZ file (point formats 6 through 10) that's being rewritten a chunk at a time.  Every block is one chunk.  The
+//  workers decode their chunks with their own LASreader (only the layers the pass needs) and build the new chunks in
+//  their own buffers, then the chunks go into the new file in record order (see write_chunk).  In a COPC file every
+//  chunk is an octree node, so a chunk whose node is clear of the threshold doesn't have to be looked at point by point.
+
+typedef struct
+{
+  SLAS_LAZ                    laz;                             //!<  Chunk table of the LAZ file
+  LASheader                   *lasheader;
+  const char                  *path;
+  int32_t                     fd;                              //!<  The LAZ file (read only)
+  char                        tmp_file[1100];                  //!<  The new file
+  int32_t                     tmp_fd;
+  U32                         layers;                          //!<  LASzip layers the workers decode
+  uint64_t                    *chunk_bytes;                    //!<  Size of each new chunk
+  uint64_t                    offset;                          //!<  Where the next chunk goes in the new file
+  uint32_t                    changed;                         //!<  Number of chunks that had points change
+  SLAS_COPC                   *copc;                           //!<  NULL unless it's a COPC file
+  uint8_t                     *chunk_state;                    //!<  SLAS_COPC state of each chunk (NULL if every chunk is read)
+} ZERO_LAZ;
+
+
+//  A LAZ archive being written from a LAS file.  Every block is one chunk, compressed by the worker that read it, and
+//  the chunks go into the new file in record order (see archive_block).  The header and VLRs (with the laszip VLR
+//  added), the chunk table, and whatever followed the points in the LAS file are written at the end (see
+//  finish_archive).
+
+typedef struct
+{
+  SLAS_LAZ                    laz;                             //!<  LASzip setup for the point format
+  LASheader                   *lasheader;
+  int32_t                     fd;                              //!<  The LAS file (read only)
+  char                        tmp_file[1100];                  //!<  The new LAZ file
+  int32_t                     tmp_fd;
+  SLAS_LAZ_BUFFER             vlr;                             //!<  The laszip VLR
+  uint64_t                    vlr_end;                         //!<  End of the VLRs in the LAS file (the laszip VLR goes here)
+  uint64_t                    offset;                          //!<  Where the next chunk goes in the new file
+  uint32_t                    num_chunks;
+  uint32_t                    allocated;
+  uint32_t                    *chunk_points;                   //!<  Records in each chunk
+  uint64_t                    *chunk_bytes;                    //!<  Size of each chunk
+} ZERO_ARCHIVE;
+
+
+//  What a worker needs for the chunks of a LAZ rewrite (or archive).
+
+typedef struct
+{
+  LASreader                   *reader;
+  LASreader                   *flags_reader;                   //!<  Only decodes the flags (for COPC nodes above the threshold)
+  LASpoint                    *point;                          //!<  Point set up for the format (archive only)
+  SLAS_LAZ_BUFFER             chunk;                           //!<  The chunk as it is in the file
+  SLAS_LAZ_BUFFER             out;                             //!<  The chunk with the new flags layer (or the archive chunk)
+} ZERO_CHUNKER;
+
+
+//  Shared state for one pass over a file.  The workers pull blocks of records off of the current range (next) of
+//  their slice under the mutex.  There's one slice unless the workers are spread over NUMA nodes, then each node gets
+//  its own contiguous part of the file (and helps the others when it runs out).  When the pass writes a LAZ archive
+//  each worker compresses its own block, then waits (on write_turn) until next_write gets to the first record of its
+//  block to add it to the file.  The chunks of a LAZ rewrite take turns the same way.
+
+typedef struct
+{
+  SLAS_CONTEXT                *ctx;
+  SLAS_ZERO_OPTIONS           *options;
+  ZERO_RANGE                  *ranges;
+  uint32_t                    block_size;                      //!<  Records per block (may be less than options->block_size)
+  int32_t                     grid_tiles;                      //!<  Grid tiles cached per thread
+  uint32_t                    num_ranges;
+  SLAS_EXTRA_RULES            *extra;                          //!<  NULL if there aren't any extra bytes rules
+  int32_t                     extra_dim[SLAS_ZERO_MAX_EXTRA];  //!<  Index into ctx->extra for each rule
+  int32_t                     slices;
+  ZERO_CURSOR                 cursor[SLAS_NUMA_MAX_NODES];
+  uint64_t                    slice_records[SLAS_NUMA_MAX_NODES];
+  double                      slice_seconds[SLAS_NUMA_MAX_NODES];
+  uint64_t                    total;
+  uint64_t                    done;
+  int32_t                     status;
+  SLAS_ZERO_STATS             stats;
+  QMutex                      mutex;
+  ZERO_ARCHIVE                *archive;                        //!<  NULL unless we're writing a LAZ archive
+  ZERO_LAZ                    *laz;                            //!<  NULL unless we're rewriting the chunks of a LAZ file
+  uint64_t                    next_write;                      //!<  First record of the next block to go into the new file
+  uint8_t                     write_abort;                     //!<  Set if a worker failed, nobody else gets a turn
+  QMutex                      write_mutex;
+  QWaitCondition              write_turn;
+} ZERO_PASS;
+
+
+//  Check a point record against the flightline/time selection.
+
+static inline uint8_t point_selected (SLAS_CONTEXT *ctx, SLAS_SELECTION *selection, const uint8_t *data)
+{
+  if (selection->source_ids)
+    {
+      int16_t id;
+
+      memcpy (&id, &data[ctx->point_source_id_offset], 2);
+      if (ctx->swap) swap_short (&id);
+
+      if (!SLAS_SELECTED_ID (selection->source_ids, (uint16_t) id)) return (NVFalse);
+    }
+
+  if (selection->time_range)
+    {
+      double gps;
+
+      memcpy (&gps, &data[ctx->gps_time_offset], 8);
+      if (ctx->swap) swap_double (&gps);
+
+      if (gps < selection->time_min || gps > selection->time_max) return (NVFalse);
+    }
+
+  return (NVTrue);
+}
+
+
+//  Find the extra bytes dimension for each rule.  Returns SLAS_ZERO_EXTRA_ERROR if one isn't in the file.
+
+static int32_t extra_dims (SLAS_CONTEXT *ctx, SLAS_EXTRA_RULES *extra, int32_t *dims)
+{
+  for (int32_t i = 0 ; i < extra->count ; i++)
+    {
+      if ((dims[i] = slas_find_extra_dim (ctx, extra->name[i])) < 0) return (SLAS_ZERO_EXTRA_ERROR);
+    }
+
+  return (SLAS_ZERO_SUCCESS);
+}
+
+
+//  Check a point record against the extra bytes rules.
+
+static inline uint8_t extra_match (SLAS_CONTEXT *ctx, SLAS_EXTRA_RULES *extra, const int32_t *dims, const uint8_t *data)
+{
+  for (int32_t i = 0 ; i < extra->count ; i++)
+    {
+      double value;
+
+      if (slas_extra_value (ctx, dims[i], data, &value) && (extra->greater[i] ? value > extra->value[i] : value < extra->value[i]))
+        return (NVTrue);
+    }
+
+  return (NVFalse);
+}
+
+
+//  Z of a point record.  This is the same conversion that slas_read_point_data does so we get exactly the same answer
+//  as before.
+
+static inline float point_z (SLAS_CONTEXT *ctx, const uint8_t *data)
+{
+  int32_t z;
+
+  memcpy (&z, &data[8], 4);
+  if (ctx->swap) swap_int (&z);
+
+  return ((float) (((double) z * ctx->z_scale_factor) + ctx->z_offset));
+}
+
+
+static inline void point_xy (SLAS_CONTEXT *ctx, const uint8_t *data, double *x, double *y)
+{
+  int32_t ix, iy;
+
+  memcpy (&ix, &data[0], 4);
+  memcpy (&iy, &data[4], 4);
+
+  if (ctx->swap)
+    {
+      swap_int (&ix);
+      swap_int (&iy);
+    }
+
+  *x = (double) ix * ctx->x_scale_factor + ctx->x_offset;
+  *y = (double) iy * ctx->y_scale_factor + ctx->y_offset;
+}
+
+
+//  Write the records from run_start through run_end (inclusive, relative to the block) back to the file.
+
+static int32_t flush_run (ZERO_PASS *pass, uint64_t first, uint8_t *buffer, int32_t run_start, int32_t run_end, SLAS_ZERO_STATS *stats,
+                          SLAS_PERF_THREAD *perf)
+{
+  SLAS_CONTEXT *ctx = pass->ctx;
+  uint32_t count = run_end - run_start + 1;
+
+
+  //  The profile phase goes back to predicate when we're done (that's the only place we get called from).
+
+  slas_perf_phase (perf, SLAS_PERF_WRITE);
+
+  slas_throttle_wait (pass->options->throttle, SLAS_THROTTLE_WRITE, (uint64_t) count * ctx->record_length);
+
+  int32_t status = slas_ctx_write_records (ctx, first + run_start, count, &buffer[(size_t) run_start * ctx->record_length]);
+
+  slas_perf_phase (perf, SLAS_PERF_PREDICATE);
+
+  if (status) return (SLAS_ZERO_WRITE_ERROR);
+
+  stats->bytes_written += (uint64_t) count * ctx->record_length;
+
+  return (SLAS_ZERO_SUCCESS);
+}
+
+
+//  Compress a block into one LAZ chunk (in the worker's own buffer) and add it to the archive once every block before
+//  it is in.  Only the append happens with the lock held, the other workers keep reading, checking, and compressing
+//  their blocks in the meantime.
+
+static int32_t archive_block (ZERO_PASS *pass, ZERO_CHUNKER *chunker, uint64_t first, uint32_t count, uint8_t *buffer,
+                              SLAS_ZERO_STATS *stats, SLAS_PERF_THREAD *perf)
+{
+  ZERO_ARCHIVE *archive = pass->archive;
+  int32_t status = SLAS_ZERO_SUCCESS;
+
+
+  slas_perf_phase (perf, SLAS_PERF_WRITE);
+
+  if (chunker->point == NULL)
+    {
+      chunker->point = new LASpoint;
+
+      if (!chunker->point->init (archive->lasheader, archive->lasheader->point_data_format & 0x3f, archive->lasheader->point_data_record_length))
+        status = SLAS_ZERO_ARCHIVE_ERROR;
+    }
+
+  if (!status && slas_laz_compress (&archive->laz, chunker->point, buffer, count, &chunker->out)) status = SLAS_ZERO_ARCHIVE_ERROR;
+
+  if (status)
+    {
+      slas_perf_phase (perf, SLAS_PERF_PREDICATE);
+      return (status);
+    }
+
+  slas_throttle_wait (pass->options->throttle, SLAS_THROTTLE_WRITE, chunker->out.size);
+
+
+  QMutexLocker lock (&pass->write_mutex);
+
+  while (pass->next_write != first && !pass->write_abort) pass->write_turn.wait (&pass->write_mutex);
+
+  if (pass->write_abort) return (SLAS_ZERO_ARCHIVE_ERROR);
+
+  if (archive->num_chunks == archive->allocated)
+    {
+      uint32_t allocated = archive->allocated ? archive->allocated * 2 : 1024;
+      uint32_t *points = (uint32_t *) realloc (archive->chunk_points, allocated * sizeof (uint32_t));
+
+      if (points) archive->chunk_points = points;
+
+      uint64_t *bytes = (uint64_t *) realloc (archive->chunk_bytes, allocated * sizeof (uint64_t));
+
+      if (bytes) archive->chunk_bytes = bytes;
+
+      if (points == NULL || bytes == NULL)
+        {
+          status = SLAS_ZERO_MEMORY_ERROR;
+        }
+      else
+        {
+          archive->allocated = allocated;
+        }
+    }
+
+  if (!status && slas_pwrite (archive->tmp_fd, chunker->out.data, chunker->out.size, archive->offset)) status = SLAS_ZERO_WRITE_ERROR;
+
+  if (status)
+    {
+      pass->write_abort = NVTrue;
+    }
+  else
+    {
+      archive->chunk_points[archive->num_chunks] = count;
+      archive->chunk_bytes[archive->num_chunks++] = chunker->out.size;
+      archive->offset += chunker->out.size;
+      stats->bytes_written += chunker->out.size;
+      pass->next_write += count;
+    }
+
+  pass->write_turn.wakeAll ();
+
+  slas_perf_phase (perf, SLAS_PERF_PREDICATE);
+
+  return (status);
+}
+
+
+//  Decode a block (one chunk) of a LAZ file into buffer.  The worker's reader is opened the first time through.
+
+static int32_t read_chunk (ZERO_PASS *pass, LASreader **reader, const char *path, U32 layers, uint64_t first, uint32_t count,
+                           uint8_t *buffer)
+{
+  uint16_t record_length = pass->ctx->record_length;
+
+
+  if (*reader == NULL)
+    {
+      LASreadOpener opener;
+
+      opener.set_file_name (path);
+      opener.set_decompress_selective (layers);
+
+      if ((*reader = opener.open ()) == NULL) return (SLAS_ZERO_READ_ERROR);
+    }
+
+  if (!(*reader)->seek ((I64) first)) return (SLAS_ZERO_READ_ERROR);
+
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      if (!(*reader)->read_point ()) return (SLAS_ZERO_READ_ERROR);
+
+      (*reader)->point.copy_to (&buffer[(size_t) i * record_length]);
+    }
+
+  return (SLAS_ZERO_SUCCESS);
+}
+
+
+static void close_chunker (ZERO_CHUNKER *chunker)
+{
+  if (chunker->reader)
+    {
+      chunker->reader->close ();
+      delete chunker->reader;
+      chunker->reader = NULL;
+    }
+
+  if (chunker->flags_reader)
+    {
+      chunker->flags_reader->close ();
+      delete chunker->flags_reader;
+      chunker->flags_reader = NULL;
+    }
+
+  if (chunker->point)
+    {
+      delete chunker->point;
+      chunker->point = NULL;
+    }
+
+  slas_laz_buffer_free (&chunker->chunk);
+  slas_laz_buffer_free (&chunker->out);
+}
+
+
+//  Copy size bytes at from in one file to to in another.
+
+static int32_t copy_range (int32_t from_fd, uint64_t from, int32_t to_fd, uint64_t to, uint64_t size)
+{
+  uint8_t *buffer;
+
+
+  if (!size) return (0);
+
+  if ((buffer = (uint8_t *) malloc (1048576)) == NULL) return (-1);
+
+  while (size)
+    {
+      uint64_t piece = qMin (size, (uint64_t) 1048576);
+
+      if (slas_pread (from_fd, buffer, piece, from) || slas_pwrite (to_fd, buffer, piece, to))
+        {
+          free (buffer);
+          return (-1);
+        }
+
+      from += piece;
+      to += piece;
+      size -= piece;
+    }
+
+  free (buffer);
+
+  return (0);
+}
+
+
+//  Build the new chunk for a block and add it to the new file once every block before it is in.  The chunk is copied
+//  as it is unless one of its points changed, then its flags layer is encoded again.  Up to the first chunk that
+//  changes the new file would be the same as the old one, so nothing is written until then and that chunk's worker
+//  copies everything before it over first.  If no chunk changes nothing is written at all.
+
+static int32_t write_chunk (ZERO_PASS *pass, ZERO_CHUNKER *chunker, uint64_t first, uint32_t count, const uint8_t *buffer, uint8_t changed,
+                            SLAS_ZERO_STATS *stats, SLAS_PERF_THREAD *perf)
+{
+  ZERO_LAZ *out = pass->laz;
+  SLAS_LAZ *laz = &out->laz;
+  uint32_t c = slas_laz_find_chunk (laz, first);
+  int32_t status = SLAS_ZERO_SUCCESS;
+
+
+  if (c >= laz->num_chunks || laz->chunk_first[c] != first || laz->chunk_first[c + 1] - first != count) return (SLAS_ZERO_LAZ_ERROR);
+
+  uint64_t size = laz->chunk_offset[c + 1] - laz->chunk_offset[c];
+
+  chunker->chunk.size = 0;
+
+  if (slas_laz_buffer_put (&chunker->chunk, NULL, size)) return (SLAS_ZERO_MEMORY_ERROR);
+
+  if (slas_pread (out->fd, chunker->chunk.data, size, laz->chunk_offset[c])) return (SLAS_ZERO_READ_ERROR);
+
+  stats->bytes_read += size;
+
+
+  slas_perf_phase (perf, SLAS_PERF_WRITE);
+
+  SLAS_LAZ_BUFFER *chunk = &chunker->chunk;
+
+  if (changed)
+    {
+      if (slas_laz_rewrite_flags (laz, chunker->chunk.data, size, buffer, count, &chunker->out))
+        {
+          slas_perf_phase (perf, SLAS_PERF_PREDICATE);
+          return (SLAS_ZERO_LAZ_ERROR);
+        }
+
+      chunk = &chunker->out;
+    }
+
+  if (changed || out->changed) slas_throttle_wait (pass->options->throttle, SLAS_THROTTLE_WRITE, chunk->size);
+
+
+  QMutexLocker lock (&pass->write_mutex);
+
+  while (pass->next_write != first && !pass->write_abort) pass->write_turn.wait (&pass->write_mutex);
+
+  if (pass->write_abort) return (SLAS_ZERO_LAZ_ERROR);
+
+  if (changed && !out->changed)
+    {
+      if (copy_range (out->fd, laz->chunk_offset[0], out->tmp_fd, laz->chunk_offset[0], out->offset - laz->chunk_offset[0]))
+        status = SLAS_ZERO_WRITE_ERROR;
+
+      stats->bytes_written += out->offset - laz->chunk_offset[0];
+    }
+
+  if (!status && (changed || out->changed))
+    {
+      if (slas_pwrite (out->tmp_fd, chunk->data, chunk->size, out->offset)) status = SLAS_ZERO_WRITE_ERROR;
+
+      stats->bytes_written += chunk->size;
+    }
+
+  if (status)
+    {
+      pass->write_abort = NVTrue;
+    }
+  else
+    {
+      if (changed) out->changed++;
+
+      out->chunk_bytes[c] = chunk->size;
+      out->offset += chunk->size;
+      pass->next_write += count;
+    }
+
+  pass->write_turn.wakeAll ();
+
+  slas_perf_phase (perf, SLAS_PERF_PREDICATE);
+
+  return (status);
+}
+
+
+//  LAZ is little endian no matter what we're running on.
+
+static void put_u64 (uint8_t *buf, uint64_t value)
+{
+  for (int32_t i = 0 ; i < 8 ; i++) buf[i] = (uint8_t) (value >> (8 * i));
+}
+
+
+//  Finish the new LAZ file once every chunk is in (if any changed).  That's the header and VLRs, the offset of the new
+//  chunk table, the table itself, and whatever followed the old table (the EVLRs), with the header offsets that point
+//  past the table moved to match.  The hierarchy of a COPC file gets the new chunk offsets and sizes.
+
+static int32_t finish_laz (ZERO_PASS *pass)
+{
+  ZERO_LAZ         *out = pass->laz;
+  SLAS_LAZ         *laz = &out->laz;
+  LASheader        *lasheader = out->lasheader;
+  SLAS_LAZ_BUFFER  table;
+  uint32_t         *points;
+  uint8_t          value[8];
+  int32_t          status = SLAS_ZERO_SUCCESS;
+
+
+  if (!out->changed) return (SLAS_ZERO_SUCCESS);
+
+  if ((points = (uint32_t *) malloc ((laz->num_chunks + 1) * sizeof (uint32_t))) == NULL) return (SLAS_ZERO_MEMORY_ERROR);
+
+  for (uint32_t c = 0 ; c < laz->num_chunks ; c++) points[c] = (uint32_t) (laz->chunk_first[c + 1] - laz->chunk_first[c]);
+
+  memset (&table, 0, sizeof (SLAS_LAZ_BUFFER));
+
+  if (slas_laz_chunk_table (laz, points, out->chunk_bytes, laz->num_chunks, &table))
+    {
+      free (points);
+      slas_laz_buffer_free (&table);
+      return (SLAS_ZERO_LAZ_ERROR);
+    }
+
+  free (points);
+
+
+  uint64_t tail = out->offset + table.size;
+  uint64_t tail_size = (uint64_t) lseek (out->fd, 0, SEEK_END) - laz->tail_offset;
+  int64_t delta = (int64_t) tail - (int64_t) laz->tail_offset;
+
+  put_u64 (value, out->offset);
+
+  if (copy_range (out->fd, 0, out->tmp_fd, 0, laz->chunk_offset[0] - 8) || slas_pwrite (out->tmp_fd, value, 8, laz->chunk_offset[0] - 8) ||
+      slas_pwrite (out->tmp_fd, table.data, table.size, out->offset) || copy_range (out->fd, laz->tail_offset, out->tmp_fd, tail, tail_size))
+    status = SLAS_ZERO_WRITE_ERROR;
+
+  pass->stats.bytes_written += laz->chunk_offset[0] + table.size + tail_size;
+
+  slas_laz_buffer_free (&table);
+
+
+  //  The EVLRs (and the waveform data of a LAS 1.3 file) moved.
+
+  if (!status && lasheader->version_minor >= 4 && lasheader->number_of_extended_variable_length_records &&
+      lasheader->start_of_first_extended_variable_length_record >= laz->tail_offset)
+    {
+      put_u64 (value, lasheader->start_of_first_extended_variable_length_record + delta);
+      if (slas_pwrite (out->tmp_fd, value, 8, 235)) status = SLAS_ZERO_WRITE_ERROR;
+    }
+
+  if (!status && lasheader->version_minor >= 3 && lasheader->start_of_waveform_data_packet_record >= laz->tail_offset)
+    {
+      put_u64 (value, lasheader->start_of_waveform_data_packet_record + delta);
+      if (slas_pwrite (out->tmp_fd, value, 8, 227)) status = SLAS_ZERO_WRITE_ERROR;
+    }
+
+  if (!status && out->copc)
+    {
+      uint64_t *offsets;
+
+      if ((offsets = (uint64_t *) malloc (laz->num_chunks * sizeof (uint64_t))) == NULL) return (SLAS_ZERO_MEMORY_ERROR);
+
+      offsets[0] = laz->chunk_offset[0];
+      for (uint32_t c = 1 ; c < laz->num_chunks ; c++) offsets[c] = offsets[c - 1] + out->chunk_bytes[c - 1];
+
+      if (slas_copc_update (out->tmp_fd, out->copc, laz->tail_offset, delta, offsets, out->chunk_bytes)) status = SLAS_ZERO_COPC_ERROR;
+
+      free (offsets);
+    }
+
+  return (status);
+}
+
+
+//  Grab the next block, from our own slice if there's anything left in it.  Call this with the pass mutex locked.
+//  Returns NVFalse when there's nothing left.
+
+static uint8_t next_block (ZERO_PASS *pass, int32_t slot, uint64_t *first, uint32_t *count)
+{
+  for (int32_t i = 0 ; i < pass->slices ; i++)
+    {
+      ZERO_CURSOR *slice = &pass->cursor[(slot + i) % pass->slices];
+
+      while (slice->range < slice->last && slice->next >= pass->ranges[slice->range].end)
+        {
+          if (++slice->range < slice->last) slice->next = pass->ranges[slice->range].first;
+        }
+
+      if (slice->range < slice->last)
+        {
+          *first = slice->next;
+          *count = (uint32_t) qMin ((uint64_t) pass->block_size, pass->ranges[slice->range].end - *first);
+          slice->next += *count;
+
+          return (NVTrue);
+        }
+    }
+
+  return (NVFalse);
+}
+
+
+//  Process blocks until we run out or somebody hits an error.  This is run by every worker thread (or by the caller
+//  if we're only using one thread).  Workers start on their own slice (and NUMA node when there's more than one).
+
+static void zero_blocks (ZERO_PASS *pass, int32_t slot)
+{
+  SLAS_CONTEXT     *ctx = pass->ctx;
+  SLAS_ZERO_STATS  stats;
+  uint8_t          *buffer;
+  uint64_t         first;
+  uint32_t         count;
+  int32_t          status = SLAS_ZERO_SUCCESS;
+
+
+  memset (&stats, 0, sizeof (SLAS_ZERO_STATS));
+
+
+  //  Runs of changed records that are closer together than a page are written as one.
+
+  int32_t merge_gap = 4096 / ctx->record_length;
+  SLAS_GRID *grid = pass->options->grid;
+  SLAS_SELECTION *selection = &pass->options->selection;
+  SLAS_EXTRA_RULES *extra = pass->extra;
+  float threshold = pass->options->threshold;
+
+
+  //  Get onto our node before allocating anything so that the buffers come from local memory.
+
+  if (pass->slices > 1) slas_numa_bind (pass->options->numa, slot);
+
+  QElapsedTimer timer;
+  timer.start ();
+
+
+  if ((buffer = (uint8_t *) malloc ((size_t) pass->block_size * ctx->record_length)) == NULL)
+    {
+      QMutexLocker lock (&pass->mutex);
+      if (!pass->status) pass->status = SLAS_ZERO_MEMORY_ERROR;
+      return;
+    }
+
+
+  //  Touch the block buffer now so its pages are placed on this node up front.
+
+  if (pass->slices > 1) memset (buffer, 0, (size_t) pass->block_size * ctx->record_length);
+
+
+  //  QA statistics are gathered per thread and added up at the end.
+
+  SLAS_QA *qa = NULL;
+
+  if (pass->options->qa)
+    {
+      if ((qa = (SLAS_QA *) malloc (sizeof (SLAS_QA))) == NULL)
+        {
+          free (buffer);
+
+          QMutexLocker lock (&pass->mutex);
+          if (!pass->status) pass->status = SLAS_ZERO_MEMORY_ERROR;
+          return;
+        }
+
+      memcpy (qa, pass->options->qa, sizeof (SLAS_QA));
+      slas_qa_clear (qa);
+    }
+
+
+  //  With a threshold grid each thread gets its own tile cache and the thresholds are interpolated a block at a time.
+
+  SLAS_GRID_CACHE grid_cache;
+  double *grid_x = NULL, *grid_y = NULL;
+  float *thresholds = NULL;
+
+  if (grid)
+    {
+      grid_x = (double *) malloc (pass->block_size * sizeof (double));
+      grid_y = (double *) malloc (pass->block_size * sizeof (double));
+      thresholds = (float *) malloc (pass->block_size * sizeof (float));
+
+      if (grid_x == NULL || grid_y == NULL || thresholds == NULL || slas_grid_init_cache (&grid_cache, grid, pass->grid_tiles))
+        {
+          free (buffer);
+          if (qa) free (qa);
+          if (grid_x) free (grid_x);
+          if (grid_y) free (grid_y);
+          if (thresholds) free (thresholds);
+
+          QMutexLocker lock (&pass->mutex);
+          if (!pass->status) pass->status = SLAS_ZERO_MEMORY_ERROR;
+          return;
+        }
+    }
+
+
+  //  With verification each thread checksums the records it reads (see slas_verify_records).
+
+  uint32_t *crcs = NULL;
+
+  if (pass->options->verify && (crcs = (uint32_t *) malloc (pass->block_size * sizeof (uint32_t))) == NULL)
+    {
+      free (buffer);
+      if (qa) free (qa);
+
+      if (grid)
+        {
+          slas_grid_free_cache (&grid_cache);
+          free (grid_x);
+          free (grid_y);
+          free (thresholds);
+        }
+
+      QMutexLocker lock (&pass->mutex);
+      if (!pass->status) pass->status = SLAS_ZERO_MEMORY_ERROR;
+      return;
+    }
+
+
+  SLAS_PERF_THREAD perf_thread, *perf = NULL;
+
+  if (pass->options->perf)
+    {
+      slas_perf_start (&perf_thread);
+      perf = &perf_thread;
+    }
+
+
+  ZERO_CHUNKER chunker;
+
+  memset (&chunker, 0, sizeof (ZERO_CHUNKER));
+
+
+  while (1)
+    {
+      //  Grab the next block.
+
+      pass->mutex.lock ();
+
+      if (pass->status || !next_block (pass, slot, &first, &count))
+        {
+          pass->mutex.unlock ();
+          break;
+        }
+
+      pass->mutex.unlock ();
+
+
+      //  A COPC node that's all at or below the threshold goes into the new file as it is, without being decoded.  One
+      //  that's all above it only needs its flags decoded since every point in it gets withheld.
+
+      uint8_t state = SLAS_COPC_STRADDLE;
+
+      if (pass->laz && pass->laz->chunk_state) state = pass->laz->chunk_state[slas_laz_find_chunk (&pass->laz->laz, first)];
+
+      if (state == SLAS_COPC_BELOW)
+        {
+          status = write_chunk (pass, &chunker, first, count, buffer, NVFalse, &stats, perf);
+
+          slas_perf_phase (perf, -1);
+
+          if (status) break;
+
+
+          pass->mutex.lock ();
+
+          pass->done += count;
+          if (pass->options->progress) (*pass->options->progress) (pass->done, pass->total, pass->options->user_data);
+
+          pass->mutex.unlock ();
+
+          continue;
+        }
+
+
+      slas_throttle_wait (pass->options->throttle, SLAS_THROTTLE_READ, (uint64_t) count * ctx->record_length);
+
+      slas_perf_phase (perf, SLAS_PERF_DECODE);
+
+      if (state == SLAS_COPC_ABOVE)
+        {
+          if ((status = read_chunk (pass, &chunker.flags_reader, pass->laz->path, LASZIP_DECOMPRESS_SELECTIVE_FLAGS, first, count, buffer)))
+            break;
+        }
+      else if (pass->laz)
+        {
+          if ((status = read_chunk (pass, &chunker.reader, pass->laz->path, pass->laz->layers, first, count, buffer))) break;
+        }
+      else
+        {
+          if (slas_ctx_read_records (ctx, first, count, buffer))
+            {
+              status = SLAS_ZERO_READ_ERROR;
+              break;
+            }
+
+          stats.bytes_read += (uint64_t) count * ctx->record_length;
+        }
+
+      stats.records += count;
+
+      if (crcs) slas_verify_records (ctx, first, count, buffer, crcs);
+
+
+      if (grid)
+        {
+          for (uint32_t i = 0 ; i < count ; i++) point_xy (ctx, &buffer[(size_t) i * ctx->record_length], &grid_x[i], &grid_y[i]);
+
+          if (slas_grid_interpolate (&grid_cache, count, grid_x, grid_y, thresholds))
+            {
+              status = SLAS_ZERO_GRID_ERROR;
+              break;
+            }
+        }
+
+
+      slas_perf_phase (perf, SLAS_PERF_PREDICATE);
+
+
+      int32_t run_start = -1, run_end = -1;
+      uint64_t withheld = stats.withheld;
+
+      for (uint32_t i = 0 ; i < count ; i++)
+        {
+          uint8_t *data = &buffer[(size_t) i * ctx->record_length];
+
+          if ((selection->source_ids || selection->time_range) && !point_selected (ctx, selection, data)) continue;
+
+          if (grid) threshold = thresholds[i] + pass->options->threshold;
+
+          if (state == SLAS_COPC_ABOVE || point_z (ctx, data) > threshold || (extra && extra_match (ctx, extra, pass->extra_dim, data)))
+            {
+              if (data[ctx->flags_offset] & ctx->withheld_mask)
+                {
+                  stats.already_withheld++;
+                  continue;
+                }
+
+              data[ctx->flags_offset] |= ctx->withheld_mask;
+              stats.withheld++;
+
+
+              //  The archive (or the new LAZ chunk) gets the whole block, there's nothing to write back.
+
+              if (pass->archive || pass->laz) continue;
+
+              if (run_start >= 0 && (int32_t) i - run_end > merge_gap)
+                {
+                  if ((status = flush_run (pass, first, buffer, run_start, run_end, &stats, perf))) break;
+                  run_start = -1;
+                }
+
+              if (run_start < 0) run_start = i;
+              run_end = i;
+            }
+        }
+
+      if (!status && run_start >= 0) status = flush_run (pass, first, buffer, run_start, run_end, &stats, perf);
+
+      if (qa && !status) slas_qa_accumulate (qa, ctx, buffer, count);
+
+      if (pass->archive && !status) status = archive_block (pass, &chunker, first, count, buffer, &stats, perf);
+
+      if (pass->laz && !status) status = write_chunk (pass, &chunker, first, count, buffer, stats.withheld > withheld, &stats, perf);
+
+      slas_perf_phase (perf, -1);
+
+      if (status) break;
+
+
+      pass->mutex.lock ();
+
+      pass->done += count;
+      if (crcs) slas_verify_fold (pass->options->verify, first, count, crcs, NVFalse);
+      if (pass->options->progress) (*pass->options->progress) (pass->done, pass->total, pass->options->user_data);
+
+      pass->mutex.unlock ();
+    }
+
+
+  free (buffer);
+  if (crcs) free (crcs);
+  close_chunker (&chunker);
+
+  if (grid)
+    {
+      slas_grid_free_cache (&grid_cache);
+      free (grid_x);
+      free (grid_y);
+      free (thresholds);
+    }
+
+
+  //  If we quit holding a block nobody after us will ever get a turn at the new file.
+
+  if (status && (pass->archive || pass->laz))
+    {
+      QMutexLocker write_lock (&pass->write_mutex);
+
+      pass->write_abort = NVTrue;
+      pass->write_turn.wakeAll ();
+    }
+
+
+  QMutexLocker lock (&pass->mutex);
+
+  if (status && !pass->status) pass->status = status;
+
+  pass->stats.records += stats.records;
+  pass->stats.withheld += stats.withheld;
+  pass->stats.already_withheld += stats.already_withheld;
+  pass->stats.bytes_read += stats.bytes_read;
+  pass->stats.bytes_written += stats.bytes_written;
+
+  pass->slice_records[slot] += stats.records;
+  pass->slice_seconds[slot] = qMax (pass->slice_seconds[slot], (double) timer.elapsed () / 1000.0);
+
+  if (qa)
+    {
+      slas_qa_merge (pass->options->qa, qa);
+      free (qa);
+    }
+
+  if (perf)
+    {
+      perf->counts.points = stats.records;
+      slas_perf_stop (perf, pass->options->perf);
+    }
+}
+
+
+//  Read back the records the pass read and checksum them again.  Like zero_blocks this is run by every worker thread
+//  (or the caller).
+
+static void verify_blocks (ZERO_PASS *pass, int32_t slot)
+{
+  SLAS_CONTEXT  *ctx = pass->ctx;
+  uint8_t       *buffer;
+  uint32_t      *crcs, count;
+  uint64_t      first;
+  int32_t       status = SLAS_ZERO_SUCCESS;
+
+
+  if (pass->slices > 1) slas_numa_bind (pass->options->numa, slot);
+
+  buffer = (uint8_t *) malloc ((size_t) pass->block_size * ctx->record_length);
+  crcs = (uint32_t *) malloc (pass->block_size * sizeof (uint32_t));
+
+  if (buffer == NULL || crcs == NULL)
+    {
+      if (buffer) free (buffer);
+      if (crcs) free (crcs);
+
+      QMutexLocker lock (&pass->mutex);
+      if (!pass->status) pass->status = SLAS_ZERO_MEMORY_ERROR;
+      return;
+    }
+
+
+  //  A rewritten LAZ file is read back from the new file (or the old one if nothing changed), all of it but the COPC
+  //  nodes that were copied without being read.
+
+  ZERO_CHUNKER chunker;
+  const char *path = NULL;
+
+  memset (&chunker, 0, sizeof (ZERO_CHUNKER));
+
+  if (pass->laz) path = pass->laz->changed ? pass->laz->tmp_file : pass->laz->path;
+
+
+  while (1)
+    {
+      pass->mutex.lock ();
+
+      if (pass->status || !next_block (pass, slot, &first, &count))
+        {
+          pass->mutex.unlock ();
+          break;
+        }
+
+      pass->mutex.unlock ();
+
+
+      if (path && pass->laz->chunk_state && pass->laz->chunk_state[slas_laz_find_chunk (&pass->laz->laz, first)] == SLAS_COPC_BELOW)
+        continue;
+
+      slas_throttle_wait (pass->options->throttle, SLAS_THROTTLE_READ, (uint64_t) count * ctx->record_length);
+
+      if (path)
+        {
+          if ((status = read_chunk (pass, &chunker.reader, path, LASZIP_DECOMPRESS_SELECTIVE_ALL, first, count, buffer))) break;
+        }
+      else if (slas_ctx_read_records (ctx, first, count, buffer))
+        {
+          status = SLAS_ZERO_READ_ERROR;
+          break;
+        }
+
+      slas_verify_records (ctx, first, count, buffer, crcs);
+
+
+      QMutexLocker lock (&pass->mutex);
+
+      slas_verify_fold (pass->options->verify, first, count, crcs, NVTrue);
+    }
+
+
+  free (buffer);
+  free (crcs);
+  close_chunker (&chunker);
+
+  QMutexLocker lock (&pass->mutex);
+
+  if (status && !pass->status) pass->status = status;
+}
+
+
+//  Get what we've written out to storage and out of the page cache (length 0 is through the end of the file).
+
+static void drop_cache (int32_t fd, int64_t offset, int64_t length)
+{
+#ifndef NVWIN3X
+
+  fdatasync (fd);
+
+#ifdef POSIX_FADV_DONTNEED
+  posix_fadvise (fd, (off_t) offset, (off_t) length, POSIX_FADV_DONTNEED);
+#endif
+
+#endif
+}
+
+
+//  Reserve a single grid tile cache from the memory budget (for the one-thread estimate).  Returns the
+//  number of tiles to cache, or 0 if there isn't room for even a few.
+
+static int32_t reserve_grid_cache (SLAS_ZERO_OPTIONS *options, uint64_t *reserved)
+{
+  uint64_t tile_bytes = (uint64_t) SLAS_GRID_TILE * SLAS_GRID_TILE * sizeof (float);
+  uint64_t available = slas_memory_available (options->memory);
+  int32_t tiles = SLAS_GRID_CACHE_TILES;
+
+  while (tiles > 4 && tiles * tile_bytes > available) tiles /= 2;
+
+  *reserved = tiles * tile_bytes;
+
+  if (slas_memory_reserve (options->memory, *reserved))
+    {
+      *reserved = 0;
+      return (0);
+    }
+
+  return (tiles);
+}
+
+
+//  Memory one worker thread uses for a pass (block buffer, grid interpolation arrays and tile cache, QA statistics,
+//  and for a LAZ rewrite the old and new chunk, which won't be bigger than the records).
+
+static uint64_t pass_memory (ZERO_PASS *pass, SLAS_CONTEXT *ctx)
+{
+  uint64_t bytes = (uint64_t) pass->block_size * ctx->record_length;
+
+  //  The chunk as it was and the new one for a LAZ rewrite, the compressed chunk (which shouldn't be any bigger than
+  //  the records) for an archive.
+
+  if (pass->laz) bytes += 2 * (uint64_t) pass->block_size * ctx->record_length;
+  if (pass->archive) bytes += (uint64_t) pass->block_size * ctx->record_length;
+
+  if (pass->options->grid)
+    {
+      SLAS_GRID *grid = pass->options->grid;
+
+      bytes += (uint64_t) pass->block_size * (2 * sizeof (double) + sizeof (float));
+      bytes += (uint64_t) pass->grid_tiles * SLAS_GRID_TILE * SLAS_GRID_TILE * sizeof (float);
+      bytes += (uint64_t) grid->tile_cols * grid->tile_rows * sizeof (float *);
+    }
+
+  if (pass->options->qa) bytes += sizeof (SLAS_QA);
+
+  if (pass->options->verify) bytes += (uint64_t) pass->block_size * sizeof (uint32_t);
+
+  return (bytes);
+}
+
+
+//  Cut the ranges up into slices, one per NUMA node, with as many records in each slice as the node has workers for.
+//  Ranges that straddle a slice boundary are split in two.
+
+static int32_t slice_ranges (ZERO_PASS *pass, int32_t slices, int32_t threads)
+{
+  ZERO_RANGE *ranges;
+  uint32_t count = 0;
+  uint64_t seen = 0, boundary;
+  int32_t slice = 0, workers;
+
+
+  if ((ranges = (ZERO_RANGE *) malloc ((pass->num_ranges + slices) * sizeof (ZERO_RANGE))) == NULL) return (-1);
+
+
+  //  Slot s gets threads / slices workers, plus one of the leftovers if it's one of the first few.
+
+  workers = threads / slices + (threads % slices > 0);
+  boundary = pass->total * workers / threads;
+
+  pass->cursor[0].range = 0;
+
+  for (uint32_t r = 0 ; r < pass->num_ranges ; r++)
+    {
+      uint64_t first = pass->ranges[r].first;
+
+      while (first < pass->ranges[r].end)
+        {
+          while (slice < slices - 1 && seen >= boundary)
+            {
+              pass->cursor[slice].last = count;
+              slice++;
+              pass->cursor[slice].range = count;
+
+              workers += threads / slices + (threads % slices > slice);
+              boundary = pass->total * workers / threads;
+            }
+
+          uint64_t end = pass->ranges[r].end;
+          if (slice < slices - 1) end = qMin (end, first + (boundary - seen));
+
+          ranges[count].first = first;
+          ranges[count].end = end;
+          count++;
+
+          seen += end - first;
+          first = end;
+        }
+    }
+
+  pass->cursor[slice].last = count;
+
+  while (++slice < slices) pass->cursor[slice].range = pass->cursor[slice].last = count;
+
+
+  for (int32_t i = 0 ; i < slices ; i++) pass->cursor[i].next = (pass->cursor[i].range < count) ? ranges[pass->cursor[i].range].first : 0;
+
+  free (pass->ranges);
+  pass->ranges = ranges;
+  pass->num_ranges = count;
+  pass->slices = slices;
+
+  return (0);
+}
+
+
+class zero_worker : public QThread
+{
+public:
+
+  ZERO_PASS *pass;
+  int32_t   slot;
+  uint8_t   verify;
+
+protected:
+
+  void run ()
+  {
+    if (verify)
+      {
+        verify_blocks (pass, slot);
+      }
+    else
+      {
+        zero_blocks (pass, slot);
+      }
+  }
+};
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_zero_default_options
+
+ - Purpose:     Set the default slas_zero options (threshold of 0.0, one thread per core).
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - options        =    The SLAS_ZERO_OPTIONS to be initialized
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_zero_default_options (SLAS_ZERO_OPTIONS *options)
+{
+  memset (options, 0, sizeof (SLAS_ZERO_OPTIONS));
+
+  options->threshold = 0.0;
+  options->threads = 0;
+  options->block_size = SLAS_ZERO_BLOCK_SIZE;
+
+#ifdef NVWIN3X
+  strcpy (options->laszip, "laszip.exe");
+#else
+  strcpy (options->laszip, "laszip");
+#endif
+}
+
+
+
+//  The zeroing pass.  With an archive the records aren't written back, every block is compressed and goes into the
+//  LAZ archive (in order) instead (see archive_file).  With laz the records come from the chunks of a LAZ file and the
+//  changed chunks go to a new file (see rewrite_laz).
+
+static int32_t zero_context (SLAS_CONTEXT *ctx, SLAS_ZERO_OPTIONS *options, SLAS_ZERO_STATS *stats, ZERO_ARCHIVE *archive, ZERO_LAZ *laz)
+{
+  ZERO_PASS          pass;
+  QElapsedTimer      timer;
+  int32_t            threads;
+  SLAS_ZERO_OPTIONS  whole_options;
+
+
+  timer.start ();
+
+  memset (stats, 0, sizeof (SLAS_ZERO_STATS));
+
+  if (!options->block_size) options->block_size = SLAS_ZERO_BLOCK_SIZE;
+
+
+  //  The archive (or the new LAZ file) has to get every record, so no skipping with the index or the COPC hierarchy (a
+  //  LAZ rewrite copies the COPC nodes it can skip, see ZERO_LAZ).  There's nothing to read back for an archive either
+  //  (the LAS file isn't changed).
+
+  if (archive || laz)
+    {
+      if (options->first_record || (options->num_records && options->num_records != ctx->number_of_points)) return (SLAS_ZERO_RANGE_ERROR);
+
+      whole_options = *options;
+      whole_options.index = NULL;
+      whole_options.copc = NULL;
+      if (archive) whole_options.verify = NULL;
+      options = &whole_options;
+    }
+
+  if (options->first_record > ctx->number_of_points ||
+      (options->num_records && options->num_records > ctx->number_of_points - options->first_record)) return (SLAS_ZERO_RANGE_ERROR);
+
+  if (options->selection.time_range && ctx->gps_time_offset < 0) return (SLAS_ZERO_SELECTION_ERROR);
+
+  pass.extra = (options->extra && options->extra->count) ? options->extra : NULL;
+
+  if (pass.extra && extra_dims (ctx, pass.extra, pass.extra_dim)) return (SLAS_ZERO_EXTRA_ERROR);
+
+
+  uint64_t start = options->first_record;
+  uint64_t end = options->num_records ? options->first_record + options->num_records : ctx->number_of_points;
+
+
+  //  Work out which ranges of records we need to look at.  Without an index (or a selection) that's everything from
+  //  start to end, otherwise it's the chunks that might have selected points in them (merged where they touch).  For a
+  //  COPC file it's the octree nodes that might have points above the threshold (there's no telling with a grid or
+  //  extra bytes rules).  QA statistics need every record so they turn both of those off.
+
+  SLAS_SELECTION *selection = &options->selection;
+  uint8_t use_copc = (options->copc && !options->grid && !pass.extra && !options->qa && slas_copc_valid (options->copc, ctx));
+  uint8_t use_index = (!use_copc && !options->qa && options->index && (selection->source_ids || selection->time_range) &&
+                       slas_index_valid (options->index, ctx));
+  uint32_t max_ranges = use_index ? qMax (options->index->num_chunks, (uint32_t) 1) : 1;
+
+  if (laz) max_ranges = qMax (laz->laz.num_chunks, (uint32_t) 1);
+
+  if (use_copc)
+    {
+      slas_copc_classify (options->copc, options->threshold, ctx->z_scale_factor);
+      max_ranges = qMax (options->copc->num_nodes, (uint32_t) 1);
+    }
+
+  if ((pass.ranges = (ZERO_RANGE *) malloc (max_ranges * sizeof (ZERO_RANGE))) == NULL) return (SLAS_ZERO_MEMORY_ERROR);
+
+  pass.num_ranges = 0;
+  pass.total = 0;
+
+
+  //  A LAZ rewrite goes a chunk at a time so every chunk gets its own range (and is one block).  COPC nodes at or below
+  //  the threshold still have to be copied to the new file but they count as skipped.
+
+  uint32_t largest_chunk = 0;
+  uint64_t skipped = 0;
+
+  if (laz)
+    {
+      for (uint32_t c = 0 ; c < laz->laz.num_chunks ; c++)
+        {
+          pass.ranges[c].first = laz->laz.chunk_first[c];
+          pass.ranges[c].end = laz->laz.chunk_first[c + 1];
+
+          largest_chunk = qMax (largest_chunk, (uint32_t) (pass.ranges[c].end - pass.ranges[c].first));
+
+          if (laz->chunk_state && laz->chunk_state[c] == SLAS_COPC_BELOW) skipped += pass.ranges[c].end - pass.ranges[c].first;
+        }
+
+      pass.num_ranges = laz->laz.num_chunks;
+      pass.total = end - start;
+    }
+  else if (use_copc)
+    {
+      SLAS_COPC *copc = options->copc;
+
+      for (uint32_t n = 0 ; n < copc->num_nodes ; n++)
+        {
+          SLAS_COPC_NODE *node = &copc->nodes[n];
+
+          uint64_t first = qMax (node->first_record, start);
+          uint64_t last = qMin (node->first_record + node->point_count, end);
+
+          if (first >= last || node->state == SLAS_COPC_BELOW) continue;
+
+          if (pass.num_ranges && pass.ranges[pass.num_ranges - 1].end == first)
+            {
+              pass.ranges[pass.num_ranges - 1].end = last;
+            }
+          else
+            {
+              pass.ranges[pass.num_ranges].first = first;
+              pass.ranges[pass.num_ranges].end = last;
+              pass.num_ranges++;
+            }
+
+          pass.total += last - first;
+        }
+    }
+  else if (use_index)
+    {
+      SLAS_INDEX *index = options->index;
+
+      for (uint32_t c = (uint32_t) (start / index->chunk_size) ; c < index->num_chunks ; c++)
+        {
+          uint64_t first = qMax ((uint64_t) c * index->chunk_size, start);
+          uint64_t last = qMin ((uint64_t) (c + 1) * index->chunk_size, end);
+
+          if (first >= last) break;
+
+          if (!slas_index_chunk_selected (index, c, selection)) continue;
+
+          if (pass.num_ranges && pass.ranges[pass.num_ranges - 1].end == first)
+            {
+              pass.ranges[pass.num_ranges - 1].end = last;
+            }
+          else
+            {
+              pass.ranges[pass.num_ranges].first = first;
+              pass.ranges[pass.num_ranges].end = last;
+              pass.num_ranges++;
+            }
+
+          pass.total += last - first;
+        }
+    }
+  else if (end > start)
+    {
+      pass.ranges[0].first = start;
+      pass.ranges[0].end = end;
+      pass.num_ranges = 1;
+      pass.total = end - start;
+    }
+
+  pass.ctx = ctx;
+  pass.options = options;
+  pass.slices = 1;
+  pass.cursor[0].range = 0;
+  pass.cursor[0].last = pass.num_ranges;
+  pass.cursor[0].next = pass.num_ranges ? pass.ranges[0].first : 0;
+  memset (pass.slice_records, 0, sizeof (pass.slice_records));
+  memset (pass.slice_seconds, 0, sizeof (pass.slice_seconds));
+  pass.done = 0;
+  pass.status = SLAS_ZERO_SUCCESS;
+  memset (&pass.stats, 0, sizeof (SLAS_ZERO_STATS));
+  pass.archive = archive;
+  pass.laz = laz;
+  pass.next_write = start;
+  pass.write_abort = NVFalse;
+
+
+  //  No point in having more threads than blocks.
+
+  threads = options->threads;
+  if (threads <= 0) threads = QThread::idealThreadCount ();
+  if (threads <= 0) threads = 1;
+
+  uint64_t blocks = laz ? pass.num_ranges : (pass.total + options->block_size - 1) / options->block_size;
+  if ((uint64_t) threads > blocks) threads = (int32_t) qMax ((uint64_t) 1, blocks);
+
+
+  //  Fit the pass into the memory budget.  Smaller blocks first (but a LAZ chunk can't be split), then fewer cached
+  //  grid tiles, then fewer threads.
+
+  pass.block_size = laz ? qMax (largest_chunk, (uint32_t) 1) : options->block_size;
+  pass.grid_tiles = SLAS_GRID_CACHE_TILES;
+
+  uint64_t reserved = 0;
+
+  for (int32_t attempt = 0 ; ; attempt++)
+    {
+      uint64_t available = slas_memory_available (options->memory);
+
+      while ((reserved = threads * pass_memory (&pass, ctx)) > available)
+        {
+          if (!laz && pass.block_size > SLAS_ZERO_MIN_BLOCK_SIZE)
+            {
+              pass.block_size = qMax (pass.block_size / 2, (uint32_t) SLAS_ZERO_MIN_BLOCK_SIZE);
+            }
+          else if (options->grid && pass.grid_tiles > 4)
+            {
+              pass.grid_tiles /= 2;
+            }
+          else if (threads > 1)
+            {
+              threads--;
+            }
+          else
+            {
+              break;
+            }
+        }
+
+      if (reserved <= available && !slas_memory_reserve (options->memory, reserved)) break;
+
+
+      //  Somebody else (another daemon job) may have gotten there first, so try again a few times before we give up.
+
+      if (reserved > available || attempt >= 8)
+        {
+          free (pass.ranges);
+          return (SLAS_ZERO_MEMORY_ERROR);
+        }
+    }
+
+
+  //  On a NUMA machine spread the workers evenly over the nodes and give each node its own part of the file.  If we
+  //  can't slice things up we just go on without it.  Not when writing an archive (or a LAZ file) though, the nodes
+  //  would spend most of their time waiting on each other for their turn at the new file.
+
+  if (options->numa && options->numa->num_nodes > 1 && threads > 1 && !archive && !laz)
+    slice_ranges (&pass, qMin (options->numa->num_nodes, threads), threads);
+
+
+  //  With verification the same ranges are gone over again after the pass to read the records back.  What we wrote is
+  //  flushed and dropped from the page cache first so that the read back comes from storage.
+
+  ZERO_CURSOR cursor[SLAS_NUMA_MAX_NODES];
+  QElapsedTimer verify_timer;
+
+  memcpy (cursor, pass.cursor, sizeof (cursor));
+
+  for (int32_t phase = 0 ; phase < (options->verify ? 2 : 1) && !pass.status ; phase++)
+    {
+      if (phase)
+        {
+          verify_timer.start ();
+
+          if (!laz)
+            {
+              drop_cache (ctx->fd, ctx->offset_to_point_data, (int64_t) (ctx->number_of_points * ctx->record_length));
+            }
+          else if (laz->changed)
+            {
+              drop_cache (laz->tmp_fd, 0, 0);
+            }
+
+          memcpy (pass.cursor, cursor, sizeof (cursor));
+        }
+
+
+      if (threads == 1)
+        {
+          if (phase)
+            {
+              verify_blocks (&pass, 0);
+            }
+          else
+            {
+              zero_blocks (&pass, 0);
+            }
+        }
+      else
+        {
+          zero_worker *workers = new zero_worker[threads];
+
+          for (int32_t i = 0 ; i < threads ; i++)
+            {
+              workers[i].pass = &pass;
+              workers[i].slot = i % pass.slices;
+              workers[i].verify = (uint8_t) phase;
+              workers[i].start ();
+            }
+
+          for (int32_t i = 0 ; i < threads ; i++) workers[i].wait ();
+
+          delete[] workers;
+        }
+
+
+      //  The new LAZ file has to be finished before it can be read back.
+
+      if (!phase && laz && !pass.status) pass.status = finish_laz (&pass);
+    }
+
+  if (options->verify && !pass.status)
+    {
+      options->verify->seconds = (double) verify_timer.elapsed () / 1000.0;
+
+      if (slas_verify_compare (options->verify)) pass.status = SLAS_ZERO_VERIFY_ERROR;
+    }
+
+
+  free (pass.ranges);
+
+  slas_memory_release (options->memory, reserved);
+
+
+  *stats = pass.stats;
+  stats->skipped = (end - start) - pass.total + skipped;
+  stats->seconds = (double) timer.elapsed () / 1000.0;
+
+  if (pass.slices > 1)
+    {
+      stats->nodes = pass.slices;
+
+      for (int32_t i = 0 ; i < pass.slices ; i++)
+        {
+          stats->node[i] = options->numa->node[i];
+          stats->node_records[i] = pass.slice_records[i];
+          stats->node_seconds[i] = pass.slice_seconds[i];
+        }
+    }
+
+
+  return (pass.status);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_zero_context
+
+ - Purpose:     Set the withheld bit on every point above the threshold in a LAS file that is
+                already open (with O_RDWR) and has a context.  The records are processed in
+                blocks, one positional read per block, and only the changed records are
+                written back.  If options->num_records is set only that range of records
+                (starting at options->first_record) is processed.  If there is a selection
+                only selected points are processed and, with a valid index, chunks with no
+                selected points aren't read at all.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - options        =    SLAS_ZERO_OPTIONS
+                - stats          =    Returned SLAS_ZERO_STATS
+
+ - Returns:     int32_t          =    SLAS_ZERO_SUCCESS or one of the SLAS_ZERO error codes
+
+*********************************************************************************************/
+
+int32_t slas_zero_context (SLAS_CONTEXT *ctx, SLAS_ZERO_OPTIONS *options, SLAS_ZERO_STATS *stats)
+{
+  return (zero_context (ctx, options, stats, NULL, NULL));
+}
+
+
+
+//  laszip always writes NAME.las (lower case) for NAME.laz or NAME.LAZ so we build the names from the base name.
+
+static QString swap_extension (const char *path, const char *ext)
+{
+  QString name (path);
+
+  return (name.left (name.length () - 4) + QString (ext));
+}
+
+
+static int32_t run_laszip (const char *laszip, QString &file)
+{
+  QProcess    zipper;
+  QStringList params;
+
+  params << file;
+
+  zipper.start (QString (laszip), params);
+
+  if (!zipper.waitForFinished (-1) || zipper.exitStatus () != QProcess::NormalExit || zipper.exitCode ()) return (SLAS_ZERO_LASZIP_ERROR);
+
+  return (SLAS_ZERO_SUCCESS);
+}
+
+
+
+//  Check that every COPC node is one chunk of the LAZ file, in the same order, and that the hierarchy is in the EVLRs
+//  (after the chunk table).  Otherwise we couldn't fix the hierarchy up after the chunks move.
+
+static uint8_t copc_chunks (SLAS_COPC *copc, SLAS_LAZ *laz)
+{
+  if (copc->num_nodes != laz->num_chunks || copc->root_hier_offset < laz->tail_offset) return (NVFalse);
+
+  for (uint32_t c = 0 ; c < laz->num_chunks ; c++)
+    {
+      SLAS_COPC_NODE *node = &copc->nodes[c];
+
+      if (node->offset != laz->chunk_offset[c] || (uint64_t) node->byte_size != laz->chunk_offset[c + 1] - laz->chunk_offset[c] ||
+          node->first_record != laz->chunk_first[c] || (uint64_t) node->point_count != laz->chunk_first[c + 1] - laz->chunk_first[c])
+        return (NVFalse);
+    }
+
+  return (NVTrue);
+}
+
+
+
+//  Set the withheld bits of a LAZ file with one of the LAS 1.4 point formats (6 through 10) without a laszip round
+//  trip.  LASzip compresses each field (layer) of those separately, so the workers only decode the Z and flags layers
+//  (plus whatever the selection and extra bytes rules need) and only the chunks that have points to change get their
+//  flags layer encoded again, the rest of the file is copied as it is.  The new file replaces the old one only if
+//  something changed.  A COPC file (copc isn't NULL) stays a COPC file, the hierarchy gets the new chunk offsets and
+//  sizes, and nodes that are clear of the threshold aren't checked point by point.  Returns 1, having done nothing,
+//  if the file doesn't have the chunk table we need (then it has to go the long way).  That isn't an option for a
+//  COPC file (laszip would write a plain LAZ file) so that's SLAS_ZERO_COPC_ERROR.
+
+static int32_t rewrite_laz (const char *path, SLAS_ZERO_OPTIONS *options, SLAS_ZERO_STATS *stats, SLAS_COPC *copc)
+{
+  LASheader       lasheader;
+  SLAS_CONTEXT    ctx;
+  ZERO_LAZ        laz;
+  struct stat     st;
+  int32_t         status;
+  SLAS_SELECTION  *selection = &options->selection;
+  uint8_t         extra = (options->extra && options->extra->count);
+
+
+  memset (&laz, 0, sizeof (ZERO_LAZ));
+
+  if (strlen (path) >= 1024) return (SLAS_ZERO_OPEN_ERROR);
+
+  sprintf (laz.tmp_file, "%s.tmp", path);
+
+
+  if ((laz.fd = open (path, O_RDONLY | O_BINARY)) < 0) return (SLAS_ZERO_OPEN_ERROR);
+
+  if (slas_read_header (laz.fd, &lasheader, NULL))
+    {
+      close (laz.fd);
+      return (SLAS_ZERO_HEADER_ERROR);
+    }
+
+  if ((status = slas_laz_read (laz.fd, &lasheader, options->memory, &laz.laz)) || !laz.laz.layered)
+    {
+      slas_laz_free (&laz.laz);
+      close (laz.fd);
+
+      if (status == -2) return (SLAS_ZERO_MEMORY_ERROR);
+
+      return (copc ? SLAS_ZERO_COPC_ERROR : 1);
+    }
+
+
+  //  We can only skip COPC nodes by their Z extent if the threshold is the same everywhere and nothing else can withhold
+  //  a point, and QA statistics need every record anyway.
+
+  uint8_t prune = (copc && !options->grid && !extra && !options->qa);
+
+
+  //  The new chunk sizes (and the node states) come out of the memory budget along with the chunk table.
+
+  uint64_t reserved = (uint64_t) (laz.laz.num_chunks + 1) * (sizeof (uint64_t) + (prune ? 1 : 0));
+
+
+  laz.tmp_fd = -1;
+
+  if (slas_init_context (&ctx, laz.fd, &lasheader, big_endian ()))
+    {
+      status = SLAS_ZERO_FORMAT_ERROR;
+    }
+  else if (extra && slas_ctx_read_extra_bytes (&ctx, &lasheader) < 0)
+    {
+      status = SLAS_ZERO_HEADER_ERROR;
+    }
+  else if (copc && !copc_chunks (copc, &laz.laz))
+    {
+      status = SLAS_ZERO_COPC_ERROR;
+    }
+  else if (slas_memory_reserve (options->memory, reserved))
+    {
+      reserved = 0;
+      status = SLAS_ZERO_MEMORY_ERROR;
+    }
+  else if ((options->verify && slas_verify_init (options->verify, &ctx, options->memory)) ||
+           (laz.chunk_bytes = (uint64_t *) calloc (laz.laz.num_chunks + 1, sizeof (uint64_t))) == NULL ||
+           (prune && (laz.chunk_state = (uint8_t *) malloc (laz.laz.num_chunks + 1)) == NULL))
+    {
+      status = SLAS_ZERO_MEMORY_ERROR;
+    }
+  else if (fstat (laz.fd, &st) || (laz.tmp_fd = open (laz.tmp_file, O_RDWR | O_CREAT | O_TRUNC | O_BINARY, st.st_mode & 0777)) < 0)
+    {
+      status = SLAS_ZERO_OPEN_ERROR;
+    }
+  else
+    {
+      //  QA statistics and verification need whole records.
+
+      laz.layers = LASZIP_DECOMPRESS_SELECTIVE_Z | LASZIP_DECOMPRESS_SELECTIVE_FLAGS;
+
+      if (selection->source_ids) laz.layers |= LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE;
+      if (selection->time_range) laz.layers |= LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME;
+      if (extra) laz.layers |= LASZIP_DECOMPRESS_SELECTIVE_EXTRA_BYTES;
+      if (options->qa || options->verify) laz.layers = LASZIP_DECOMPRESS_SELECTIVE_ALL;
+
+      if (options->qa) slas_qa_init (options->qa, &ctx, lasheader.min_z, lasheader.max_z);
+
+
+      //  Nodes above the threshold still have to be read whole for verification or a selection.
+
+      if (prune)
+        {
+          slas_copc_classify (copc, options->threshold, lasheader.z_scale_factor);
+
+          for (uint32_t c = 0 ; c < laz.laz.num_chunks ; c++)
+            {
+              laz.chunk_state[c] = copc->nodes[c].state;
+
+              if (laz.chunk_state[c] == SLAS_COPC_ABOVE && (options->verify || selection->source_ids || selection->time_range))
+                laz.chunk_state[c] = SLAS_COPC_STRADDLE;
+            }
+        }
+
+      laz.copc = copc;
+
+      laz.lasheader = &lasheader;
+      laz.path = path;
+      laz.offset = laz.laz.chunk_offset[0];
+
+      status = zero_context (&ctx, options, stats, NULL, &laz);
+
+      close (laz.tmp_fd);
+    }
+
+  slas_laz_free (&laz.laz);
+  if (laz.chunk_bytes) free (laz.chunk_bytes);
+  if (laz.chunk_state) free (laz.chunk_state);
+  slas_memory_release (options->memory, reserved);
+  close (laz.fd);
+
+
+  if (status || !laz.changed)
+    {
+      if (laz.tmp_fd >= 0) QFile::remove (QString (laz.tmp_file));
+      return (status);
+    }
+
+  if (!QFile::remove (QString (path)))
+    {
+      QFile::remove (QString (laz.tmp_file));
+      return (SLAS_ZERO_REMOVE_ERROR);
+    }
+
+  if (!QFile::rename (QString (laz.tmp_file), QString (path))) return (SLAS_ZERO_RENAME_ERROR);
+
+
+  return (SLAS_ZERO_SUCCESS);
+}
+
+
+
+//  Finish the archive once every chunk is in.  That's the header and VLRs of the LAS file with the laszip VLR added
+//  after the last VLR (and the header changed to match), the offset of the chunk table, the table itself, and whatever
+//  followed the points in the LAS file (the EVLRs) with the header offsets that point at it moved.
+
+static int32_t finish_archive (ZERO_ARCHIVE *archive, SLAS_CONTEXT *ctx, SLAS_ZERO_STATS *stats)
+{
+  LASheader        *lasheader = archive->lasheader;
+  SLAS_LAZ_BUFFER  table;
+  uint8_t          value[8];
+  int32_t          status = SLAS_ZERO_SUCCESS;
+
+
+  memset (&table, 0, sizeof (SLAS_LAZ_BUFFER));
+
+  if (slas_laz_chunk_table (&archive->laz, archive->chunk_points, archive->chunk_bytes, archive->num_chunks, &table))
+    {
+      slas_laz_buffer_free (&table);
+      return (SLAS_ZERO_ARCHIVE_ERROR);
+    }
+
+
+  uint64_t point_data = (uint64_t) lasheader->offset_to_point_data + archive->vlr.size;
+  uint64_t tail = (uint64_t) lasheader->offset_to_point_data + ctx->number_of_points * ctx->record_length;
+  uint64_t file_size = (uint64_t) lseek (archive->fd, 0, SEEK_END);
+  uint64_t tail_size = file_size > tail ? file_size - tail : 0;
+  uint64_t new_tail = archive->offset + table.size;
+  int64_t delta = (int64_t) new_tail - (int64_t) tail;
+
+  put_u64 (value, archive->offset);
+
+  if (copy_range (archive->fd, 0, archive->tmp_fd, 0, archive->vlr_end) ||
+      slas_pwrite (archive->tmp_fd, archive->vlr.data, archive->vlr.size, archive->vlr_end) ||
+      copy_range (archive->fd, archive->vlr_end, archive->tmp_fd, archive->vlr_end + archive->vlr.size,
+                  lasheader->offset_to_point_data - archive->vlr_end) ||
+      slas_pwrite (archive->tmp_fd, value, 8, point_data) || slas_pwrite (archive->tmp_fd, table.data, table.size, archive->offset) ||
+      copy_range (archive->fd, tail, archive->tmp_fd, new_tail, tail_size))
+    status = SLAS_ZERO_WRITE_ERROR;
+
+  stats->bytes_written += point_data + 8 + table.size + tail_size;
+
+  slas_laz_buffer_free (&table);
+
+
+  //  One more VLR, the points start after it, and they're compressed.
+
+  if (!status)
+    {
+      uint8_t head[9];
+
+      put_u64 (value, point_data);
+      memcpy (head, value, 4);
+      put_u64 (value, lasheader->number_of_variable_length_records + 1);
+      memcpy (&head[4], value, 4);
+      head[8] = lasheader->point_data_format | 0x80;
+
+      if (slas_pwrite (archive->tmp_fd, head, 9, 96)) status = SLAS_ZERO_WRITE_ERROR;
+    }
+
+
+  //  The EVLRs (and the waveform data of a LAS 1.3 file) moved.
+
+  if (!status && lasheader->version_minor >= 4 && lasheader->number_of_extended_variable_length_records &&
+      lasheader->start_of_first_extended_variable_length_record >= tail)
+    {
+      put_u64 (value, lasheader->start_of_first_extended_variable_length_record + delta);
+      if (slas_pwrite (archive->tmp_fd, value, 8, 235)) status = SLAS_ZERO_WRITE_ERROR;
+    }
+
+  if (!status && lasheader->version_minor >= 3 && lasheader->start_of_waveform_data_packet_record >= tail)
+    {
+      put_u64 (value, lasheader->start_of_waveform_data_packet_record + delta);
+      if (slas_pwrite (archive->tmp_fd, value, 8, 227)) status = SLAS_ZERO_WRITE_ERROR;
+    }
+
+  return (status);
+}
+
+
+
+//  Read a LAS file and write the result straight to a LAZ file (options->archive) in the same pass.  The LAS file is
+//  opened read only and is never changed.  The workers do the reading and checking, compress their own blocks (one
+//  LAZ chunk each), and take turns (in record order) adding them to the archive.  The archive is written to a
+//  temporary file that replaces options->archive only if everything worked.
+
+static int32_t archive_file (const char *path, SLAS_ZERO_OPTIONS *options, SLAS_ZERO_STATS *stats)
+{
+  LASheader       lasheader;
+  SLAS_CONTEXT    ctx;
+  ZERO_ARCHIVE    archive;
+  SLAS_VLR        *vlrs;
+  struct stat     st;
+  int32_t         count, status;
+
+
+  memset (&archive, 0, sizeof (ZERO_ARCHIVE));
+
+  if (strlen (options->archive) >= 1024) return (SLAS_ZERO_OPEN_ERROR);
+
+  sprintf (archive.tmp_file, "%s.tmp", options->archive);
+
+
+  if ((archive.fd = open (path, O_RDONLY | O_BINARY)) < 0) return (SLAS_ZERO_OPEN_ERROR);
+
+  if (slas_read_header (archive.fd, &lasheader, NULL) || slas_read_vlrs (archive.fd, &lasheader, &vlrs, &count))
+    {
+      close (archive.fd);
+      return (SLAS_ZERO_HEADER_ERROR);
+    }
+
+
+  //  The laszip VLR goes after the last VLR (anything the LAS file has between the VLRs and the points stays after it).
+
+  archive.vlr_end = lasheader.header_size;
+
+  for (int32_t i = 0 ; i < count ; i++)
+    {
+      if (!vlrs[i].extended) archive.vlr_end = qMax (archive.vlr_end, (uint64_t) vlrs[i].data_offset + vlrs[i].record_length);
+    }
+
+  free (vlrs);
+
+
+  archive.tmp_fd = -1;
+
+  if (archive.vlr_end > lasheader.offset_to_point_data || (lasheader.point_data_format & 0xc0))
+    {
+      status = SLAS_ZERO_HEADER_ERROR;
+    }
+  else if (slas_init_context (&ctx, archive.fd, &lasheader, big_endian ()))
+    {
+      status = SLAS_ZERO_FORMAT_ERROR;
+    }
+  else if (options->extra && options->extra->count && slas_ctx_read_extra_bytes (&ctx, &lasheader) < 0)
+    {
+      status = SLAS_ZERO_HEADER_ERROR;
+    }
+  else if (slas_laz_init (&archive.laz, lasheader.point_data_format, lasheader.point_data_record_length) ||
+           slas_laz_vlr (&archive.laz, &archive.vlr) || (uint64_t) lasheader.offset_to_point_data + archive.vlr.size > 0xffffffff)
+    {
+      status = SLAS_ZERO_ARCHIVE_ERROR;
+    }
+  else if (fstat (archive.fd, &st) ||
+           (archive.tmp_fd = open (archive.tmp_file, O_RDWR | O_CREAT | O_TRUNC | O_BINARY, st.st_mode & 0777)) < 0)
+    {
+      status = SLAS_ZERO_OPEN_ERROR;
+    }
+  else
+    {
+      if (options->qa) slas_qa_init (options->qa, &ctx, lasheader.min_z, lasheader.max_z);
+
+      archive.lasheader = &lasheader;
+      archive.offset = (uint64_t) lasheader.offset_to_point_data + archive.vlr.size + 8;
+
+      status = zero_context (&ctx, options, stats, &archive, NULL);
+
+      if (!status) status = finish_archive (&archive, &ctx, stats);
+
+      close (archive.tmp_fd);
+    }
+
+  slas_laz_free (&archive.laz);
+  slas_laz_buffer_free (&archive.vlr);
+  free (archive.chunk_points);
+  free (archive.chunk_bytes);
+  close (archive.fd);
+
+
+  if (status)
+    {
+      if (archive.tmp_fd >= 0) QFile::remove (QString (archive.tmp_file));
+      return (status);
+    }
+
+  if (QFile::exists (QString (options->archive)) && !QFile::remove (QString (options->archive)))
+    {
+      QFile::remove (QString (archive.tmp_file));
+      return (SLAS_ZERO_REMOVE_ERROR);
+    }
+
+  if (!QFile::rename (QString (archive.tmp_file), QString (options->archive))) return (SLAS_ZERO_RENAME_ERROR);
+
+
+  return (SLAS_ZERO_SUCCESS);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_zero_file
+
+ - Purpose:     Set the withheld bit on every point above the threshold in a LAS or LAZ file.
+                LAZ files with point formats 6 through 10 are updated a chunk at a time,
+                decompressing only the layers the predicate needs and encoding only the
+                flags layer of the chunks that change again (they're left alone if no
+                point changes).  Other LAZ files are uncompressed with laszip, updated,
+                and recompressed.  COPC files are checked against the octree hierarchy
+                first and are left alone if no node can have a point above the threshold
+                (not done with extra bytes rules).  Otherwise they're updated a chunk at
+                a time like other LAZ files (skipping the nodes below the threshold) and
+                the hierarchy is fixed up so that they stay COPC files.  A COPC file that
+                can't be updated that way (or is to be sorted) is left alone and is an
+                error.  If options->sort is set the points
+                of a LAZ file are uncompressed with laszip and put in Morton order before
+                it is recompressed (see slas_sort_file).  If options->archive
+                is set a LAS file is left alone and the result (every record, withheld
+                or not) is compressed to the options->archive LAZ file in the same pass.
+                It's ignored for LAZ files.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - path           =    LAS or LAZ file name
+                - options        =    SLAS_ZERO_OPTIONS
+                - stats          =    Returned SLAS_ZERO_STATS
+
+ - Returns:     int32_t          =    SLAS_ZERO_SUCCESS or one of the SLAS_ZERO error codes
+
+*********************************************************************************************/
+
+int32_t slas_zero_file (const char *path, SLAS_ZERO_OPTIONS *options, SLAS_ZERO_STATS *stats)
+{
+  LASheader          lasheader;
+  SLAS_CONTEXT       ctx;
+  int32_t            fd, status, copc_status = 0;
+  uint8_t            laz;
+  char               las_file[1024];
+  QString            fileLAS, fileLAZ;
+  SLAS_COPC          copc;
+  uint8_t            extra = (options->extra && options->extra->count);
+
+
+  memset (stats, 0, sizeof (SLAS_ZERO_STATS));
+
+  laz = (QString (path).endsWith (".laz") || QString (path).endsWith (".LAZ"));
+
+  if (strlen (path) >= sizeof (las_file)) return (SLAS_ZERO_OPEN_ERROR);
+
+  if (!laz && options->archive) return (archive_file (path, options, stats));
+
+
+  if (laz)
+    {
+      //  The header isn't compressed so we can check it before we go to the trouble of unzipping the file.
+
+      if ((fd = open (path, O_RDONLY | O_BINARY)) < 0) return (SLAS_ZERO_OPEN_ERROR);
+
+      status = slas_read_header (fd, &lasheader, NULL);
+      if (!status) copc_status = slas_copc_read (fd, &lasheader, options->memory, &copc);
+      close (fd);
+
+      if (status) return (SLAS_ZERO_HEADER_ERROR);
+
+
+      //  Record ranges only make sense for LAS files (the whole LAZ file gets rewritten) so the only range we'll take
+      //  is the whole file.
+
+      uint64_t points = lasheader.number_of_point_records;
+      if (lasheader.version_minor >= 4 && lasheader.extended_number_of_point_records) points = lasheader.extended_number_of_point_records;
+
+      if (options->first_record || (options->num_records && options->num_records != points))
+        {
+          if (copc_status > 0) slas_copc_free (&copc);
+          return (SLAS_ZERO_RANGE_ERROR);
+        }
+
+
+      //  A COPC file is only ever updated in place, chunk by chunk, so that it stays a COPC file (laszip would write a
+      //  plain LAZ file).  The hierarchy has to account for every point in the file before we trust it with anything.
+      //  Then we can tell from the hierarchy alone whether any point could be above the threshold, if none can we're
+      //  done without decompressing anything.  Sorting would move points between the nodes so that's out.
+
+      if (copc_status == -2) return (SLAS_ZERO_MEMORY_ERROR);
+
+      if (copc_status < 0 || (copc_status > 0 && copc.num_points != points))
+        {
+          if (copc_status > 0) slas_copc_free (&copc);
+          return (SLAS_ZERO_COPC_ERROR);
+        }
+
+      if (copc_status > 0)
+        {
+          if (options->sort != NULL)
+            {
+              status = SLAS_ZERO_COPC_ERROR;
+            }
+          else if (!options->grid && !extra && !options->qa && !slas_copc_classify (&copc, options->threshold, lasheader.z_scale_factor))
+            {
+              stats->skipped = points;
+              status = SLAS_ZERO_SUCCESS;
+            }
+          else
+            {
+              status = rewrite_laz (path, options, stats, &copc);
+            }
+
+          slas_copc_free (&copc);
+          return (status);
+        }
+
+
+      //  Formats 6 through 10 are layered so only the flags layer of the chunks that change has to be encoded again.
+      //  Not if we're sorting though, that needs the whole file uncompressed.
+
+      if ((lasheader.point_data_format & 0x3f) >= 6 && options->sort == NULL && (status = rewrite_laz (path, options, stats, NULL)) <= 0)
+        return (status);
+
+
+      char lz_name[1024];
+
+      strcpy (lz_name, options->laszip);
+
+      if (find_startup_name (lz_name) == NULL) return (SLAS_ZERO_LASZIP_ERROR);
+
+
+      fileLAZ = QString (path);
+      fileLAS = swap_extension (path, ".las");
+
+      if (run_laszip (options->laszip, fileLAZ)) return (SLAS_ZERO_LASZIP_ERROR);
+
+      strcpy (las_file, fileLAS.toLatin1 ());
+    }
+  else
+    {
+      strcpy (las_file, path);
+    }
+
+
+  if ((fd = open (las_file, O_RDWR | O_BINARY)) < 0)
+    {
+      status = SLAS_ZERO_OPEN_ERROR;
+    }
+  else
+    {
+      if (slas_read_header (fd, &lasheader, NULL))
+        {
+          status = SLAS_ZERO_HEADER_ERROR;
+        }
+      else if (slas_init_context (&ctx, fd, &lasheader, big_endian ()))
+        {
+          status = SLAS_ZERO_FORMAT_ERROR;
+        }
+      else if (options->extra && options->extra->count && slas_ctx_read_extra_bytes (&ctx, &lasheader) < 0)
+        {
+          status = SLAS_ZERO_HEADER_ERROR;
+        }
+      else if (options->verify && slas_verify_init (options->verify, &ctx, options->memory))
+        {
+          status = SLAS_ZERO_MEMORY_ERROR;
+        }
+      else
+        {
+          if (options->qa) slas_qa_init (options->qa, &ctx, lasheader.min_z, lasheader.max_z);
+
+          status = slas_zero_context (&ctx, options, stats);
+        }
+
+      close (fd);
+    }
+
+  //  The LAZ file is going to be rewritten anyway so this is the time to put the points in spatial order.
+
+  if (laz && !status && options->sort != NULL)
+    {
+      char index_file[1100];
+      SLAS_SORT_OPTIONS sort = *options->sort;
+
+
+      //  Run buffers come out of the memory budget so clip the sort memory to what's left.
+
+      uint64_t bytes = (uint64_t) sort.memory * 1048576;
+      uint64_t available = slas_memory_available (options->memory);
+
+      if (bytes > available) bytes = available;
+
+      sort.memory = (uint32_t) (bytes / 1048576);
+      bytes = (uint64_t) sort.memory * 1048576;
+
+      if (!sort.memory || slas_memory_reserve (options->memory, bytes))
+        {
+          status = SLAS_ZERO_MEMORY_ERROR;
+        }
+      else
+        {
+          sprintf (index_file, "%s.sbx", path);
+
+          if (slas_sort_file (las_file, &sort, sort.index_chunk ? index_file : NULL)) status = SLAS_ZERO_SORT_ERROR;
+
+          slas_memory_release (options->memory, bytes);
+        }
+    }
+
+
+  if (!laz) return (status);
+
+
+  //  If anything went wrong just get rid of the uncompressed file and leave the LAZ file alone.
+
+  if (status)
+    {
+      QFile::remove (fileLAS);
+      return (status);
+    }
+
+
+  //  We have to rename the old LAZ file to WHATEVER.bck, compress the new LAS file to the old LAZ file name, delete the LAS
+  //  file, then delete the BCK file.  At that point we are back to the original LAZ file name.  Since laszip always
+  //  writes .laz we have to rename the result if the original was .LAZ.
+
+  QString backFile = swap_extension (path, ".bck");
+  QString newLAZ = swap_extension (path, ".laz");
+
+  if (!QFile::rename (fileLAZ, backFile)) return (SLAS_ZERO_RENAME_ERROR);
+
+  if (run_laszip (options->laszip, fileLAS))
+    {
+      QFile::rename (backFile, fileLAZ);
+      return (SLAS_ZERO_LASZIP_ERROR);
+    }
+
+  if (newLAZ != fileLAZ && !QFile::rename (newLAZ, fileLAZ)) return (SLAS_ZERO_RENAME_ERROR);
+
+  if (!QFile::remove (fileLAS)) return (SLAS_ZERO_REMOVE_ERROR);
+
+  if (!QFile::remove (backFile)) return (SLAS_ZERO_REMOVE_ERROR);
+
+
+  return (SLAS_ZERO_SUCCESS);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_zero_estimate
+
+ - Purpose:     Estimate what a slas_zero_context pass would do without doing it.  The
+                records are split into sample_size equal strata and one record is read
+                (with a single positional read) from a random spot in each.  The same
+                threshold, grid, and selection tests as the real pass are applied to the
+                sampled records.  The confidence bounds are 95% Wilson score bounds.
+
+                The write volume depends on how the changed points are spread out.  The low
+                end assumes only the changed records are written, the high end assumes the
+                changed records are scattered at random (at the upper confidence bound) so
+                every 4K page holding one of them gets written.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - ctx            =    The SLAS_CONTEXT for the file
+                - options        =    SLAS_ZERO_OPTIONS
+                - sample_size    =    Number of records to sample (0 for SLAS_ZERO_SAMPLE_SIZE)
+                - estimate       =    Returned SLAS_ZERO_ESTIMATE
+
+ - Returns:     int32_t          =    SLAS_ZERO_SUCCESS or one of the SLAS_ZERO error codes
+
+*********************************************************************************************/
+
+int32_t slas_zero_estimate (SLAS_CONTEXT *ctx, SLAS_ZERO_OPTIONS *options, uint32_t sample_size, SLAS_ZERO_ESTIMATE *estimate)
+{
+  QElapsedTimer    timer;
+  SLAS_GRID_CACHE  grid_cache;
+  SLAS_SELECTION   *selection = &options->selection;
+  uint8_t          *data;
+  int32_t          status = SLAS_ZERO_SUCCESS;
+
+
+  timer.start ();
+
+  memset (estimate, 0, sizeof (SLAS_ZERO_ESTIMATE));
+
+  if (!sample_size) sample_size = SLAS_ZERO_SAMPLE_SIZE;
+
+  if (options->first_record > ctx->number_of_points ||
+      (options->num_records && options->num_records > ctx->number_of_points - options->first_record)) return (SLAS_ZERO_RANGE_ERROR);
+
+  if (selection->time_range && ctx->gps_time_offset < 0) return (SLAS_ZERO_SELECTION_ERROR);
+
+  SLAS_EXTRA_RULES *extra = (options->extra && options->extra->count) ? options->extra : NULL;
+  int32_t extra_dim[SLAS_ZERO_MAX_EXTRA];
+
+  if (extra && extra_dims (ctx, extra, extra_dim)) return (SLAS_ZERO_EXTRA_ERROR);
+
+  if ((data = (uint8_t *) malloc (ctx->record_length)) == NULL) return (SLAS_ZERO_MEMORY_ERROR);
+
+  uint64_t grid_reserved = 0;
+
+  if (options->grid)
+    {
+      int32_t tiles = reserve_grid_cache (options, &grid_reserved);
+
+      if (!tiles || slas_grid_init_cache (&grid_cache, options->grid, tiles))
+        {
+          slas_memory_release (options->memory, grid_reserved);
+          free (data);
+          return (SLAS_ZERO_MEMORY_ERROR);
+        }
+    }
+
+
+  uint64_t start = options->first_record;
+  uint64_t records = options->num_records ? options->num_records : ctx->number_of_points - start;
+
+  estimate->records = records;
+  estimate->read_bytes = records * ctx->record_length;
+  estimate->sample = (uint32_t) qMin ((uint64_t) sample_size, records);
+
+
+  //  Same seed every time for the same file so the estimate is repeatable.
+
+  uint64_t seed = 0x9e3779b97f4a7c15ULL ^ records;
+
+  for (uint32_t j = 0 ; j < estimate->sample ; j++)
+    {
+      uint64_t stratum_start = start + records * j / estimate->sample;
+      uint64_t stratum_size = start + records * (j + 1) / estimate->sample - stratum_start;
+
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+
+      uint64_t recnum = stratum_start + seed % stratum_size;
+
+      slas_throttle_wait (options->throttle, SLAS_THROTTLE_READ, ctx->record_length);
+
+      if (slas_ctx_read_records (ctx, recnum, 1, data))
+        {
+          status = SLAS_ZERO_READ_ERROR;
+          break;
+        }
+
+      if ((selection->source_ids || selection->time_range) && !point_selected (ctx, selection, data)) continue;
+
+      float threshold = options->threshold;
+
+      if (options->grid)
+        {
+          double x, y;
+          float value;
+
+          point_xy (ctx, data, &x, &y);
+
+          if (slas_grid_interpolate (&grid_cache, 1, &x, &y, &value))
+            {
+              status = SLAS_ZERO_GRID_ERROR;
+              break;
+            }
+
+          threshold = value + options->threshold;
+        }
+
+      if (point_z (ctx, data) > threshold || (extra && extra_match (ctx, extra, extra_dim, data)))
+        {
+          if (data[ctx->flags_offset] & ctx->withheld_mask)
+            {
+              estimate->already_withheld++;
+            }
+          else
+            {
+              estimate->affected++;
+            }
+        }
+    }
+
+  free (data);
+
+  if (options->grid) slas_grid_free_cache (&grid_cache);
+  slas_memory_release (options->memory, grid_reserved);
+
+  if (status) return (status);
+
+
+  if (estimate->sample)
+    {
+      double n = (double) estimate->sample;
+      double p = (double) estimate->affected / n;
+      double z2 = 1.96 * 1.96;
+      double center = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+      double half = 1.96 * sqrt (p * (1.0 - p) / n + z2 / (4.0 * n * n)) / (1.0 + z2 / n);
+
+      estimate->fraction = p;
+      estimate->fraction_low = qMax (0.0, center - half);
+      estimate->fraction_high = qMin (1.0, center + half);
+
+
+      double pages = ceil ((double) estimate->read_bytes / 4096.0);
+      double per_page = 4096.0 / (double) ctx->record_length;
+
+      estimate->write_bytes_low = (uint64_t) (estimate->fraction_low * (double) estimate->read_bytes);
+      estimate->write_bytes_high = (uint64_t) qMin ((double) estimate->read_bytes,
+                                                    pages * (1.0 - pow (1.0 - estimate->fraction_high, per_page)) * 4096.0);
+    }
+
+  estimate->seconds = (double) timer.elapsed () / 1000.0;
+
+
+  return (SLAS_ZERO_SUCCESS);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_zero_estimate_file
+
+ - Purpose:     Open a LAS file and run slas_zero_estimate on it.  LAZ files can't be read
+                by position so they aren't supported.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - path           =    LAS file name
+                - options        =    SLAS_ZERO_OPTIONS
+                - sample_size    =    Number of records to sample (0 for SLAS_ZERO_SAMPLE_SIZE)
+                - estimate       =    Returned SLAS_ZERO_ESTIMATE
+
+ - Returns:     int32_t          =    SLAS_ZERO_SUCCESS or one of the SLAS_ZERO error codes
+
+*********************************************************************************************/
+
+int32_t slas_zero_estimate_file (const char *path, SLAS_ZERO_OPTIONS *options, uint32_t sample_size, SLAS_ZERO_ESTIMATE *estimate)
+{
+  LASheader     lasheader;
+  SLAS_CONTEXT  ctx;
+  int32_t       fd, status;
+  uint8_t       compressed;
+
+
+  memset (estimate, 0, sizeof (SLAS_ZERO_ESTIMATE));
+
+  if ((fd = open (path, O_RDONLY | O_BINARY)) < 0) return (SLAS_ZERO_OPEN_ERROR);
+
+  if (slas_read_header (fd, &lasheader, &compressed))
+    {
+      status = SLAS_ZERO_HEADER_ERROR;
+    }
+  else if (compressed || slas_init_context (&ctx, fd, &lasheader, big_endian ()))
+    {
+      status = SLAS_ZERO_FORMAT_ERROR;
+    }
+  else if (options->extra && options->extra->count && slas_ctx_read_extra_bytes (&ctx, &lasheader) < 0)
+    {
+      status = SLAS_ZERO_HEADER_ERROR;
+    }
+  else
+    {
+      status = slas_zero_estimate (&ctx, options, sample_size, estimate);
+    }
+
+  close (fd);
+
+
+  return (status);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_zero_strerror
+
+ - Purpose:     Get the message for a SLAS_ZERO error code.
+
+ - Author:      PFM Software
+
+ - Date:        10/18/26
+
+ - Arguments:
+                - error          =    SLAS_ZERO error code
+
+ - Returns:     const char *     =    Error message
+
+*********************************************************************************************/
+
+const char *slas_zero_strerror (int32_t error)
+{
+  switch (error)
+    {
+    case SLAS_ZERO_SUCCESS:
+      return ("Success");
+
+    case SLAS_ZERO_OPEN_ERROR:
+      return ("Unable to open LAS file");
+
+    case SLAS_ZERO_HEADER_ERROR:
+      return ("Unable to read LAS header (or unsupported LAS version)");
+
+    case SLAS_ZERO_FORMAT_ERROR:
+      return ("Unsupported point data format");
+
+    case SLAS_ZERO_READ_ERROR:
+      return ("Error reading LAS records");
+
+    case SLAS_ZERO_WRITE_ERROR:
+      return ("Error writing LAS records");
+
+    case SLAS_ZERO_LASZIP_ERROR:
+      return ("laszip not found or failed");
+
+    case SLAS_ZERO_MEMORY_ERROR:
+      return ("Unable to allocate memory (or over the memory limit)");
+
+    case SLAS_ZERO_RENAME_ERROR:
+      return ("Unable to rename LAZ file");
+
+    case SLAS_ZERO_REMOVE_ERROR:
+      return ("Unable to remove temporary LAS or BCK file");
+
+    case SLAS_ZERO_RANGE_ERROR:
+      return ("Bad record range (or record range used with a LAZ file)");
+
+    case SLAS_ZERO_GRID_ERROR:
+      return ("Error reading threshold grid");
+
+    case SLAS_ZERO_SELECTION_ERROR:
+      return ("GPS time selection used with a point format that has no GPS time");
+
+    case SLAS_ZERO_SORT_ERROR:
+      return ("Error sorting LAZ points into Morton order");
+
+    case SLAS_ZERO_EXTRA_ERROR:
+      return ("Extra bytes dimension used in a rule isn't in the file");
+
+    case SLAS_ZERO_VERIFY_ERROR:
+      return ("Verification failed, records changed in more than the withheld bit");
+
+    case SLAS_ZERO_ARCHIVE_ERROR:
+      return ("Unable to write the LAZ archive");
+
+    case SLAS_ZERO_LAZ_ERROR:
+      return ("Unable to rebuild a LAZ chunk (unexpected chunk layout)");
+
+    case SLAS_ZERO_COPC_ERROR:
+      return ("Unable to update COPC file in place (bad hierarchy or --sort), file not changed");
+    }
+
+  return ("Unknown error");
+}
@@ -0,0 +1,189 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  In process version of the las_zero pass.  Nothing in here calls exit or keeps any global state so it can be linked
+    into long running programs (it's built into libslas along with slas.cpp).  */
+
+#ifndef __SLAS_ZERO_HPP__
+#define __SLAS_ZERO_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <lasreader.hpp>
+#include "slas.hpp"
+#include "slas_grid.hpp"
+#include "slas_index.hpp"
+#include "slas_throttle.hpp"
+#include "slas_perf.hpp"
+#include "slas_sort.hpp"
+#include "slas_copc.hpp"
+#include "slas_qa.hpp"
+#include "slas_memory.hpp"
+#include "slas_numa.hpp"
+#include "slas_verify.hpp"
+
+
+//!  slas_zero_* error codes (use slas_zero_strerror to get a message).
+
+#define SLAS_ZERO_SUCCESS               0
+#define SLAS_ZERO_OPEN_ERROR            -1
+#define SLAS_ZERO_HEADER_ERROR          -2
+#define SLAS_ZERO_FORMAT_ERROR          -3
+#define SLAS_ZERO_READ_ERROR            -4
+#define SLAS_ZERO_WRITE_ERROR           -5
+#define SLAS_ZERO_LASZIP_ERROR          -6
+#define SLAS_ZERO_MEMORY_ERROR          -7
+#define SLAS_ZERO_RENAME_ERROR          -8
+#define SLAS_ZERO_REMOVE_ERROR          -9
+#define SLAS_ZERO_RANGE_ERROR           -10
+#define SLAS_ZERO_GRID_ERROR            -11
+#define SLAS_ZERO_SELECTION_ERROR       -12
+#define SLAS_ZERO_SORT_ERROR            -13
+#define SLAS_ZERO_EXTRA_ERROR           -14
+#define SLAS_ZERO_VERIFY_ERROR          -15
+#define SLAS_ZERO_ARCHIVE_ERROR         -16
+#define SLAS_ZERO_LAZ_ERROR             -17
+#define SLAS_ZERO_COPC_ERROR            -18
+
+
+//!  Default number of records per block, and the smallest block a pass will drop to in order to fit the memory limit.
+
+#define SLAS_ZERO_BLOCK_SIZE            65536
+#define SLAS_ZERO_MIN_BLOCK_SIZE        4096
+
+
+/*!  Progress callback.  This is called (serialized, from whichever worker thread finished a block) with the number of
+     records done so far and the total.  */
+
+typedef void (*SLAS_ZERO_PROGRESS) (uint64_t done, uint64_t total, void *user_data);
+
+
+//!  Most extra bytes rules in one SLAS_EXTRA_RULES.
+
+#define SLAS_ZERO_MAX_EXTRA             8
+
+
+/*!  Extra bytes rules.  A point is withheld if it's above the threshold or any of these (NAME > VALUE or NAME < VALUE,
+     using the scaled value of the named extra bytes dimension) is true for it.  A point with the dimension's no_data
+     value never matches.  */
+
+typedef struct
+{
+  int32_t                     count;
+  char                        name[SLAS_ZERO_MAX_EXTRA][33];
+  uint8_t                     greater[SLAS_ZERO_MAX_EXTRA];    //!<  NVTrue for >, NVFalse for <
+  double                      value[SLAS_ZERO_MAX_EXTRA];
+} SLAS_EXTRA_RULES;
+
+
+typedef struct
+{
+  float                       threshold;                       //!<  Points with Z above this get the withheld bit set
+  SLAS_GRID                   *grid;                           //!<  Optional threshold grid (threshold is then added to the grid value)
+  int32_t                     threads;                         //!<  Number of worker threads (0 = one per core)
+  uint32_t                    block_size;                      //!<  Records per block
+  uint64_t                    first_record;                    //!<  First record to process (LAS only)
+  uint64_t                    num_records;                     //!<  Number of records to process (0 = through the end of the file)
+  SLAS_SELECTION              selection;                       //!<  Only points selected by this are processed
+  SLAS_INDEX                  *index;                          //!<  Optional index used to skip chunks with no selected points
+  SLAS_THROTTLE               *throttle;                       //!<  Optional I/O throttle (may be shared by several passes)
+  SLAS_PERF_COUNTS            *perf;                           //!<  If set, the per phase hardware counter profile is added to this
+  SLAS_COPC                   *copc;                           //!<  Optional COPC hierarchy used to skip nodes at or below the threshold
+  SLAS_MEMORY                 *memory;                         //!<  Optional memory budget (may be shared by several passes)
+  SLAS_NUMA                   *numa;                           //!<  Optional NUMA layout, worker threads are spread over and bound to the nodes
+  SLAS_QA                     *qa;                             //!<  If set, QA statistics for every record are added to this (see slas_qa_init)
+  SLAS_SORT_OPTIONS           *sort;                           //!<  If set, LAZ files are rewritten in Morton order
+  SLAS_EXTRA_RULES            *extra;                          //!<  Optional extra bytes rules (slas_zero_context needs slas_ctx_read_extra_bytes)
+  SLAS_VERIFY                 *verify;                         //!<  If set, records are read back and checked after the pass (see slas_verify_init)
+  char                        *archive;                        //!<  If set, a LAS file is only read and the result is written to this LAZ file
+  char                        laszip[1024];                    //!<  laszip program used for LAZ files
+  SLAS_ZERO_PROGRESS          progress;                        //!<  Optional progress callback
+  void                        *user_data;                      //!<  Passed to progress
+} SLAS_ZERO_OPTIONS;
+
+
+typedef struct
+{
+  uint64_t                    records;                         //!<  Records examined
+  uint64_t                    withheld;                        //!<  Records that we set the withheld bit on
+  uint64_t                    already_withheld;                //!<  Records above the threshold that were already withheld
+  uint64_t                    skipped;                         //!<  Records that weren't read because the index said they couldn't be selected
+  uint64_t                    bytes_read;
+  uint64_t                    bytes_written;
+  double                      seconds;                         //!<  Wall clock time
+  int32_t                     nodes;                           //!<  NUMA nodes the workers were spread over (0 if they weren't)
+  int32_t                     node[SLAS_NUMA_MAX_NODES];       //!<  Kernel node number
+  uint64_t                    node_records[SLAS_NUMA_MAX_NODES];  //!<  Records examined by the workers on the node
+  double                      node_seconds[SLAS_NUMA_MAX_NODES];  //!<  Time the node's slowest worker took
+} SLAS_ZERO_STATS;
+
+
+//!  Result of slas_zero_estimate.
+
+typedef struct
+{
+  uint64_t                    records;                         //!<  Records in the file (or range)
+  uint32_t                    sample;                          //!<  Records sampled
+  uint32_t                    affected;                        //!<  Sampled records that would get the withheld bit set
+  uint32_t                    already_withheld;                //!<  Sampled records above the threshold that are already withheld
+  double                      fraction;                        //!<  Estimated fraction of the records that would be changed
+  double                      fraction_low;                    //!<  Lower 95% confidence bound on fraction
+  double                      fraction_high;                   //!<  Upper 95% confidence bound on fraction
+  uint64_t                    read_bytes;                      //!<  Bytes a full pass would read
+  uint64_t                    write_bytes_low;                 //!<  Predicted write volume (low end)
+  uint64_t                    write_bytes_high;                //!<  Predicted write volume (high end)
+  double                      seconds;                         //!<  Time taken by the estimate
+} SLAS_ZERO_ESTIMATE;
+
+
+//!  Default number of records sampled by slas_zero_estimate.
+
+#define SLAS_ZERO_SAMPLE_SIZE           4096
+
+
+void slas_zero_default_options (SLAS_ZERO_OPTIONS *options);
+int32_t slas_zero_context (SLAS_CONTEXT *ctx, SLAS_ZERO_OPTIONS *options, SLAS_ZERO_STATS *stats);
+int32_t slas_zero_file (const char *path, SLAS_ZERO_OPTIONS *options, SLAS_ZERO_STATS *stats);
+int32_t slas_zero_estimate (SLAS_CONTEXT *ctx, SLAS_ZERO_OPTIONS *options, uint32_t sample_size, SLAS_ZERO_ESTIMATE *estimate);
+int32_t slas_zero_estimate_file (const char *path, SLAS_ZERO_OPTIONS *options, uint32_t sample_size, SLAS_ZERO_ESTIMATE *estimate);
+const char *slas_zero_strerror (int32_t error);
+
+
+#endif
@@ -38,7 +38,7 @@
 
 #ifndef VERSION
 
-#define     VERSION     "PFM Software - las_zero V1.01 - 06/23/17"
+#define     VERSION     "PFM Software - las_zero V1.26 - 10/18/26"
 
 #endif
 
@@ -57,4 +57,241 @@
 
     -  Removed redundant functions from slas.cpp that are available in the nvutility library.
 
+
+    Version 1.02
+    PFM Software
+    10/18/26
+
+    -  Added slas_read_waveform_data_buf so that callers walking formats 4, 5, 9, and 10 can reuse one packet buffer
+       instead of doing a malloc/free for every waveform.
+    -  Added slas_unpack_waveform with byte aligned (SSE2 when available) kernels for 8, 16, and 32 bit samples.
+       bit_unpack is now only used for odd sample sizes.
+
+
+    Version 1.03
+    PFM Software
+    10/18/26
+
+    -  Added slas_open_waveform_map/slas_read_waveform_data_map.  The waveform data packets (internal, or external
+       in a .wdp file) are mapped read-only once and read by offset with no seek, no read, and no shared FILE
+       pointer so multiple threads can pull waveforms from the same file.
+
+
+    Version 1.04
+    PFM Software
+    10/18/26
+
+    -  Added SLAS_WAVEFORM_CACHE, a small LRU cache of unpacked waveforms keyed by descriptor index and byte offset.
+       All of the returns from a pulse share one packet so slas_read_waveform_data_cached only reads and unpacks
+       it once.  Hit rate is available from slas_waveform_cache_hit_rate.
+
+
+    Version 1.05
+    PFM Software
+    10/18/26
+
+    -  Added SLAS_CONTEXT and the slas_ctx_* functions.  The record layout (lengths, field offsets, scale/offset,
+       64 bit point count) is worked out once per file and records are read/written with pread/pwrite on a file
+       descriptor so one file can be shared by multiple threads.  slas_read_point_data and slas_update_point_data
+       are now thin wrappers around the same decode/encode code.
+    -  Only the format defined part of a record is read into the fixed size record buffer so long records (extra
+       bytes) can no longer overrun it.
+    -  Fixed decoding of the classification flags for point formats 6 through 10.  They were always read as 0 which
+       meant that updating a record cleared its synthetic, key-point, and overlap bits.
+    -  las_zero now uses the context functions and loops over the 64 bit point count.
+
+
+    Version 1.06
+    PFM Software
+    10/18/26
+
+    -  Added slas_read_header, a minimal native LAS header parser that reads the fixed header in one pread and
+       validates the signature, version, and header size, and slas_read_vlrs/slas_find_vlr to walk the VLR and
+       EVLR headers.
+    -  las_zero no longer opens the file with LASlib just to get the header.  A LAS file is now opened exactly once.
+       For LAZ files the (uncompressed) header is checked before the file is unzipped.
+
+
+    Version 1.07
+    PFM Software
+    10/18/26
+
+    -  Moved the zeroing pass out of the las_zero constructor into slas_zero.cpp (slas_zero_file and
+       slas_zero_context).  It returns SLAS_ZERO error codes instead of calling exit and keeps no global state.
+       mk now also builds slas.cpp and slas_zero.cpp into libslas.a so other PFM programs can run the pass in
+       process (on an already open file and header if they have one).
+    -  The pass now reads blocks of records with one pread per block, spreads the blocks across worker threads,
+       and only writes back runs of records that actually changed.
+    -  Fixed the LAZ round trip for .LAZ (upper case) file names and check the laszip exit status.
+
+
+    Version 1.08
+    PFM Software
+    10/18/26
+
+    -  Added --daemon mode.  las_zero stays resident with a pool of worker threads and takes jobs from a Unix
+       domain socket (bounded queue, per-job OK/ERROR reply lines).  Added --submit client and -t/--threads.
+    -  libslas now only picks up the slas* files.
+
+
+    Version 1.09
+    PFM Software
+    10/18/26
+
+    -  Added --shard I/N.  Multiple files are split between shards by file (sorted list), a single LAS file is
+       split into page aligned record ranges.  Each shard writes a completion record (--shard-record).
+    -  las_zero now takes more than one file on the command line.
+
+
+    Version 1.10
+    PFM Software
+    10/18/26
+
+    -  Added --manifest FILE.  Files that were processed successfully are recorded (size, mtime, header/content
+       hash, parameters and results) and skipped on later runs if nothing has changed.
+    -  Added --list FILE to read file names from a file.
+
+
+    Version 1.11
+    PFM Software
+    10/18/26
+
+    -  Added --grid FILE (ESRI .flt/.hdr threshold surface).  Each point is compared to the bilinearly
+       interpolated grid value at its X/Y plus --threshold (also new).  Grid tiles are read lazily into a
+       per-thread cache and interpolated a block of records at a time.
+
+
+    Version 1.12
+    PFM Software
+    10/18/26
+
+    -  Added --build-index to write a flightline/GPS time index (FILE.slx) with the point source IDs and GPS time
+       range of each chunk of records, and --source-id / --time-range selections that use it to only read and
+       update the chunks that can have selected points.
+
+
+    Version 1.13
+    PFM Software
+    10/18/26
+
+    -  Added --estimate [--sample N].  Reads one record from each of N equal strata (positional reads) and
+       reports the estimated fraction of points that would be withheld (with 95% bounds) and the predicted
+       read/write volume, one ESTIMATE line per file.
+
+
+    Version 1.14
+    PFM Software
+    10/18/26
+
+    -  Added process wide token bucket I/O throttling (--read-limit, --write-limit, --read-iops, --write-iops)
+       adjustable while running through --throttle-file (checked every second and on SIGHUP).
+
+
+    Version 1.15
+    PFM Software
+    10/18/26
+
+    -  Added --profile.  Per thread perf_event_open counters (cycles, instructions, LLC misses, context switches)
+       charged to the decode, predicate, and write back phases and reported per million points.  Counters that
+       are not available are reported as n/a.
+
+
+    Version 1.16
+    PFM Software
+    10/18/26
+
+    -  Added --sort (with --sort-memory and --sort-index) to rewrite LAZ files with the points in
+       Morton order using a bounded memory external merge sort.
+
+
+    Version 1.17
+    PFM Software
+    10/18/26
+
+    -  COPC files are checked against the octree hierarchy and stay COPC, they are no longer converted to
+       plain LAZ.  A file with nothing to change is not decompressed at all, otherwise it is rewritten node by
+       node.  Nodes that are entirely at or below the threshold are copied as they are, nodes that are entirely
+       above it are withheld by decoding and re-encoding only the flags layer.  The hierarchy entry and page
+       offsets and the root hierarchy offset in the COPC info VLR are rewritten to match.  A hierarchy that
+       doesn't match the file is an error, and COPC files can't be used with --sort.
+
+
+    Version 1.18
+    PFM Software
+    10/18/26
+
+    -  LAZ files with point formats 6 through 10 are rewritten a chunk at a time without going through laszip.
+       Only the Z and flags layers (and point source ID and GPS time for a selection) are decompressed.  Changed
+       chunks get only their flags layer re-encoded, the other layers are copied verbatim, and the layer sizes,
+       chunk table, and EVLR/waveform offsets are patched.  Files with nothing to change are left alone.
+       Point formats 0 through 5 (pointwise) and --sort still go through laszip.
+
+
+    Version 1.19
+    PFM Software
+    10/18/26
+
+    -  Added --qa to write FILE.qa.json with bounds, a Z histogram, classification and return counts,
+       and the withheld count, all gathered per thread during the zeroing pass.
+
+
+    Version 1.20
+    PFM Software
+    10/18/26
+
+    -  Added --output FILE | DIRECTORY.  The input is cloned (reflink, copy_file_range, or a plain copy) and
+       only the changed records of the clone are written.
+
+
+    Version 1.21
+    PFM Software
+    10/18/26
+
+    -  Batch runs prefetch the headers and first 16 MB of points of the next files (--prefetch N, default 2)
+       while the current file is being processed.  Files the manifest says are unchanged aren't prefetched
+       and --estimate runs don't prefetch at all.  Prefetching isn't charged to --throttle.
+
+
+    Version 1.22
+    PFM Software
+    10/18/26
+
+    -  Added --mem-limit, a process wide budget for block buffers, grid tile caches, and sort buffers.
+       Passes shrink their block size, grid cache, and then thread count to fit.  The selection index, COPC
+       node array, LAZ chunk tables, and verification checksums are reserved from it too, a file whose
+       tables don't fit fails with a memory error.
+
+
+    Version 1.23
+    PFM Software
+    10/18/26
+
+    -  On NUMA machines the worker threads are spread over the nodes, bound to them, and given their
+       own contiguous part of the file.  Per node throughput is reported.  --no-numa turns it off.
+
+
+    Version 1.24
+    PFM Software
+    10/18/26
+
+    -  Added --extra NAME>VALUE (or <) rules on LAS extra bytes dimensions, parsed from the Extra Bytes
+       VLR.  Points matching any rule are withheld along with points above the threshold.
+
+
+    Version 1.25
+    PFM Software
+    10/18/26
+
+    -  Added --verify.  After the pass every record it read is read back from storage and checked with
+       per chunk CRC32C checksums (SSE4.2 when available, withheld bit masked).  Checksums go to FILE.crc32c.
+
+
+    Version 1.26
+    PFM Software
+    10/18/26
+
+    -  Added --archive.  LAS files are left alone and the result is written to a LAZ file in the
+       same pass.  Each worker thread compresses the block it checked as one variable size LAZ chunk,
+       the chunks are appended in record order under the write lock, and a chunk table finishes the file.
+
 */